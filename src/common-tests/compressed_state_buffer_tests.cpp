@@ -0,0 +1,152 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "common/compressed_state_buffer.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+// Random data which doesn't compress, with a few bytes changed per index, like consecutive save states.
+static std::vector<u8> MakeState(u32 index, u32 size)
+{
+  std::vector<u8> data(size);
+  std::mt19937 rng(1234);
+  for (u8& value : data)
+    value = static_cast<u8>(rng());
+
+  for (u32 i = 0; i < 16; i++)
+    data[(index * 37 + i * 101) % size] = static_cast<u8>(index);
+
+  return data;
+}
+
+// Reads back every entry from newest to oldest, which empties the buffer.
+static void CheckAndPopAll(CompressedStateBuffer& buffer, u32 first_index, const std::vector<u32>& sizes)
+{
+  ASSERT_EQ(buffer.GetCount(), static_cast<u32>(sizes.size()) - first_index);
+
+  std::vector<u8> data;
+  for (u32 index = static_cast<u32>(sizes.size()); index > first_index;)
+  {
+    index--;
+    ASSERT_TRUE(buffer.ReadBack(&data));
+    ASSERT_EQ(data, MakeState(index, sizes[index])) << "entry " << index;
+    buffer.PopBack();
+  }
+
+  ASSERT_TRUE(buffer.IsEmpty());
+}
+
+TEST(CompressedStateBuffer, RoundTripBeforeCompression)
+{
+  CompressedStateBuffer buffer;
+  buffer.SetKeyframeInterval(4);
+
+  const std::vector<u32> sizes(10, 4096);
+  for (u32 i = 0; i < sizes.size(); i++)
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+
+  CheckAndPopAll(buffer, 0, sizes);
+}
+
+TEST(CompressedStateBuffer, RoundTripAcrossKeyframes)
+{
+  CompressedStateBuffer buffer;
+  buffer.SetKeyframeInterval(4);
+
+  const std::vector<u32> sizes(10, 4096);
+  for (u32 i = 0; i < sizes.size(); i++)
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+
+  buffer.WaitForCompression();
+  CheckAndPopAll(buffer, 0, sizes);
+}
+
+TEST(CompressedStateBuffer, PushAfterPopBack)
+{
+  CompressedStateBuffer buffer;
+  buffer.SetKeyframeInterval(4);
+
+  std::vector<u32> sizes(6, 4096);
+  for (u32 i = 0; i < sizes.size(); i++)
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+
+  // Rewind past the second keyframe, then carry on from there.
+  buffer.WaitForCompression();
+  buffer.PopBack();
+  buffer.PopBack();
+  buffer.PopBack();
+  sizes.resize(3);
+  for (u32 i = 3; i < 8; i++)
+  {
+    sizes.push_back(4096);
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+  }
+
+  buffer.WaitForCompression();
+  CheckAndPopAll(buffer, 0, sizes);
+}
+
+TEST(CompressedStateBuffer, DeltasDecodeAfterKeyframeIsDropped)
+{
+  CompressedStateBuffer buffer;
+  buffer.SetKeyframeInterval(4);
+
+  const std::vector<u32> sizes(10, 4096);
+  for (u32 i = 0; i < sizes.size(); i++)
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+
+  // Entries 5-7 are deltas against the keyframe at 4, which goes with the front entries.
+  buffer.WaitForCompression();
+  for (u32 i = 0; i < 5; i++)
+    buffer.PopFront();
+
+  CheckAndPopAll(buffer, 5, sizes);
+}
+
+TEST(CompressedStateBuffer, SizeChangesBetweenStates)
+{
+  CompressedStateBuffer buffer;
+  buffer.SetKeyframeInterval(4);
+
+  // Deltas both larger and smaller than their keyframe.
+  const std::vector<u32> sizes = {4096, 4100, 3000, 4096, 8192, 1024, 8192, 8193, 17, 4096};
+  for (u32 i = 0; i < sizes.size(); i++)
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+
+  buffer.WaitForCompression();
+  CheckAndPopAll(buffer, 0, sizes);
+}
+
+TEST(CompressedStateBuffer, EvictionUnderMemoryBudget)
+{
+  static constexpr u32 STATE_SIZE = 64 * 1024;
+  static constexpr u32 STATE_COUNT = 40;
+
+  // Room for a couple of keyframes, which don't compress, and the deltas alongside them.
+  static constexpr u64 MEMORY_BUDGET = STATE_SIZE * 3;
+
+  CompressedStateBuffer buffer;
+  buffer.SetKeyframeInterval(8);
+
+  const std::vector<u32> sizes(STATE_COUNT, STATE_SIZE);
+  u32 first_index = 0;
+  for (u32 i = 0; i < STATE_COUNT; i++)
+  {
+    buffer.PushBack(MakeState(i, sizes[i]).data(), sizes[i]);
+    buffer.WaitForCompression();
+
+    // Same as the rewind buffer, drop the oldest states until it fits.
+    while (buffer.GetCount() > 1 && buffer.GetMemoryUsage() > MEMORY_BUDGET)
+    {
+      buffer.PopFront();
+      first_index++;
+    }
+
+    ASSERT_LE(buffer.GetMemoryUsage(), MEMORY_BUDGET);
+  }
+
+  ASSERT_GT(first_index, 0u);
+  ASSERT_GT(buffer.GetCount(), 8u);
+  CheckAndPopAll(buffer, first_index, sizes);
+}
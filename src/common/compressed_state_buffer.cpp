@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "compressed_state_buffer.h"
+#include "assert.h"
+#include "log.h"
+#include "zstd.h"
+#include "zstd_errors.h"
+#include <algorithm>
+#include <cstring>
+Log_SetChannel(CompressedStateBuffer);
+
+// Most of a delta is zeros, so the fastest level gets nearly all of the benefit.
+static constexpr int COMPRESSION_LEVEL = 1;
+
+// Spare buffers kept for incoming entries, so pushing doesn't have to allocate each time.
+static constexpr u32 MAX_FREE_RAW_BUFFERS = 4;
+
+static void XORBuffer(u8* dst, const u8* src, u32 size)
+{
+  u32 i = 0;
+  for (; (i + sizeof(u64)) <= size; i += sizeof(u64))
+  {
+    u64 a, b;
+    std::memcpy(&a, &dst[i], sizeof(a));
+    std::memcpy(&b, &src[i], sizeof(b));
+    a ^= b;
+    std::memcpy(&dst[i], &a, sizeof(a));
+  }
+  for (; i < size; i++)
+    dst[i] ^= src[i];
+}
+
+CompressedStateBuffer::CompressedStateBuffer() = default;
+
+CompressedStateBuffer::~CompressedStateBuffer()
+{
+  Clear();
+
+  if (m_dctx)
+    ZSTD_freeDCtx(m_dctx);
+}
+
+u64 CompressedStateBuffer::GetMemoryUsage()
+{
+  std::unique_lock lock(m_mutex);
+
+  u64 usage = 0;
+  for (const std::shared_ptr<Entry>& entry : m_entries)
+    usage += entry->raw.size() + entry->compressed.size();
+
+  return usage;
+}
+
+void CompressedStateBuffer::SetKeyframeInterval(u32 interval)
+{
+  m_keyframe_interval = std::max(interval, 1u);
+}
+
+void CompressedStateBuffer::Clear()
+{
+  StopWorkerThread();
+
+  m_entries.clear();
+  m_compress_queue.clear();
+  m_current_keyframe.reset();
+  m_entries_since_keyframe = 0;
+  m_decoded_keyframe.reset();
+  m_decoded_keyframe_data = {};
+  m_free_raw_buffers.clear();
+}
+
+void CompressedStateBuffer::PushBack(const void* data, u32 size)
+{
+  if (!m_worker_thread.joinable())
+    StartWorkerThread();
+
+  std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+  entry->size = size;
+
+  std::unique_lock lock(m_mutex);
+  entry->raw = AllocateRawBuffer(size);
+  std::memcpy(entry->raw.data(), data, size);
+
+  if (!m_current_keyframe || m_entries_since_keyframe >= m_keyframe_interval)
+  {
+    m_current_keyframe = entry;
+    m_entries_since_keyframe = 1;
+  }
+  else
+  {
+    entry->keyframe = m_current_keyframe;
+    m_entries_since_keyframe++;
+  }
+
+  m_entries.push_back(entry);
+  m_compress_queue.push_back(std::move(entry));
+  m_worker_cv.notify_one();
+}
+
+void CompressedStateBuffer::PopFront()
+{
+  std::unique_lock lock(m_mutex);
+  m_entries.pop_front();
+}
+
+void CompressedStateBuffer::PopBack()
+{
+  std::unique_lock lock(m_mutex);
+
+  // Don't build any more deltas on a keyframe which has been rewound past.
+  if (m_entries.back() == m_current_keyframe)
+    m_current_keyframe.reset();
+
+  m_entries.pop_back();
+}
+
+bool CompressedStateBuffer::ReadBack(std::vector<u8>* data)
+{
+  std::unique_lock lock(m_mutex);
+  if (m_entries.empty())
+    return false;
+
+  const std::shared_ptr<Entry>& entry = m_entries.back();
+  if (!entry->raw.empty())
+  {
+    data->assign(entry->raw.begin(), entry->raw.end());
+    return true;
+  }
+
+  // Anything without raw data has been compressed, and the worker only releases a keyframe's raw data once nothing
+  // else in the queue depends on it.
+  const std::vector<u8>* keyframe_data = nullptr;
+  if (entry->keyframe && !(keyframe_data = GetKeyframeData(entry->keyframe)))
+    return false;
+
+  if (!m_dctx)
+    m_dctx = ZSTD_createDCtx();
+
+  data->resize(entry->size);
+  const size_t ret = ZSTD_decompressDCtx(m_dctx, data->data(), data->size(), entry->compressed.data(),
+                                         entry->compressed.size());
+  if (ZSTD_isError(ret) || ret != entry->size)
+  {
+    Log_ErrorPrintf("ZSTD_decompressDCtx() failed: %s", ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatch");
+    return false;
+  }
+
+  if (keyframe_data)
+    XORBuffer(data->data(), keyframe_data->data(), std::min(entry->size, static_cast<u32>(keyframe_data->size())));
+
+  return true;
+}
+
+void CompressedStateBuffer::WaitForCompression()
+{
+  if (!m_worker_thread.joinable())
+    return;
+
+  std::unique_lock lock(m_mutex);
+  m_worker_idle_cv.wait(lock, [this]() { return m_compress_queue.empty() && !m_worker_busy; });
+}
+
+const std::vector<u8>* CompressedStateBuffer::GetKeyframeData(const std::shared_ptr<Entry>& keyframe)
+{
+  if (!keyframe->raw.empty())
+    return &keyframe->raw;
+
+  if (m_decoded_keyframe == keyframe)
+    return &m_decoded_keyframe_data;
+
+  if (!m_dctx)
+    m_dctx = ZSTD_createDCtx();
+
+  m_decoded_keyframe.reset();
+  m_decoded_keyframe_data.resize(keyframe->size);
+  const size_t ret = ZSTD_decompressDCtx(m_dctx, m_decoded_keyframe_data.data(), m_decoded_keyframe_data.size(),
+                                         keyframe->compressed.data(), keyframe->compressed.size());
+  if (ZSTD_isError(ret) || ret != keyframe->size)
+  {
+    Log_ErrorPrintf("ZSTD_decompressDCtx() failed: %s", ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatch");
+    return nullptr;
+  }
+
+  m_decoded_keyframe = keyframe;
+  return &m_decoded_keyframe_data;
+}
+
+std::vector<u8> CompressedStateBuffer::AllocateRawBuffer(u32 size)
+{
+  std::vector<u8> buffer;
+  if (!m_free_raw_buffers.empty())
+  {
+    buffer = std::move(m_free_raw_buffers.back());
+    m_free_raw_buffers.pop_back();
+  }
+
+  buffer.resize(size);
+  return buffer;
+}
+
+void CompressedStateBuffer::ReleaseRawBuffer(std::vector<u8>* buffer)
+{
+  if (m_free_raw_buffers.size() < MAX_FREE_RAW_BUFFERS)
+  {
+    buffer->clear();
+    m_free_raw_buffers.push_back(std::move(*buffer));
+  }
+
+  *buffer = {};
+}
+
+void CompressedStateBuffer::StartWorkerThread()
+{
+  m_worker_shutdown = false;
+  m_worker_thread = std::thread(&CompressedStateBuffer::WorkerThreadEntryPoint, this);
+}
+
+void CompressedStateBuffer::StopWorkerThread()
+{
+  if (!m_worker_thread.joinable())
+    return;
+
+  {
+    std::unique_lock lock(m_mutex);
+    m_worker_shutdown = true;
+    m_worker_cv.notify_one();
+  }
+
+  m_worker_thread.join();
+}
+
+void CompressedStateBuffer::WorkerThreadEntryPoint()
+{
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, COMPRESSION_LEVEL);
+
+  std::vector<u8> delta;
+  std::vector<u8> compressed;
+
+  // The keyframe which deltas are currently being built against. Its raw data is kept until the next keyframe is
+  // compressed, as the queue is processed in order, so nothing queued after that can refer to it.
+  std::shared_ptr<Entry> last_keyframe;
+
+  std::unique_lock lock(m_mutex);
+  for (;;)
+  {
+    m_worker_busy = false;
+    if (m_compress_queue.empty())
+      m_worker_idle_cv.notify_all();
+
+    m_worker_cv.wait(lock, [this]() { return m_worker_shutdown || !m_compress_queue.empty(); });
+    if (m_worker_shutdown)
+      break;
+
+    std::shared_ptr<Entry> entry = std::move(m_compress_queue.front());
+    m_compress_queue.pop_front();
+    m_worker_busy = true;
+
+    // Nobody can read an entry which has already been dropped, unless later deltas depend on it.
+    const bool is_keyframe = !entry->keyframe;
+    if (entry.use_count() == 1)
+    {
+      ReleaseRawBuffer(&entry->raw);
+      continue;
+    }
+
+    // The main thread doesn't modify raw data, so the lock isn't needed while compressing.
+    lock.unlock();
+
+    const u8* input = entry->raw.data();
+    if (!is_keyframe)
+    {
+      const std::vector<u8>& keyframe_raw = entry->keyframe->raw;
+      delta.assign(entry->raw.begin(), entry->raw.end());
+      XORBuffer(delta.data(), keyframe_raw.data(), std::min(entry->size, static_cast<u32>(keyframe_raw.size())));
+      input = delta.data();
+    }
+
+    compressed.resize(ZSTD_compressBound(entry->size));
+    const size_t ret = ZSTD_compress2(cctx, compressed.data(), compressed.size(), input, entry->size);
+
+    lock.lock();
+
+    if (ZSTD_isError(ret))
+    {
+      // Leave it uncompressed, it's still usable.
+      Log_ErrorPrintf("ZSTD_compress2() failed: %s", ZSTD_getErrorName(ret));
+      continue;
+    }
+
+    entry->compressed.assign(compressed.begin(), compressed.begin() + ret);
+
+    if (is_keyframe)
+    {
+      if (last_keyframe)
+        ReleaseRawBuffer(&last_keyframe->raw);
+
+      last_keyframe = std::move(entry);
+    }
+    else
+    {
+      ReleaseRawBuffer(&entry->raw);
+    }
+  }
+
+  m_worker_busy = false;
+  lock.unlock();
+  ZSTD_freeCCtx(cctx);
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "types.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ZSTD_DCtx_s;
+
+/// Holds a sequence of similar buffers, such as save states, compressed with zstd on a worker thread.
+/// Every Nth buffer is a keyframe, which is compressed as-is. The buffers in between are XORed against the keyframe
+/// before them first, so anything which hasn't changed since the keyframe compresses to almost nothing.
+class CompressedStateBuffer
+{
+public:
+  CompressedStateBuffer();
+  ~CompressedStateBuffer();
+
+  u32 GetCount() const { return static_cast<u32>(m_entries.size()); }
+  bool IsEmpty() const { return m_entries.empty(); }
+
+  /// Returns the number of bytes used by entries, whether compressed or still waiting to be.
+  u64 GetMemoryUsage();
+
+  /// Sets the number of entries between keyframes. Takes effect from the next keyframe.
+  void SetKeyframeInterval(u32 interval);
+
+  /// Removes all entries, and stops the worker thread.
+  void Clear();
+
+  /// Copies the buffer to the end of the sequence, and queues it for compression.
+  void PushBack(const void* data, u32 size);
+
+  void PopFront();
+  void PopBack();
+
+  /// Reconstructs the newest entry. Entries which haven't been compressed yet are returned directly.
+  bool ReadBack(std::vector<u8>* data);
+
+  /// Blocks until every entry which has been pushed so far is compressed.
+  void WaitForCompression();
+
+private:
+  struct Entry
+  {
+    std::vector<u8> raw;
+    std::vector<u8> compressed;
+    std::shared_ptr<Entry> keyframe;
+    u32 size = 0;
+  };
+
+  void StartWorkerThread();
+  void StopWorkerThread();
+  void WorkerThreadEntryPoint();
+
+  std::vector<u8> AllocateRawBuffer(u32 size);
+  void ReleaseRawBuffer(std::vector<u8>* buffer);
+  const std::vector<u8>* GetKeyframeData(const std::shared_ptr<Entry>& keyframe);
+
+  std::deque<std::shared_ptr<Entry>> m_entries;
+  std::shared_ptr<Entry> m_current_keyframe;
+  u32 m_keyframe_interval = 16;
+  u32 m_entries_since_keyframe = 0;
+
+  // Most recent keyframe which had to be decompressed for a read, since rewinding usually reads several in a row.
+  std::shared_ptr<Entry> m_decoded_keyframe;
+  std::vector<u8> m_decoded_keyframe_data;
+  ZSTD_DCtx_s* m_dctx = nullptr;
+
+  std::thread m_worker_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_worker_cv;
+  std::condition_variable m_worker_idle_cv;
+  std::deque<std::shared_ptr<Entry>> m_compress_queue;
+  std::vector<std::vector<u8>> m_free_raw_buffers;
+  bool m_worker_busy = false;
+  bool m_worker_shutdown = false;
+};
@@ -36,9 +36,7 @@ enum : u32
   DATA_SECTOR_OUTPUT_SIZE = CDImage::DATA_SECTOR_SIZE,
   SECTOR_SYNC_SIZE = CDImage::SECTOR_SYNC_SIZE,
   SECTOR_HEADER_SIZE = CDImage::SECTOR_HEADER_SIZE,
-  XA_RESAMPLE_RING_BUFFER_SIZE = 32,
-  XA_RESAMPLE_ZIGZAG_TABLE_SIZE = 29,
-  XA_RESAMPLE_NUM_ZIGZAG_TABLES = 7,
+  XA_RESAMPLE_RING_BUFFER_SIZE = CDXA::XA_RESAMPLE_RING_BUFFER_SIZE,
 
   PARAM_FIFO_SIZE = 16,
   RESPONSE_FIFO_SIZE = 16,
@@ -430,6 +428,7 @@ void CDROM::Initialize()
 
   if (g_settings.cdrom_readahead_sectors > 0)
     m_reader.StartThread(g_settings.cdrom_readahead_sectors);
+  m_reader.SetDecompressionCacheSize(g_settings.GetCDROMCHDHunkCacheSizeInBytes());
 
   Reset();
 }
@@ -833,6 +832,11 @@ void CDROM::SetReadaheadSectors(u32 readahead_sectors)
     m_reader.QueueReadSector(s_requested_lba);
 }
 
+void CDROM::SetDecompressionCacheSize(u32 size)
+{
+  m_reader.SetDecompressionCacheSize(size);
+}
+
 void CDROM::CPUClockChanged()
 {
   // reschedule the disc read event
@@ -2870,38 +2874,6 @@ void CDROM::ProcessDataSector(const u8* raw_sector, const CDImage::SubChannelQ&
   SetAsyncInterrupt(Interrupt::DataReady);
 }
 
-static std::array<std::array<s16, 29>, 7> s_zigzag_table = {
-  {{0,      0x0,     0x0,     0x0,    0x0,     -0x0002, 0x000A,  -0x0022, 0x0041, -0x0054,
-    0x0034, 0x0009,  -0x010A, 0x0400, -0x0A78, 0x234C,  0x6794,  -0x1780, 0x0BCD, -0x0623,
-    0x0350, -0x016D, 0x006B,  0x000A, -0x0010, 0x0011,  -0x0008, 0x0003,  -0x0001},
-   {0,       0x0,    0x0,     -0x0002, 0x0,    0x0003,  -0x0013, 0x003C,  -0x004B, 0x00A2,
-    -0x00E3, 0x0132, -0x0043, -0x0267, 0x0C9D, 0x74BB,  -0x11B4, 0x09B8,  -0x05BF, 0x0372,
-    -0x01A8, 0x00A6, -0x001B, 0x0005,  0x0006, -0x0008, 0x0003,  -0x0001, 0x0},
-   {0,      0x0,     -0x0001, 0x0003,  -0x0002, -0x0005, 0x001F,  -0x004A, 0x00B3, -0x0192,
-    0x02B1, -0x039E, 0x04F8,  -0x05A6, 0x7939,  -0x05A6, 0x04F8,  -0x039E, 0x02B1, -0x0192,
-    0x00B3, -0x004A, 0x001F,  -0x0005, -0x0002, 0x0003,  -0x0001, 0x0,     0x0},
-   {0,       -0x0001, 0x0003,  -0x0008, 0x0006, 0x0005,  -0x001B, 0x00A6, -0x01A8, 0x0372,
-    -0x05BF, 0x09B8,  -0x11B4, 0x74BB,  0x0C9D, -0x0267, -0x0043, 0x0132, -0x00E3, 0x00A2,
-    -0x004B, 0x003C,  -0x0013, 0x0003,  0x0,    -0x0002, 0x0,     0x0,    0x0},
-   {-0x0001, 0x0003,  -0x0008, 0x0011,  -0x0010, 0x000A, 0x006B,  -0x016D, 0x0350, -0x0623,
-    0x0BCD,  -0x1780, 0x6794,  0x234C,  -0x0A78, 0x0400, -0x010A, 0x0009,  0x0034, -0x0054,
-    0x0041,  -0x0022, 0x000A,  -0x0001, 0x0,     0x0001, 0x0,     0x0,     0x0},
-   {0x0002,  -0x0008, 0x0010,  -0x0023, 0x002B, 0x001A,  -0x00EB, 0x027B,  -0x0548, 0x0AFA,
-    -0x16FA, 0x53E0,  0x3C07,  -0x1249, 0x080E, -0x0347, 0x015B,  -0x0044, -0x0017, 0x0046,
-    -0x0023, 0x0011,  -0x0005, 0x0,     0x0,    0x0,     0x0,     0x0,     0x0},
-   {-0x0005, 0x0011,  -0x0023, 0x0046, -0x0017, -0x0044, 0x015B,  -0x0347, 0x080E, -0x1249,
-    0x3C07,  0x53E0,  -0x16FA, 0x0AFA, -0x0548, 0x027B,  -0x00EB, 0x001A,  0x002B, -0x0023,
-    0x0010,  -0x0008, 0x0002,  0x0,    0x0,     0x0,     0x0,     0x0,     0x0}}};
-
-static s16 ZigZagInterpolate(const s16* ringbuf, const s16* table, u8 p)
-{
-  s32 sum = 0;
-  for (u8 i = 0; i < 29; i++)
-    sum += (s32(ringbuf[(p - i) & 0x1F]) * s32(table[i])) / 0x8000;
-
-  return static_cast<s16>(std::clamp<s32>(sum, -0x8000, 0x7FFF));
-}
-
 std::tuple<s16, s16> CDROM::GetAudioFrame()
 {
   const u32 frame = s_audio_fifo.IsEmpty() ? 0u : s_audio_fifo.Pop();
@@ -2966,12 +2938,15 @@ void CDROM::ResampleXAADPCM(const s16* frames_in, u32 num_frames_in)
       if (sixstep == 0)
       {
         sixstep = 6;
-        for (u32 j = 0; j < 7; j++)
-        {
-          const s16 left_interp = ZigZagInterpolate(left_ringbuf, s_zigzag_table[j].data(), p);
-          const s16 right_interp = STEREO ? ZigZagInterpolate(right_ringbuf, s_zigzag_table[j].data(), p) : left_interp;
-          AddCDAudioFrame(left_interp, right_interp);
-        }
+
+        std::array<s16, CDXA::XA_RESAMPLE_NUM_ZIGZAG_TABLES> left_interp;
+        std::array<s16, CDXA::XA_RESAMPLE_NUM_ZIGZAG_TABLES> right_interp;
+        CDXA::ZigZagInterpolate(left_ringbuf, p, left_interp.data());
+        if constexpr (STEREO)
+          CDXA::ZigZagInterpolate(right_ringbuf, p, right_interp.data());
+
+        for (u32 j = 0; j < CDXA::XA_RESAMPLE_NUM_ZIGZAG_TABLES; j++)
+          AddCDAudioFrame(left_interp[j], STEREO ? right_interp[j] : left_interp[j]);
       }
     }
   }
@@ -3253,6 +3228,12 @@ void CDROM::DrawDebugWindow()
       ImGui::Text("Disc Position: MSF[%02u:%02u:%02u] LBA[%u]", disc_position.minute, disc_position.second,
                   disc_position.frame, disc_position.ToLBA());
 
+      if (m_reader.IsUsingThread())
+      {
+        ImGui::Text("Readahead: %u sectors [%u hits, %u misses, %u stalls]", m_reader.GetReadaheadDepth(),
+                    m_reader.GetReadaheadHits(), m_reader.GetReadaheadMisses(), m_reader.GetReadStalls());
+      }
+
       if (media->GetTrackNumber() > media->GetTrackCount())
       {
         ImGui::Text("Track Position: Lead-out");
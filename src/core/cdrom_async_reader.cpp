@@ -5,6 +5,7 @@
 #include "common/assert.h"
 #include "common/log.h"
 #include "common/timer.h"
+#include <algorithm>
 Log_SetChannel(CDROMAsyncReader);
 
 CDROMAsyncReader::CDROMAsyncReader() = default;
@@ -19,8 +20,12 @@ void CDROMAsyncReader::StartThread(u32 readahead_count)
   if (IsUsingThread())
     StopThread();
 
+  m_readahead_count = readahead_count;
+  m_readahead_depth.store(readahead_count);
+  m_sequential_hits = 0;
+
   m_buffers.clear();
-  m_buffers.resize(readahead_count);
+  m_buffers.resize(readahead_count * MAX_READAHEAD_SCALE);
   EmptyBuffers();
 
   m_shutdown_flag.store(false);
@@ -42,6 +47,17 @@ void CDROMAsyncReader::StopThread()
   m_read_thread.join();
   EmptyBuffers();
   m_buffers.clear();
+  m_readahead_count = 0;
+  m_readahead_depth.store(0);
+}
+
+void CDROMAsyncReader::SetDecompressionCacheSize(u32 size)
+{
+  m_decompression_cache_size = size;
+
+  // The image synchronizes this with reads itself, so the read thread can keep going.
+  if (m_media)
+    m_media->SetDecompressionCacheSize(size);
 }
 
 void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
@@ -50,6 +66,8 @@ void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
     CancelReadahead();
 
   m_media = std::move(media);
+  if (m_media)
+    m_media->SetDecompressionCacheSize(m_decompression_cache_size);
 }
 
 std::unique_ptr<CDImage> CDROMAsyncReader::RemoveMedia()
@@ -107,8 +125,12 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
     return;
   }
 
+  // buffers are about to be thrown away if a seek is still pending
+  if (m_next_position_set.load() && m_next_position.load() == lba)
+    return;
+
   const u32 buffer_count = m_buffer_count.load();
-  if (buffer_count > 0)
+  if (buffer_count > 0 && !m_next_position_set.load())
   {
     // don't re-read the same sector if it was the last one we read
     // the CDC code does this when seeking->reading
@@ -119,14 +141,22 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
       return;
     }
 
-    // did we readahead to the correct sector?
-    const u32 next_buffer = (buffer_front + 1) % static_cast<u32>(m_buffers.size());
-    if (m_buffer_count > 1 && m_buffers[next_buffer].lba == lba)
+    // did we readahead to the correct sector? short seeks forward can land further into the buffer
+    const u32 num_buffers = static_cast<u32>(m_buffers.size());
+    for (u32 distance = 1; distance < buffer_count; distance++)
     {
+      const u32 buffer = (buffer_front + distance) % num_buffers;
+      if (m_buffers[buffer].lba != lba)
+        continue;
+
       // great, don't need a seek, but still kick the thread to start reading ahead again
       Log_DebugPrintf("Readahead buffer hit for sector %u", lba);
-      m_buffer_front.store(next_buffer);
-      m_buffer_count.fetch_sub(1);
+      m_readahead_hits.fetch_add(1);
+      if (distance == 1)
+        GrowReadahead();
+
+      m_buffer_front.store(buffer);
+      m_buffer_count.fetch_sub(distance);
       m_can_readahead.store(true);
       m_do_read_cv.notify_one();
       return;
@@ -135,6 +165,9 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
 
   // we need to toss away our readahead and start fresh
   Log_DebugPrintf("Readahead buffer miss, queueing seek to %u", lba);
+  m_readahead_misses.fetch_add(1);
+  ShrinkReadahead();
+
   std::unique_lock<std::mutex> lock(m_mutex);
   m_next_position_set.store(true);
   m_next_position = lba;
@@ -191,6 +224,7 @@ bool CDROMAsyncReader::WaitForReadToComplete()
 
   Common::Timer wait_timer;
   Log_DebugPrintf("Sector read pending, waiting");
+  m_read_stalls.fetch_add(1);
 
   std::unique_lock<std::mutex> lock(m_mutex);
   m_notify_read_complete_cv.wait(
@@ -308,6 +342,35 @@ void CDROMAsyncReader::CancelReadahead()
   EmptyBuffers();
 }
 
+void CDROMAsyncReader::GrowReadahead()
+{
+  // Once a whole window has been consumed sequentially, it's probably streaming, so read further ahead.
+  const u32 depth = m_readahead_depth.load();
+  if (++m_sequential_hits < depth)
+    return;
+
+  m_sequential_hits = 0;
+  const u32 new_depth = std::min(depth * 2, static_cast<u32>(m_buffers.size()));
+  if (new_depth != depth)
+  {
+    Log_DevPrintf("Growing readahead to %u sectors", new_depth);
+    m_readahead_depth.store(new_depth);
+  }
+}
+
+void CDROMAsyncReader::ShrinkReadahead()
+{
+  // Random access doesn't benefit from reading far ahead, and it delays the next seek.
+  m_sequential_hits = 0;
+  const u32 depth = m_readahead_depth.load();
+  const u32 new_depth = std::max(depth / 2, std::max(m_readahead_count / 2, 1u));
+  if (new_depth != depth)
+  {
+    Log_DevPrintf("Shrinking readahead to %u sectors", new_depth);
+    m_readahead_depth.store(new_depth);
+  }
+}
+
 void CDROMAsyncReader::WorkerThreadEntryPoint()
 {
   std::unique_lock lock(m_mutex);
@@ -360,8 +423,8 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
         break;
 
       // readahead time! read as many sectors as we have space for
-      Log_DebugPrintf("Reading ahead %u sectors...", static_cast<u32>(m_buffers.size()) - m_buffer_count.load());
-      while (m_buffer_count.load() < static_cast<u32>(m_buffers.size()))
+      Log_DebugPrintf("Reading ahead %u sectors...", m_readahead_depth.load() - m_buffer_count.load());
+      while (m_buffer_count.load() < m_readahead_depth.load())
       {
         if (m_next_position_set.load())
         {
@@ -32,7 +32,15 @@ public:
   const CDImage::SubChannelQ& GetSectorSubQ() const { return m_buffers[m_buffer_front.load()].subq; }
   u32 GetBufferedSectorCount() const { return m_buffer_count.load(); }
   bool HasBufferedSectors() const { return (m_buffer_count.load() > 0); }
-  u32 GetReadaheadCount() const { return static_cast<u32>(m_buffers.size()); }
+  u32 GetReadaheadCount() const { return m_readahead_count; }
+
+  /// Number of sectors currently being read ahead. Grows while reads are sequential, and shrinks after seeks.
+  u32 GetReadaheadDepth() const { return m_readahead_depth.load(); }
+
+  /// Sector requests which were already buffered, ones which weren't, and times the CPU thread had to wait.
+  u32 GetReadaheadHits() const { return m_readahead_hits.load(); }
+  u32 GetReadaheadMisses() const { return m_readahead_misses.load(); }
+  u32 GetReadStalls() const { return m_read_stalls.load(); }
 
   bool HasMedia() const { return static_cast<bool>(m_media); }
   const CDImage* GetMedia() const { return m_media.get(); }
@@ -42,6 +50,9 @@ public:
   void StartThread(u32 readahead_count = 8);
   void StopThread();
 
+  /// Sets the memory budget for decompressing ahead of the read position, applied to current and future media.
+  void SetDecompressionCacheSize(u32 size);
+
   void SetMedia(std::unique_ptr<CDImage> media);
   std::unique_ptr<CDImage> RemoveMedia();
 
@@ -57,11 +68,19 @@ public:
   bool ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
 
 private:
+  enum : u32
+  {
+    // Readahead can grow to this many times the configured number of sectors.
+    MAX_READAHEAD_SCALE = 4,
+  };
+
   void EmptyBuffers();
   bool ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock);
   void ReadSectorNonThreaded(CDImage::LBA lba);
   bool InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
   void CancelReadahead();
+  void GrowReadahead();
+  void ShrinkReadahead();
 
   void WorkerThreadEntryPoint();
 
@@ -80,6 +99,16 @@ private:
   std::atomic_bool m_can_readahead{false};
   std::atomic_bool m_seek_error{false};
 
+  u32 m_decompression_cache_size = 0;
+
+  u32 m_readahead_count = 0;
+  std::atomic<u32> m_readahead_depth{0};
+  u32 m_sequential_hits = 0;
+
+  std::atomic<u32> m_readahead_hits{0};
+  std::atomic<u32> m_readahead_misses{0};
+  std::atomic<u32> m_read_stalls{0};
+
   std::vector<BufferSlot> m_buffers;
   std::atomic<u32> m_buffer_front{0};
   std::atomic<u32> m_buffer_back{0};
@@ -5,6 +5,8 @@
 #include "bus.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/threading.h"
+#include "common/timer.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
@@ -15,6 +17,11 @@ Log_SetChannel(CPU::CodeCache);
 
 #ifdef WITH_RECOMPILER
 #include "cpu_recompiler_code_generator.h"
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #endif
 
 namespace CPU::CodeCache {
@@ -43,6 +50,13 @@ static constexpr u32 RECOMPILER_FAR_CODE_CACHE_SIZE = 16 * 1024 * 1024;
 #endif
 static constexpr u32 CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM = 10;
 
+// The space after the dispatchers is split into segments. When the buffer runs out, the segment with the least code
+// that ran recently is recycled, so only the blocks which were compiled into it need to be recompiled.
+static constexpr u32 RECOMPILER_CODE_SEGMENT_COUNT = 4;
+
+// Blocks which have run within this many frames count as hot when picking a segment to recycle.
+static constexpr u32 RECOMPILER_HOT_BLOCK_EPOCHS = 60;
+
 #ifdef USE_STATIC_CODE_BUFFER
 static constexpr u32 RECOMPILER_GUARD_SIZE = 4096;
 alignas(Recompiler::CODE_STORAGE_ALIGNMENT) static u8
@@ -56,6 +70,38 @@ static std::unique_ptr<CodeBlock::HostCodePointer[]> s_fast_map_pointers;
 DispatcherFunction s_asm_dispatcher;
 SingleBlockDispatcherFunction s_single_block_asm_dispatcher;
 
+static const u8* s_code_segments_ptr = nullptr;
+static u32 s_code_segments_start = 0;
+static u32 s_code_segment_size = 0;
+static u32 s_far_code_segments_start = 0;
+static u32 s_far_code_segment_size = 0;
+static u32 s_current_code_segment = 0;
+
+u32 g_execution_epoch = 0;
+
+// Host code for new blocks can be generated on a worker thread, while the block is run by the cached interpreter.
+// Results are only published at the end of each frame, after waiting for every outstanding job, so the point where a
+// block switches over to host code depends on emulated execution alone, not on how fast the worker thread is.
+struct BackgroundCompileJob
+{
+  u32 id;
+  std::unique_ptr<CodeBlock> staging_block;
+  Recompiler::CodeGenerator::BackgroundCompileState state;
+  Common::Timer::Value compile_time;
+  bool compiled;
+  bool out_of_space;
+};
+
+static std::thread s_compile_thread;
+static std::mutex s_compile_mutex;
+static std::condition_variable s_compile_work_cv;
+static std::condition_variable s_compile_done_cv;
+static std::deque<BackgroundCompileJob> s_compile_queue;
+static std::vector<BackgroundCompileJob> s_compiled_jobs;
+static u32 s_next_compile_id = 1;
+static bool s_compile_thread_busy = false;
+static bool s_compile_thread_shutdown = false;
+
 static FastMapTable DecodeFastMapPointer(u32 slot, FastMapTable ptr)
 {
   if constexpr (sizeof(void*) == 8)
@@ -85,6 +131,20 @@ static void CompileDispatcher();
 static void FastCompileBlockFunction();
 static void InvalidCodeFunction();
 
+static bool HasCodeSpaceForBlock(const CodeBlock* block);
+static void ResetCodeSegments();
+static void SetCodeSegment(u32 segment);
+static void RecycleColdestCodeSegment();
+
+static void StartCompileThread();
+static void StopCompileThread();
+static void CompileThreadEntryPoint();
+static bool ShouldCompileInBackground();
+static void QueueBackgroundCompile(CodeBlock* block);
+static void WaitForBackgroundCompiles();
+static void CancelBackgroundCompiles();
+static void PublishBackgroundCompiles();
+
 static constexpr u32 GetTableCount(u32 start, u32 end)
 {
   return ((end >> FAST_MAP_TABLE_SHIFT) - (start >> FAST_MAP_TABLE_SHIFT)) + 1;
@@ -191,6 +251,7 @@ static void SetFastMap(u32 pc, CodeBlock::HostCodePointer function)
 
 using BlockMap = std::unordered_map<u32, CodeBlock*>;
 using HostCodeMap = std::map<CodeBlock::HostCodePointer, CodeBlock*>;
+using BlockLookupTable = std::unique_ptr<CodeBlock*[]>;
 
 void LogCurrentState();
 
@@ -205,6 +266,7 @@ static CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush);
 static bool RevalidateBlock(CodeBlock* block, bool allow_flush);
 
 static bool CompileBlock(CodeBlock* block, bool allow_flush);
+static void FillInterpreterInstructions(CodeBlock* block);
 static void RemoveReferencesToBlock(CodeBlock* block);
 static void AddBlockToPageMap(CodeBlock* block);
 static void RemoveBlockFromPageMap(CodeBlock* block);
@@ -218,8 +280,64 @@ static void UnlinkBlock(CodeBlock* block);
 static void ClearState();
 
 static BlockMap s_blocks;
+static CompileStatistics s_compile_statistics = {};
 static std::array<std::vector<CodeBlock*>, Bus::RAM_8MB_CODE_PAGE_COUNT> m_ram_block_map;
 
+// Direct-mapped block pointers for the cached interpreter, using the same layout as the recompiler's fast map.
+// Tables are allocated on first use, and entries are checked against the full block key.
+static std::array<BlockLookupTable, FAST_MAP_TABLE_COUNT> s_block_lookup_tables;
+
+static ALWAYS_INLINE CodeBlock* GetBlockLookupEntry(CodeBlockKey key)
+{
+  const u32 pc = key.GetPC();
+  const BlockLookupTable& table = s_block_lookup_tables[pc >> FAST_MAP_TABLE_SHIFT];
+  if (!table)
+    return nullptr;
+
+  CodeBlock* block = table[(pc & 0xFFFFu) >> 2];
+  return (block && block->key.bits == key.bits) ? block : nullptr;
+}
+
+static void SetBlockLookupEntry(u32 pc, CodeBlock* block)
+{
+  BlockLookupTable& table = s_block_lookup_tables[pc >> FAST_MAP_TABLE_SHIFT];
+  if (!table)
+  {
+    if (!block)
+      return;
+
+    table = std::make_unique<CodeBlock*[]>(FAST_MAP_TABLE_SIZE);
+  }
+
+  table[(pc & 0xFFFFu) >> 2] = block;
+}
+
+static void RemoveBlockLookupEntry(CodeBlock* block)
+{
+  if (GetBlockLookupEntry(block->key) == block)
+    SetBlockLookupEntry(block->GetPC(), nullptr);
+}
+
+static void ClearBlockLookupTables()
+{
+  for (BlockLookupTable& table : s_block_lookup_tables)
+    table.reset();
+}
+
+/// Looks up a block through the direct-mapped table, falling back to the block map on a miss.
+static ALWAYS_INLINE CodeBlock* LookupCachedInterpreterBlock(CodeBlockKey key, bool allow_flush)
+{
+  CodeBlock* block = GetBlockLookupEntry(key);
+  if (block && !block->invalidated)
+    return block;
+
+  block = LookupBlock(key, allow_flush);
+  if (block)
+    SetBlockLookupEntry(key.GetPC(), block);
+
+  return block;
+}
+
 #ifdef WITH_RECOMPILER
 static HostCodeMap s_host_code_map;
 
@@ -261,12 +379,19 @@ void Initialize()
 
     CompileDispatcher();
     ResetFastMap();
+
+    if (g_settings.cpu_recompiler_async_compilation)
+      StartCompileThread();
   }
 #endif
 }
 
 void ClearState()
 {
+#ifdef WITH_RECOMPILER
+  CancelBackgroundCompiles();
+#endif
+
   Bus::ClearRAMCodePageFlags();
   for (auto& it : m_ram_block_map)
     it.clear();
@@ -275,6 +400,7 @@ void ClearState()
     delete it.second;
 
   s_blocks.clear();
+  ClearBlockLookupTables();
 #ifdef WITH_RECOMPILER
   s_host_code_map.clear();
   s_code_buffer.Reset();
@@ -286,6 +412,7 @@ void Shutdown()
 {
   ClearState();
 #ifdef WITH_RECOMPILER
+  StopCompileThread();
   ShutdownFastmem();
   FreeFastMap();
   s_code_buffer.Destroy();
@@ -313,7 +440,7 @@ static void ExecuteImpl()
     next_block_key = GetNextBlockKey();
     while (g_state.pending_ticks < g_state.downcount)
     {
-      CodeBlock* block = LookupBlock(next_block_key, true);
+      CodeBlock* block = LookupCachedInterpreterBlock(next_block_key, true);
       if (!block)
       {
         InterpretUncachedBlock<pgxp_mode>();
@@ -374,7 +501,7 @@ static void ExecuteImpl()
         }
 
         // No acceptable blocks found in the successor list, try a new one.
-        CodeBlock* next_block = LookupBlock(next_block_key, false);
+        CodeBlock* next_block = LookupCachedInterpreterBlock(next_block_key, false);
         if (next_block)
         {
           // Link the previous block to this new block if we find a new block.
@@ -423,6 +550,84 @@ void CompileDispatcher()
   }
 
   s_code_buffer.WriteProtect(true);
+
+  // Blocks are allocated from the segments after the dispatchers.
+  ResetCodeSegments();
+}
+
+bool HasCodeSpaceForBlock(const CodeBlock* block)
+{
+  return (s_code_buffer.GetFreeCodeSpace() >=
+            (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) &&
+          s_code_buffer.GetFreeFarCodeSpace() >=
+            (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION));
+}
+
+void ResetCodeSegments()
+{
+  s_code_segments_ptr = s_code_buffer.GetFreeCodePointer();
+  s_code_segments_start = s_code_buffer.GetUsedCodeSpace();
+  s_code_segment_size = (s_code_buffer.GetCodeSize() - s_code_segments_start) / RECOMPILER_CODE_SEGMENT_COUNT;
+  s_far_code_segments_start = s_code_buffer.GetUsedFarCodeSpace();
+  s_far_code_segment_size =
+    (s_code_buffer.GetFarCodeSize() - s_far_code_segments_start) / RECOMPILER_CODE_SEGMENT_COUNT;
+  SetCodeSegment(0);
+}
+
+void SetCodeSegment(u32 segment)
+{
+  const u32 code_start = s_code_segments_start + (segment * s_code_segment_size);
+  const u32 far_code_start = s_far_code_segments_start + (segment * s_far_code_segment_size);
+  s_code_buffer.SetAllocationRange(code_start, code_start + s_code_segment_size, far_code_start,
+                                   far_code_start + s_far_code_segment_size);
+  s_current_code_segment = segment;
+}
+
+void RecycleColdestCodeSegment()
+{
+  // Removing blocks modifies the block map, so gather them first.
+  std::array<std::vector<CodeBlock*>, RECOMPILER_CODE_SEGMENT_COUNT> segment_blocks;
+  std::array<u32, RECOMPILER_CODE_SEGMENT_COUNT> segment_hot_bytes = {};
+  for (const auto& it : s_blocks)
+  {
+    CodeBlock* block = it.second;
+    if (!block || !block->host_code)
+      continue;
+
+    const u32 block_segment = static_cast<u32>(
+      (reinterpret_cast<const u8*>(block->host_code) - s_code_segments_ptr) / s_code_segment_size);
+    segment_blocks[block_segment].push_back(block);
+    if ((g_execution_epoch - block->last_execution_epoch) < RECOMPILER_HOT_BLOCK_EPOCHS)
+      segment_hot_bytes[block_segment] += block->host_code_size;
+  }
+
+  // Pick the segment with the least hot code, going from oldest to newest so ties fall back to the oldest.
+  u32 segment = (s_current_code_segment + 1) % RECOMPILER_CODE_SEGMENT_COUNT;
+  for (u32 i = 2; i < RECOMPILER_CODE_SEGMENT_COUNT; i++)
+  {
+    const u32 candidate = (s_current_code_segment + i) % RECOMPILER_CODE_SEGMENT_COUNT;
+    if (segment_hot_bytes[candidate] < segment_hot_bytes[segment])
+      segment = candidate;
+  }
+
+  const std::vector<CodeBlock*>& blocks = segment_blocks[segment];
+  Log_PerfPrintf("Out of code space, recycling segment %u with %zu blocks (%u bytes hot).", segment, blocks.size(),
+                 segment_hot_bytes[segment]);
+
+  // Anything linked to these blocks gets patched back to the resolver. Blocks which are still hot will be
+  // recompiled into the new segment the next time they're executed.
+  for (CodeBlock* block : blocks)
+  {
+    RemoveReferencesToBlock(block);
+
+    // invalidated blocks are left in the host code map
+    if (block->invalidated)
+      RemoveBlockFromHostCodeMap(block);
+
+    delete block;
+  }
+
+  SetCodeSegment(segment);
 }
 
 FastMapTable* GetFastMapPointer()
@@ -462,6 +667,11 @@ void ExecuteRecompiler()
   s_asm_dispatcher();
 #endif
 
+  // Only publish at the end of the frame, which keeps execution deterministic, and means the compile thread is idle
+  // while settings or save states are being applied.
+  PublishBackgroundCompiles();
+  g_execution_epoch++;
+
   // in case we switch to interpreter...
   g_state.regs.npc = g_state.regs.pc;
 }
@@ -474,6 +684,7 @@ void Reinitialize()
 
 #ifdef WITH_RECOMPILER
 
+  StopCompileThread();
   ShutdownFastmem();
   s_code_buffer.Destroy();
 
@@ -496,6 +707,9 @@ void Reinitialize()
     AllocateFastMap();
     CompileDispatcher();
     ResetFastMap();
+
+    if (g_settings.cpu_recompiler_async_compilation)
+      StartCompileThread();
   }
 #endif
 }
@@ -566,8 +780,12 @@ CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush)
     AddBlockToPageMap(block);
 
 #ifdef WITH_RECOMPILER
-    SetFastMap(block->GetPC(), block->host_code);
-    AddBlockToHostCodeMap(block);
+    // blocks being compiled in the background stay on the compile function until they're published
+    if (block->host_code)
+    {
+      SetFastMap(block->GetPC(), block->host_code);
+      AddBlockToHostCodeMap(block);
+    }
 #endif
   }
   else
@@ -601,7 +819,8 @@ bool RevalidateBlock(CodeBlock* block, bool allow_flush)
   block->invalidated = false;
   AddBlockToPageMap(block);
 #ifdef WITH_RECOMPILER
-  SetFastMap(block->GetPC(), block->host_code);
+  if (block->host_code)
+    SetFastMap(block->GetPC(), block->host_code);
 #endif
   return true;
 
@@ -638,6 +857,7 @@ recompile:
   }
 
   block->instructions.clear();
+  block->interpreter_instructions.clear();
 
   if (!CompileBlock(block, allow_flush))
   {
@@ -650,8 +870,11 @@ recompile:
 
 #ifdef WITH_RECOMPILER
   // re-add to page map again
-  SetFastMap(block->GetPC(), block->host_code);
-  AddBlockToHostCodeMap(block);
+  if (block->host_code)
+  {
+    SetFastMap(block->GetPC(), block->host_code);
+    AddBlockToHostCodeMap(block);
+  }
 #endif
 
   // block is valid again
@@ -664,6 +887,7 @@ recompile:
 
 bool CompileBlock(CodeBlock* block, bool allow_flush)
 {
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
   u32 pc = block->GetPC();
   bool is_branch_delay_slot = false;
   bool is_load_delay_slot = false;
@@ -756,6 +980,9 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
   {
     block->instructions.back().is_last_instruction = true;
 
+    if (!g_settings.IsUsingRecompiler())
+      FillInterpreterInstructions(block);
+
 #ifdef _DEBUG
     SmallString disasm;
     Log_DebugPrintf("Block at 0x%08X", block->GetPC());
@@ -776,16 +1003,36 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
 #ifdef WITH_RECOMPILER
   if (g_settings.IsUsingRecompiler())
   {
+    // Count the block as having just run, so it isn't recycled before its host code gets a chance to.
+    block->last_execution_epoch = g_execution_epoch;
+
+    if (ShouldCompileInBackground())
+    {
+      // Interpret the block until its host code is published.
+      FillInterpreterInstructions(block);
+      QueueBackgroundCompile(block);
+      s_compile_statistics.blocks_compiled++;
+      s_compile_statistics.guest_instructions += static_cast<u32>(block->instructions.size());
+      s_compile_statistics.compile_time += Common::Timer::GetCurrentValue() - start_time;
+      return true;
+    }
+
+    // The compile thread can't be writing to the buffer at the same time. Drop any job which is still queued for
+    // this block, since it's about to have host code.
+    WaitForBackgroundCompiles();
+    block->background_compile_id = 0;
+
     // Ensure we're not going to run out of space while compiling this block.
-    if (s_code_buffer.GetFreeCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
-        s_code_buffer.GetFreeFarCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+    if (!HasCodeSpaceForBlock(block))
     {
       if (allow_flush)
       {
-        Log_WarningPrintf("Out of code space, flushing all blocks.");
-        Flush();
+        RecycleColdestCodeSegment();
+        if (!HasCodeSpaceForBlock(block))
+        {
+          Log_WarningPrintf("Out of code space, flushing all blocks.");
+          Flush();
+        }
       }
       else
       {
@@ -804,20 +1051,260 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
       Log_ErrorPrintf("Failed to compile host code for block at 0x%08X", block->key.GetPC());
       return false;
     }
+
+    s_compile_statistics.host_code_bytes += block->host_code_size;
   }
 #endif
 
+  s_compile_statistics.blocks_compiled++;
+  s_compile_statistics.guest_instructions += static_cast<u32>(block->instructions.size());
+  s_compile_statistics.compile_time += Common::Timer::GetCurrentValue() - start_time;
   return true;
 }
 
+const CompileStatistics& GetCompileStatistics()
+{
+  return s_compile_statistics;
+}
+
+void ResetCompileStatistics()
+{
+  s_compile_statistics = {};
+}
+
+void FillInterpreterInstructions(CodeBlock* block)
+{
+  // Pre-pack the instruction stream for the cached interpreter.
+  block->interpreter_instructions.clear();
+  block->interpreter_instructions.reserve(block->instructions.size());
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    block->interpreter_instructions.push_back(
+      {cbi.instruction, cbi.pc | static_cast<u32>(cbi.is_branch_delay_slot)});
+  }
+}
+
 #ifdef WITH_RECOMPILER
 
+void StartCompileThread()
+{
+  if (s_compile_thread.joinable())
+    return;
+
+  s_compile_thread_shutdown = false;
+  s_compile_thread = std::thread(CompileThreadEntryPoint);
+  Log_InfoPrintf("Background compile thread started");
+}
+
+void StopCompileThread()
+{
+  if (!s_compile_thread.joinable())
+    return;
+
+  CancelBackgroundCompiles();
+
+  {
+    std::unique_lock lock(s_compile_mutex);
+    s_compile_thread_shutdown = true;
+    s_compile_work_cv.notify_one();
+  }
+
+  s_compile_thread.join();
+}
+
+void CompileThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("CPU Compile Thread");
+
+  std::unique_lock lock(s_compile_mutex);
+  for (;;)
+  {
+    s_compile_work_cv.wait(lock, []() { return s_compile_thread_shutdown || !s_compile_queue.empty(); });
+    if (s_compile_thread_shutdown)
+      break;
+
+    BackgroundCompileJob job = std::move(s_compile_queue.front());
+    s_compile_queue.pop_front();
+    s_compile_thread_busy = true;
+    lock.unlock();
+
+    // The CPU thread doesn't touch the allocation range while we're busy, so the space check holds.
+    CodeBlock* block = job.staging_block.get();
+    if (HasCodeSpaceForBlock(block))
+    {
+      const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+      s_code_buffer.WriteProtect(false);
+      Recompiler::CodeGenerator codegen(&s_code_buffer);
+      codegen.SetBackgroundCompileState(&job.state);
+      job.compiled = codegen.CompileBlock(block, &block->host_code, &block->host_code_size);
+      s_code_buffer.WriteProtect(true);
+      job.compile_time = Common::Timer::GetCurrentValue() - start_time;
+    }
+    else
+    {
+      job.out_of_space = true;
+    }
+
+    lock.lock();
+    s_compiled_jobs.push_back(std::move(job));
+    s_compile_thread_busy = false;
+    s_compile_done_cv.notify_all();
+  }
+}
+
+bool ShouldCompileInBackground()
+{
+  // The code cache isn't part of save states, so after a rollback, blocks could switch over to host code at a
+  // different point to the other side. Compile synchronously while a netplay session is running.
+  return s_compile_thread.joinable() && !Netplay::Session::IsActive();
+}
+
+void QueueBackgroundCompile(CodeBlock* block)
+{
+  BackgroundCompileJob job;
+  job.id = s_next_compile_id++;
+  if (s_next_compile_id == 0)
+    s_next_compile_id = 1;
+  job.compile_time = 0;
+  job.compiled = false;
+  job.out_of_space = false;
+
+  // The CPU thread can recompile or delete the block while the job is in flight, so compile from a copy.
+  job.staging_block = std::make_unique<CodeBlock>(block->key);
+  job.staging_block->instructions = std::vector<CodeBlockInstruction>(block->instructions);
+  job.staging_block->uncached_fetch_ticks = block->uncached_fetch_ticks;
+  job.staging_block->icache_line_count = block->icache_line_count;
+  job.staging_block->contains_loadstore_instructions = block->contains_loadstore_instructions;
+  job.staging_block->contains_double_branches = block->contains_double_branches;
+
+  // Speculative constants would normally be read at compile time, snapshot them now so the code doesn't depend on
+  // when the job runs.
+  job.state.live_block = block;
+  std::copy(std::begin(g_state.regs.r), std::end(g_state.regs.r), job.state.regs.begin());
+  job.state.cop0_sr = g_state.cop0_regs.sr.bits;
+
+  block->background_compile_id = job.id;
+  block->host_code = nullptr;
+  block->host_code_size = 0;
+  block->loadstore_backpatch_info.clear();
+
+  std::unique_lock lock(s_compile_mutex);
+  s_compile_queue.push_back(std::move(job));
+  s_compile_work_cv.notify_one();
+}
+
+void WaitForBackgroundCompiles()
+{
+  if (!s_compile_thread.joinable())
+    return;
+
+  std::unique_lock lock(s_compile_mutex);
+  s_compile_done_cv.wait(lock, []() { return s_compile_queue.empty() && !s_compile_thread_busy; });
+}
+
+void CancelBackgroundCompiles()
+{
+  if (!s_compile_thread.joinable())
+    return;
+
+  std::unique_lock lock(s_compile_mutex);
+  s_compile_queue.clear();
+  s_compile_done_cv.wait(lock, []() { return !s_compile_thread_busy; });
+  s_compiled_jobs.clear();
+}
+
+void PublishBackgroundCompiles()
+{
+  if (!s_compile_thread.joinable())
+    return;
+
+  WaitForBackgroundCompiles();
+
+  std::vector<BackgroundCompileJob> jobs;
+  {
+    std::unique_lock lock(s_compile_mutex);
+    jobs.swap(s_compiled_jobs);
+  }
+
+  std::vector<BackgroundCompileJob> retry_jobs;
+  for (BackgroundCompileJob& job : jobs)
+  {
+    // skip blocks which were flushed or recompiled while the job was in flight
+    CodeBlock* block = job.state.live_block;
+    const BlockMap::iterator iter = s_blocks.find(job.staging_block->key.bits);
+    if (iter == s_blocks.end() || iter->second != block || block->background_compile_id != job.id)
+      continue;
+
+    if (!job.compiled)
+    {
+      if (job.out_of_space)
+      {
+        job.out_of_space = false;
+        retry_jobs.push_back(std::move(job));
+        continue;
+      }
+
+      Log_ErrorPrintf("Failed to compile host code for block at 0x%08X, falling back to interpreter.", block->GetPC());
+      RemoveReferencesToBlock(block);
+      FallbackExistingBlockToInterpreter(block);
+      continue;
+    }
+
+    CodeBlock* staging_block = job.staging_block.get();
+    block->background_compile_id = 0;
+    block->host_code = staging_block->host_code;
+    block->host_code_size = staging_block->host_code_size;
+    block->loadstore_backpatch_info = std::move(staging_block->loadstore_backpatch_info);
+    std::vector<CachedInterpreterInstruction>().swap(block->interpreter_instructions);
+    AddBlockToHostCodeMap(block);
+
+    s_compile_statistics.host_code_bytes += block->host_code_size;
+    s_compile_statistics.compile_time += job.compile_time;
+
+    // invalidated blocks pick up the host code if they pass revalidation
+    if (!block->invalidated)
+      SetFastMap(block->GetPC(), block->host_code);
+  }
+
+  if (retry_jobs.empty())
+    return;
+
+  // The compile thread filled the current segment, and it's idle now, so it's safe to move on to the next one.
+  RecycleColdestCodeSegment();
+
+  std::unique_lock lock(s_compile_mutex);
+  for (BackgroundCompileJob& job : retry_jobs)
+    s_compile_queue.push_back(std::move(job));
+  s_compile_work_cv.notify_one();
+}
+
 void FastCompileBlockFunction()
 {
   CodeBlock* block = LookupBlock(GetNextBlockKey(), true);
   if (block)
   {
-    s_single_block_asm_dispatcher(block->host_code);
+    if (block->host_code)
+    {
+      s_single_block_asm_dispatcher(block->host_code);
+      return;
+    }
+
+    // Still being compiled in the background.
+    if (g_settings.cpu_recompiler_icache)
+      CheckAndUpdateICacheTags(block->icache_line_count, block->uncached_fetch_ticks);
+
+    if (g_settings.gpu_pgxp_enable)
+    {
+      if (g_settings.gpu_pgxp_cpu)
+        InterpretCachedBlock<PGXPMode::CPU>(*block);
+      else
+        InterpretCachedBlock<PGXPMode::Memory>(*block);
+    }
+    else
+    {
+      InterpretCachedBlock<PGXPMode::Disabled>(*block);
+    }
+
     return;
   }
 
@@ -917,12 +1404,13 @@ void InvalidateAll()
 
 void RemoveReferencesToBlock(CodeBlock* block)
 {
-  BlockMap::iterator iter = s_blocks.find(block->key.GetPC());
+  BlockMap::iterator iter = s_blocks.find(block->key.bits);
   Assert(iter != s_blocks.end() && iter->second == block);
 
 #ifdef WITH_RECOMPILER
   SetFastMap(block->GetPC(), FastCompileBlockFunction);
 #endif
+  RemoveBlockLookupEntry(block);
 
   // if it's been invalidated it won't be in the page map
   if (!block->invalidated)
@@ -1062,7 +1550,8 @@ void AddBlockToHostCodeMap(CodeBlock* block)
 
 void RemoveBlockFromHostCodeMap(CodeBlock* block)
 {
-  if (!g_settings.IsUsingRecompiler())
+  // blocks which are still being compiled in the background aren't in the map
+  if (!g_settings.IsUsingRecompiler() || !block->host_code)
     return;
 
   HostCodeMap::iterator hc_iter = s_host_code_map.find(block->host_code);
@@ -1232,7 +1721,13 @@ void CPU::Recompiler::Thunks::ResolveBranch(CodeBlock* block, void* host_pc, voi
 
   CodeBlockKey key = GetNextBlockKey();
   CodeBlock* successor_block = LookupBlock(key, false);
-  if (!successor_block || (successor_block->invalidated && !RevalidateBlock(successor_block, false)) ||
+  if (successor_block && !successor_block->host_code)
+  {
+    // Successor is still being compiled in the background, leave the branch going to the resolver so it gets linked
+    // once the host code has been published.
+    return;
+  }
+  else if (!successor_block || (successor_block->invalidated && !RevalidateBlock(successor_block, false)) ||
       !block->can_link || !successor_block->can_link)
   {
     // just turn it into a return to the dispatcher instead.
@@ -59,6 +59,17 @@ struct CodeBlockInstruction
   bool can_trap : 1;
 };
 
+/// Compact form of CodeBlockInstruction, used by the cached interpreter. Instructions are always word-aligned, so the
+/// branch delay slot flag is packed into the low bit of the PC.
+struct CachedInterpreterInstruction
+{
+  Instruction instruction;
+  u32 pc_and_flags;
+
+  ALWAYS_INLINE u32 GetPC() const { return pc_and_flags & ~static_cast<u32>(3); }
+  ALWAYS_INLINE bool IsBranchDelaySlot() const { return (pc_and_flags & 1u) != 0; }
+};
+
 struct CodeBlock
 {
   using HostCodePointer = void (*)();
@@ -78,6 +89,7 @@ struct CodeBlock
   HostCodePointer host_code = nullptr;
 
   std::vector<CodeBlockInstruction> instructions;
+  std::vector<CachedInterpreterInstruction> interpreter_instructions;
   std::vector<LinkInfo> link_predecessors;
   std::vector<LinkInfo> link_successors;
 
@@ -86,6 +98,12 @@ struct CodeBlock
 
 #ifdef WITH_RECOMPILER
   std::vector<Recompiler::LoadStoreBackpatchInfo> loadstore_backpatch_info;
+
+  // Non-zero while host code for the block is being generated on the background compile thread.
+  u32 background_compile_id = 0;
+
+  // Value of g_execution_epoch when the block's host code was last entered.
+  u32 last_execution_epoch = 0;
 #endif
 
   bool contains_loadstore_instructions = false;
@@ -129,6 +147,9 @@ using SingleBlockDispatcherFunction = void (*)(const CodeBlock::HostCodePointer)
 
 FastMapTable* GetFastMapPointer();
 void ExecuteRecompiler();
+
+/// Advanced once per frame, and stored to the block by its host code on entry.
+extern u32 g_execution_epoch;
 #endif
 
 /// Flushes the code cache, forcing all blocks to be recompiled.
@@ -143,6 +164,18 @@ void InvalidateBlocksWithPageIndex(u32 page_index);
 /// Invalidates all blocks in the cache.
 void InvalidateAll();
 
+/// Running totals for block compilation, used to measure code generation.
+struct CompileStatistics
+{
+  u32 blocks_compiled;
+  u32 guest_instructions;
+  u64 host_code_bytes;
+  u64 compile_time; // in Common::Timer ticks
+};
+
+const CompileStatistics& GetCompileStatistics();
+void ResetCompileStatistics();
+
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const CodeBlock& block);
 
@@ -2098,14 +2098,14 @@ void InterpretCachedBlock(const CodeBlock& block)
   DebugAssert(g_state.regs.pc == block.GetPC());
   g_state.regs.npc = block.GetPC() + 4;
 
-  for (const CodeBlockInstruction& cbi : block.instructions)
+  for (const CachedInterpreterInstruction& cii : block.interpreter_instructions)
   {
     g_state.pending_ticks++;
 
     // now executing the instruction we previously fetched
-    g_state.current_instruction.bits = cbi.instruction.bits;
-    g_state.current_instruction_pc = cbi.pc;
-    g_state.current_instruction_in_branch_delay_slot = cbi.is_branch_delay_slot;
+    g_state.current_instruction.bits = cii.instruction.bits;
+    g_state.current_instruction_pc = cii.GetPC();
+    g_state.current_instruction_in_branch_delay_slot = cii.IsBranchDelaySlot();
     g_state.current_instruction_was_branch_taken = g_state.branch_was_taken;
     g_state.branch_was_taken = false;
     g_state.exception_raised = false;
@@ -960,6 +960,13 @@ void CodeGenerator::BlockPrologue()
 
   EmitStoreCPUStructField(offsetof(State, exception_raised), Value::FromConstantU8(0));
 
+  // record when the block last ran, so recycling code space can leave hot blocks alone
+  {
+    Value epoch = m_register_cache.AllocateScratch(RegSize_32);
+    EmitLoadGlobal(epoch.GetHostRegister(), RegSize_32, &CodeCache::g_execution_epoch);
+    EmitStoreGlobal(&GetLinkBlock()->last_execution_epoch, epoch);
+  }
+
 #if 0
   EmitFunctionCall(nullptr, &Thunks::LogPC, Value::FromConstantU32(m_pc));
 #endif
@@ -2359,7 +2366,7 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
           SwitchToFarCode();
 
           EmitBeginBlock(true);
-          EmitFunctionCall(nullptr, &CPU::Recompiler::Thunks::ResolveBranch, Value::FromConstantPtr(m_block),
+          EmitFunctionCall(nullptr, &CPU::Recompiler::Thunks::ResolveBranch, Value::FromConstantPtr(GetLinkBlock()),
                            Value::FromConstantPtr(jump_pointer), Value::FromConstantPtr(resolve_pointer),
                            Value::FromConstantU32(jump_size));
           EmitEndBlock(true, true);
@@ -2394,7 +2401,7 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
       SwitchToFarCode();
 
       EmitBeginBlock(true);
-      EmitFunctionCall(nullptr, &CPU::Recompiler::Thunks::ResolveBranch, Value::FromConstantPtr(m_block),
+      EmitFunctionCall(nullptr, &CPU::Recompiler::Thunks::ResolveBranch, Value::FromConstantPtr(GetLinkBlock()),
                        Value::FromConstantPtr(jump_pointer), Value::FromConstantPtr(resolve_pointer),
                        Value::FromConstantU32(jump_size));
       EmitEndBlock(true, true);
@@ -3039,6 +3046,15 @@ bool CodeGenerator::Compile_cop2(const CodeBlockInstruction& cbi)
 
 void CodeGenerator::InitSpeculativeRegs()
 {
+  if (m_background_state)
+  {
+    for (u8 i = 0; i < static_cast<u8>(Reg::count); i++)
+      m_speculative_constants.regs[i] = m_background_state->regs[i];
+
+    m_speculative_constants.cop0_sr = m_background_state->cop0_sr;
+    return;
+  }
+
   for (u8 i = 0; i < static_cast<u8>(Reg::count); i++)
     m_speculative_constants.regs[i] = g_state.regs.r[i];
 
@@ -3070,6 +3086,10 @@ CodeGenerator::SpeculativeValue CodeGenerator::SpeculativeReadMemory(VirtualMemo
   if (it != m_speculative_constants.memory.end())
     return it->second;
 
+  // guest memory is being written by the CPU thread while we compile in the background
+  if (m_background_state)
+    return std::nullopt;
+
   u32 value;
   if ((phys_addr & DCACHE_LOCATION_MASK) == DCACHE_LOCATION)
   {
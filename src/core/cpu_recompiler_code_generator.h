@@ -22,6 +22,14 @@ class CodeGenerator
 public:
   using SpeculativeValue = std::optional<u32>;
 
+  /// CPU state captured when a block is queued for compilation on the background thread.
+  struct BackgroundCompileState
+  {
+    CodeBlock* live_block;
+    std::array<u32, static_cast<u8>(Reg::count)> regs;
+    u32 cop0_sr;
+  };
+
   CodeGenerator(JitCodeBuffer* code_buffer);
   ~CodeGenerator();
 
@@ -34,6 +42,10 @@ public:
 
   bool CompileBlock(CodeBlock* block, CodeBlock::HostCodePointer* out_host_code, u32* out_host_code_size);
 
+  /// Compiles from a copy of the block instead of the CPU state. Branches are resolved against the live block, and
+  /// speculative constants are seeded from the snapshot without reading guest memory.
+  void SetBackgroundCompileState(const BackgroundCompileState* state) { m_background_state = state; }
+
   CodeCache::DispatcherFunction CompileDispatcher();
   CodeCache::SingleBlockDispatcherFunction CompileSingleBlockDispatcher();
 
@@ -215,6 +227,9 @@ private:
   Value GetCurrentInstructionPC(u32 offset = 0);
   void WriteNewPC(const Value& value, bool commit);
 
+  // block passed to the branch resolver, which is not the one being compiled when running in the background
+  CodeBlock* GetLinkBlock() const { return m_background_state ? m_background_state->live_block : m_block; }
+
   Value DoGTERegisterRead(u32 index);
   void DoGTERegisterWrite(u32 index, const Value& value);
 
@@ -244,6 +259,7 @@ private:
 
   JitCodeBuffer* m_code_buffer;
   CodeBlock* m_block = nullptr;
+  const BackgroundCompileState* m_background_state = nullptr;
   const CodeBlockInstruction* m_block_start = nullptr;
   const CodeBlockInstruction* m_block_end = nullptr;
   const CodeBlockInstruction* m_current_instruction = nullptr;
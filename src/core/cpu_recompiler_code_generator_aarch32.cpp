@@ -2105,11 +2105,10 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
   m_emit->Bind(&no_interrupt);
 
   // TimingEvents::UpdateCPUDowncount:
-  // r0 <- head event->downcount
+  // r0 <- next event downcount
   // downcount <- r0
-  EmitLoadGlobalAddress(0, TimingEvents::GetHeadEventPtr());
+  EmitLoadGlobalAddress(0, TimingEvents::GetNextEventDowncountPtr());
   m_emit->ldr(a32::r0, a32::MemOperand(a32::r0));
-  m_emit->ldr(a32::r0, a32::MemOperand(a32::r0, offsetof(TimingEvent, m_downcount)));
   m_emit->str(a32::r0, a32::MemOperand(GetHostReg32(RCPUPTR), offsetof(State, downcount)));
 
   // main dispatch loop
@@ -2145,9 +2144,8 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
 
   // check events then for frame done
   m_emit->ldr(a32::r0, a32::MemOperand(GetHostReg32(RCPUPTR), offsetof(State, pending_ticks)));
-  EmitLoadGlobalAddress(1, TimingEvents::GetHeadEventPtr());
+  EmitLoadGlobalAddress(1, TimingEvents::GetNextEventDowncountPtr());
   m_emit->ldr(a32::r1, a32::MemOperand(a32::r1));
-  m_emit->ldr(a32::r1, a32::MemOperand(a32::r1, offsetof(TimingEvent, m_downcount)));
   m_emit->cmp(a32::r0, a32::r1);
   m_emit->b(a32::lt, &frame_done_loop);
   EmitCall(reinterpret_cast<const void*>(&TimingEvents::RunEvents));
@@ -3054,11 +3054,10 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
   m_emit->L(no_interrupt);
 
   // TimingEvents::UpdateCPUDowncount:
-  // eax <- head event->downcount
+  // eax <- next event downcount
   // downcount <- eax
-  EmitLoadGlobalAddress(Xbyak::Operand::RAX, TimingEvents::GetHeadEventPtr());
-  m_emit->mov(m_emit->rax, m_emit->qword[m_emit->rax]);
-  m_emit->mov(m_emit->eax, m_emit->dword[m_emit->rax + offsetof(TimingEvent, m_downcount)]);
+  EmitLoadGlobalAddress(Xbyak::Operand::RAX, TimingEvents::GetNextEventDowncountPtr());
+  m_emit->mov(m_emit->eax, m_emit->dword[m_emit->rax]);
   m_emit->mov(m_emit->dword[m_emit->rbp + offsetof(State, downcount)], m_emit->eax);
 
   // main dispatch loop
@@ -3093,9 +3092,8 @@ CodeCache::DispatcherFunction CodeGenerator::CompileDispatcher()
   m_emit->L(downcount_hit);
 
   // check events then for frame done
-  EmitLoadGlobalAddress(Xbyak::Operand::RAX, TimingEvents::GetHeadEventPtr());
-  m_emit->mov(m_emit->rax, m_emit->qword[m_emit->rax]);
-  m_emit->mov(m_emit->eax, m_emit->dword[m_emit->rax + offsetof(TimingEvent, m_downcount)]);
+  EmitLoadGlobalAddress(Xbyak::Operand::RAX, TimingEvents::GetNextEventDowncountPtr());
+  m_emit->mov(m_emit->eax, m_emit->dword[m_emit->rax]);
   m_emit->cmp(m_emit->eax, m_emit->dword[m_emit->rbp + offsetof(State, pending_ticks)]);
   m_emit->jg(frame_done_loop);
   EmitCall(reinterpret_cast<const void*>(&TimingEvents::RunEvents));
@@ -17,6 +17,7 @@
 #include "timers.h"
 #include "util/state_wrapper.h"
 #include <cmath>
+#include <cstring>
 Log_SetChannel(GPU);
 
 std::unique_ptr<GPU> g_gpu;
@@ -275,8 +276,16 @@ bool GPU::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_displ
     }
     else
     {
-      ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
-      sw.DoBytes(m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
+      // When writing to memory, the renderer can fill VRAM in once it catches up, instead of being waited on here.
+      u16* buffer = static_cast<u16*>(sw.ReserveBytes(VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16)));
+      if (!buffer || !QueueVRAMCopy(buffer))
+      {
+        ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+        if (buffer)
+          std::memcpy(buffer, m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
+        else
+          sw.DoBytes(m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
+      }
     }
   }
 
@@ -293,6 +302,13 @@ bool GPU::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_displ
   return !sw.HasError();
 }
 
+u64 GPU::GetVRAMCopyFence() const
+{
+  return 0;
+}
+
+void GPU::WaitForVRAMCopies(u64 fence) {}
+
 void GPU::ResetGraphicsAPIState() {}
 
 void GPU::RestoreGraphicsAPIState() {}
@@ -1289,6 +1305,11 @@ void GPU::UpdateDisplay() {}
 
 void GPU::ReadVRAM(u32 x, u32 y, u32 width, u32 height) {}
 
+bool GPU::QueueVRAMCopy(u16* buffer)
+{
+  return false;
+}
+
 void GPU::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
   const u16 color16 = VRAMRGBA8888ToRGBA5551(color);
@@ -87,6 +87,11 @@ public:
   virtual void Reset(bool clear_vram);
   virtual bool DoState(StateWrapper& sw, GPUTexture** save_to_texture, bool update_display);
 
+  /// Memory states can have VRAM copied into them after DoState() returns, once the renderer catches up. This returns
+  /// a fence covering every copy queued so far, and waiting on it guarantees the buffers have been written.
+  virtual u64 GetVRAMCopyFence() const;
+  virtual void WaitForVRAMCopies(u64 fence);
+
   // Graphics API state reset/restore - call when drawing the UI etc.
   virtual void ResetGraphicsAPIState();
   virtual void RestoreGraphicsAPIState();
@@ -287,6 +292,7 @@ protected:
 
   // Rendering in the backend
   virtual void ReadVRAM(u32 x, u32 y, u32 width, u32 height);
+  virtual bool QueueVRAMCopy(u16* buffer);
   virtual void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color);
   virtual void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask);
   virtual void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height);
@@ -7,6 +7,7 @@
 #include "common/timer.h"
 #include "settings.h"
 #include "util/state_wrapper.h"
+#include <cstring>
 Log_SetChannel(GPUBackend);
 
 std::unique_ptr<GPUBackend> g_gpu_backend;
@@ -206,6 +207,24 @@ void GPUBackend::Sync(bool allow_sleep)
   m_sync_semaphore.Wait();
 }
 
+u64 GPUBackend::QueueReadVRAM(u16* buffer)
+{
+  GPUBackendReadVRAMCommand* cmd = static_cast<GPUBackendReadVRAMCommand*>(
+    AllocateCommand(GPUBackendCommandType::ReadVRAM, sizeof(GPUBackendReadVRAMCommand)));
+  cmd->params.bits = 0;
+  cmd->buffer = buffer;
+  cmd->fence = ++m_read_vram_fence;
+  PushCommand(cmd);
+  return m_read_vram_fence;
+}
+
+void GPUBackend::WaitForReadVRAM(u64 fence)
+{
+  // Once synced, every queued read has been done.
+  if (m_completed_read_vram_fence.load() < fence)
+    Sync(false);
+}
+
 void GPUBackend::RunGPULoop()
 {
   static constexpr double SPIN_TIME_NS = 1 * 1000000;
@@ -301,6 +320,15 @@ void GPUBackend::HandleCommand(const GPUBackendCommand* cmd)
     }
     break;
 
+    case GPUBackendCommandType::ReadVRAM:
+    {
+      FlushRender();
+      const GPUBackendReadVRAMCommand* ccmd = static_cast<const GPUBackendReadVRAMCommand*>(cmd);
+      std::memcpy(ccmd->buffer, m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
+      m_completed_read_vram_fence.store(ccmd->fence);
+    }
+    break;
+
     case GPUBackendCommandType::SetDrawingArea:
     {
       FlushRender();
@@ -41,6 +41,12 @@ public:
   void PushCommand(GPUBackendCommand* cmd);
   void Sync(bool allow_sleep);
 
+  /// Queues a copy of all of VRAM to the buffer, which happens once the commands before it have run. Returns a fence
+  /// to pass to WaitForReadVRAM() before the buffer is used.
+  u64 QueueReadVRAM(u16* buffer);
+  u64 GetReadVRAMFence() const { return m_read_vram_fence; }
+  void WaitForReadVRAM(u64 fence);
+
   /// Processes all pending GPU commands.
   void RunGPULoop();
 
@@ -79,6 +85,9 @@ protected:
   std::condition_variable m_wake_gpu_thread_cv;
   bool m_sync_done = false;
 
+  u64 m_read_vram_fence = 0;
+  std::atomic<u64> m_completed_read_vram_fence{0};
+
   enum : u32
   {
     COMMAND_QUEUE_SIZE = 4 * 1024 * 1024,
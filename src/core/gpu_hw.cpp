@@ -130,6 +130,10 @@ void GPU_HW::Reset(bool clear_vram)
 
 bool GPU_HW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display)
 {
+  // loading resets, which marks everything as changed, so work out what really did first
+  const Common::Rectangle<u32> loaded_dirty_rect =
+    (host_texture && sw.IsReading()) ? GetStateTextureDirtyRect(*host_texture) : Common::Rectangle<u32>();
+
   if (!GPU::DoState(sw, host_texture, update_display))
     return false;
 
@@ -141,9 +145,56 @@ bool GPU_HW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
     ResetBatchVertexDepth();
   }
 
+  if (host_texture && *host_texture)
+  {
+    if (sw.IsReading())
+    {
+      // VRAM now matches the loaded texture. Wherever it differed from VRAM before the load, the other textures can
+      // now differ too, on top of where they could already.
+      m_state_dirty_rect = loaded_dirty_rect;
+    }
+    else
+    {
+      UpdateStateDirtyHistory(*host_texture);
+    }
+  }
+
   return true;
 }
 
+Common::Rectangle<u32> GPU_HW::GetStateTextureDirtyRect(const GPUTexture* tex) const
+{
+  const auto it = m_state_texture_serials.find(tex);
+  const u32 age = (it != m_state_texture_serials.end()) ? (m_state_serial - it->second) : MAX_STATE_DIRTY_HISTORY + 1;
+  if (age > m_state_dirty_history.size())
+    return Common::Rectangle<u32>(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+
+  Common::Rectangle<u32> rect = m_state_dirty_rect;
+  for (size_t i = m_state_dirty_history.size() - age; i < m_state_dirty_history.size(); i++)
+    rect.Include(m_state_dirty_history[i]);
+
+  return rect;
+}
+
+void GPU_HW::UpdateStateDirtyHistory(const GPUTexture* host_texture)
+{
+  m_state_serial++;
+  m_state_dirty_history.push_back(m_state_dirty_rect);
+  m_state_dirty_rect.SetInvalid();
+  if (m_state_dirty_history.size() > MAX_STATE_DIRTY_HISTORY)
+    m_state_dirty_history.pop_front();
+
+  // textures which are too old need all of VRAM anyway, and could have been freed since
+  m_state_texture_serials[host_texture] = m_state_serial;
+  for (auto it = m_state_texture_serials.begin(); it != m_state_texture_serials.end();)
+  {
+    if ((m_state_serial - it->second) > MAX_STATE_DIRTY_HISTORY)
+      it = m_state_texture_serials.erase(it);
+    else
+      ++it;
+  }
+}
+
 void GPU_HW::UpdateHWSettings(bool* framebuffer_changed, bool* shaders_changed)
 {
   const u32 resolution_scale = CalculateResolutionScale();
@@ -669,7 +720,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawTriangleTicks(native_vertex_positions[0][0], native_vertex_positions[0][1],
                              native_vertex_positions[1][0], native_vertex_positions[1][1],
                              native_vertex_positions[2][0], native_vertex_positions[2][1], rc.shading_enable,
@@ -703,7 +754,7 @@ void GPU_HW::LoadVertices()
           const u32 clip_bottom =
             static_cast<u32>(std::clamp<s32>(max_y_123, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-          m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+          IncludeDrawDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
           AddDrawTriangleTicks(native_vertex_positions[2][0], native_vertex_positions[2][1],
                                native_vertex_positions[1][0], native_vertex_positions[1][1],
                                native_vertex_positions[3][0], native_vertex_positions[3][1], rc.shading_enable,
@@ -824,7 +875,7 @@ void GPU_HW::LoadVertices()
       const u32 clip_bottom =
         static_cast<u32>(std::clamp<s32>(pos_y + rectangle_height, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-      m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+      IncludeDrawDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
       AddDrawRectangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.texture_enable, rc.transparency_enable);
 
       if (m_sw_renderer)
@@ -887,7 +938,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
         // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -954,7 +1005,7 @@ void GPU_HW::LoadVertices()
             const u32 clip_bottom =
               static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-            m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+            IncludeDrawDirtyRectangle(clip_left, clip_right, clip_top, clip_bottom);
             AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
             // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -1063,6 +1114,7 @@ GPU_HW::VRAMCopyUBOData GPU_HW::GetVRAMCopyUBOData(u32 src_x, u32 src_y, u32 dst
 void GPU_HW::IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect)
 {
   m_vram_dirty_rect.Include(rect);
+  m_state_dirty_rect.Include(rect);
 
   // the vram area can include the texture page, but the game can leave it as-is. in this case, set it as dirty so the
   // shadow texture is updated
@@ -1240,6 +1292,9 @@ void GPU_HW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
   IncludeVRAMDirtyRectangle(
     Common::Rectangle<u32>::FromExtents(x, y, width, height).Clamped(0, 0, VRAM_WIDTH, VRAM_HEIGHT));
+
+  // fills can wrap around, which the clamped rectangle misses
+  m_state_dirty_rect.Include(GetVRAMTransferBounds(x, y, width, height));
 }
 
 void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask)
@@ -1258,6 +1313,7 @@ void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
 {
   IncludeVRAMDirtyRectangle(
     Common::Rectangle<u32>::FromExtents(dst_x, dst_y, width, height).Clamped(0, 0, VRAM_WIDTH, VRAM_HEIGHT));
+  m_state_dirty_rect.Include(GetVRAMTransferBounds(dst_x, dst_y, width, height));
 
   if (m_GPUSTAT.check_mask_before_draw)
   {
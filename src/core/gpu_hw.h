@@ -5,9 +5,11 @@
 #include "common/heap_array.h"
 #include "gpu.h"
 #include "host_display.h"
+#include <deque>
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -221,10 +223,20 @@ protected:
   void SetFullVRAMDirtyRectangle()
   {
     m_vram_dirty_rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    m_state_dirty_rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
     m_draw_mode.SetTexturePageChanged();
   }
   void ClearVRAMDirtyRectangle() { m_vram_dirty_rect.SetInvalid(); }
   void IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect);
+  ALWAYS_INLINE void IncludeDrawDirtyRectangle(u32 left, u32 right, u32 top, u32 bottom)
+  {
+    m_vram_dirty_rect.Include(left, right, top, bottom);
+    m_state_dirty_rect.Include(left, right, top, bottom);
+  }
+
+  /// Returns the area of VRAM which can differ from a memory state texture, in native coordinates. Only this needs to
+  /// be copied when saving to or loading from the texture. Textures which weren't saved recently return all of VRAM.
+  Common::Rectangle<u32> GetStateTextureDirtyRect(const GPUTexture* tex) const;
 
   bool IsFlushed() const { return m_batch_current_vertex_ptr == m_batch_start_vertex_ptr; }
 
@@ -397,6 +409,13 @@ protected:
   // Bounding box of VRAM area that the GPU has drawn into.
   Common::Rectangle<u32> m_vram_dirty_rect;
 
+  // Bounding box of VRAM area changed since the last memory state, and the same for the states before it. Each state
+  // texture remembers which state it was last written by, so it only needs the areas changed since then.
+  Common::Rectangle<u32> m_state_dirty_rect;
+  std::deque<Common::Rectangle<u32>> m_state_dirty_history;
+  std::unordered_map<const GPUTexture*, u32> m_state_texture_serials;
+  u32 m_state_serial = 0;
+
   // Statistics
   RendererStats m_renderer_stats = {};
   RendererStats m_last_renderer_stats = {};
@@ -408,11 +427,14 @@ private:
   enum : u32
   {
     MIN_BATCH_VERTEX_COUNT = 6,
-    MAX_BATCH_VERTEX_COUNT = VERTEX_BUFFER_SIZE / sizeof(BatchVertex)
+    MAX_BATCH_VERTEX_COUNT = VERTEX_BUFFER_SIZE / sizeof(BatchVertex),
+    MAX_STATE_DIRTY_HISTORY = 32
   };
 
   void LoadVertices();
 
+  void UpdateStateDirtyHistory(const GPUTexture* host_texture);
+
   ALWAYS_INLINE void AddVertex(const BatchVertex& v)
   {
     std::memcpy(m_batch_current_vertex_ptr, &v, sizeof(BatchVertex));
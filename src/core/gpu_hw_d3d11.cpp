@@ -99,14 +99,18 @@ bool GPU_HW_D3D11::DoState(StateWrapper& sw, GPUTexture** host_texture, bool upd
         return false;
       }
 
-      m_context->CopySubresourceRegion(m_vram_texture.GetD3DTexture(), 0, 0, 0, 0, tex->GetD3DTexture(), 0, nullptr);
+      const Common::Rectangle<u32> rect = GetStateTextureDirtyRect(tex);
+      if (rect.HasExtents())
+        CopyStateTexture(m_vram_texture, *tex, rect);
     }
     else
     {
+      Common::Rectangle<u32> rect = GetStateTextureDirtyRect(tex);
       if (!tex || tex->GetWidth() != m_vram_texture.GetWidth() || tex->GetHeight() != m_vram_texture.GetHeight() ||
           tex->GetSamples() != m_vram_texture.GetSamples())
       {
         delete tex;
+        rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
 
         tex = static_cast<D3D11::Texture*>(g_host_display
                                              ->CreateTexture(m_vram_texture.GetWidth(), m_vram_texture.GetHeight(), 1,
@@ -118,13 +122,29 @@ bool GPU_HW_D3D11::DoState(StateWrapper& sw, GPUTexture** host_texture, bool upd
           return false;
       }
 
-      m_context->CopySubresourceRegion(tex->GetD3DTexture(), 0, 0, 0, 0, m_vram_texture.GetD3DTexture(), 0, nullptr);
+      if (rect.HasExtents())
+        CopyStateTexture(*tex, m_vram_texture, rect);
     }
   }
 
   return GPU_HW::DoState(sw, host_texture, update_display);
 }
 
+void GPU_HW_D3D11::CopyStateTexture(D3D11::Texture& dst, D3D11::Texture& src, const Common::Rectangle<u32>& rect)
+{
+  // multisampled textures can only be copied whole
+  if (src.IsMultisampled())
+  {
+    m_context->CopySubresourceRegion(dst.GetD3DTexture(), 0, 0, 0, 0, src.GetD3DTexture(), 0, nullptr);
+    return;
+  }
+
+  const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+  const CD3D11_BOX src_box(scaled_rect.left, scaled_rect.top, 0, scaled_rect.right, scaled_rect.bottom, 1);
+  m_context->CopySubresourceRegion(dst.GetD3DTexture(), 0, scaled_rect.left, scaled_rect.top, 0, src.GetD3DTexture(),
+                                   0, &src_box);
+}
+
 void GPU_HW_D3D11::ResetGraphicsAPIState()
 {
   GPU_HW::ResetGraphicsAPIState();
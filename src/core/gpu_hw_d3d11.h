@@ -56,6 +56,7 @@ private:
   };
 
   void SetCapabilities();
+  void CopyStateTexture(D3D11::Texture& dst, D3D11::Texture& src, const Common::Rectangle<u32>& rect);
   bool CreateFramebuffer();
   void ClearFramebuffer();
   void DestroyFramebuffer();
@@ -102,16 +102,23 @@ bool GPU_HW_OpenGL::DoState(StateWrapper& sw, GPUTexture** host_texture, bool up
         return false;
       }
 
-      CopyFramebufferForState(m_vram_texture.GetGLTarget(), static_cast<GL::Texture*>(tex)->GetGLId(), 0, 0, 0,
-                              m_vram_texture.GetGLId(), m_vram_fbo_id, 0, 0, m_vram_texture.GetWidth(),
-                              m_vram_texture.GetHeight());
+      const Common::Rectangle<u32> rect = GetStateTextureDirtyRect(tex);
+      if (rect.HasExtents())
+      {
+        const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+        CopyFramebufferForState(m_vram_texture.GetGLTarget(), static_cast<GL::Texture*>(tex)->GetGLId(), 0,
+                                scaled_rect.left, scaled_rect.top, m_vram_texture.GetGLId(), m_vram_fbo_id,
+                                scaled_rect.left, scaled_rect.top, scaled_rect.GetWidth(), scaled_rect.GetHeight());
+      }
     }
     else
     {
+      Common::Rectangle<u32> rect = GetStateTextureDirtyRect(tex);
       if (!tex || tex->GetWidth() != m_vram_texture.GetWidth() || tex->GetHeight() != m_vram_texture.GetHeight() ||
           tex->GetSamples() != m_vram_texture.GetSamples())
       {
         delete tex;
+        rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
 
         tex = g_host_display
                 ->CreateTexture(m_vram_texture.GetWidth(), m_vram_texture.GetHeight(), 1, 1,
@@ -122,9 +129,13 @@ bool GPU_HW_OpenGL::DoState(StateWrapper& sw, GPUTexture** host_texture, bool up
           return false;
       }
 
-      CopyFramebufferForState(m_vram_texture.GetGLTarget(), m_vram_texture.GetGLId(), m_vram_fbo_id, 0, 0,
-                              static_cast<GL::Texture*>(tex)->GetGLId(), 0, 0, 0, m_vram_texture.GetWidth(),
-                              m_vram_texture.GetHeight());
+      if (rect.HasExtents())
+      {
+        const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+        CopyFramebufferForState(m_vram_texture.GetGLTarget(), m_vram_texture.GetGLId(), m_vram_fbo_id,
+                                scaled_rect.left, scaled_rect.top, static_cast<GL::Texture*>(tex)->GetGLId(), 0,
+                                scaled_rect.left, scaled_rect.top, scaled_rect.GetWidth(), scaled_rect.GetHeight());
+      }
     }
   }
 
@@ -99,12 +99,6 @@ bool GPU_HW_Vulkan::DoState(StateWrapper& sw, GPUTexture** host_texture, bool up
   {
     EndRenderPass();
 
-    const VkImageCopy ic{{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                         {0, 0, 0},
-                         {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                         {0, 0, 0},
-                         {m_vram_texture.GetWidth(), m_vram_texture.GetHeight(), 1u}};
-
     VkCommandBuffer buf = g_vulkan_context->GetCurrentCommandBuffer();
     const Vulkan::Util::DebugScope debugScope(buf, "GPU_HW_Vulkan::DoState");
 
@@ -117,22 +111,29 @@ bool GPU_HW_Vulkan::DoState(StateWrapper& sw, GPUTexture** host_texture, bool up
         return false;
       }
 
-      const VkImageLayout old_tex_layout = tex->GetLayout();
-      const VkImageLayout old_vram_layout = m_vram_texture.GetLayout();
-      tex->TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-      m_vram_texture.TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-      vkCmdCopyImage(g_vulkan_context->GetCurrentCommandBuffer(), tex->GetImage(), tex->GetLayout(),
-                     m_vram_texture.GetImage(), m_vram_texture.GetLayout(), 1, &ic);
-      m_vram_texture.TransitionToLayout(buf, old_vram_layout);
-      tex->TransitionToLayout(buf, old_tex_layout);
+      const Common::Rectangle<u32> rect = GetStateTextureDirtyRect(tex);
+      if (rect.HasExtents())
+      {
+        const VkImageCopy ic = GetStateTextureCopyRegion(rect);
+        const VkImageLayout old_tex_layout = tex->GetLayout();
+        const VkImageLayout old_vram_layout = m_vram_texture.GetLayout();
+        tex->TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        m_vram_texture.TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        vkCmdCopyImage(g_vulkan_context->GetCurrentCommandBuffer(), tex->GetImage(), tex->GetLayout(),
+                       m_vram_texture.GetImage(), m_vram_texture.GetLayout(), 1, &ic);
+        m_vram_texture.TransitionToLayout(buf, old_vram_layout);
+        tex->TransitionToLayout(buf, old_tex_layout);
+      }
     }
     else
     {
       Vulkan::Texture* tex = static_cast<Vulkan::Texture*>(*host_texture);
+      Common::Rectangle<u32> rect = GetStateTextureDirtyRect(tex);
       if (!tex || tex->GetWidth() != m_vram_texture.GetWidth() || tex->GetHeight() != m_vram_texture.GetHeight() ||
           tex->GetSamples() != static_cast<u32>(m_vram_texture.GetSamples()))
       {
         delete tex;
+        rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
 
         tex = static_cast<Vulkan::Texture*>(g_host_display
                                               ->CreateTexture(m_vram_texture.GetWidth(), m_vram_texture.GetHeight(), 1,
@@ -150,19 +151,34 @@ bool GPU_HW_Vulkan::DoState(StateWrapper& sw, GPUTexture** host_texture, bool up
         return false;
       }
 
-      const VkImageLayout old_vram_layout = m_vram_texture.GetLayout();
-      tex->TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-      m_vram_texture.TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-      vkCmdCopyImage(g_vulkan_context->GetCurrentCommandBuffer(), m_vram_texture.GetImage(), m_vram_texture.GetLayout(),
-                     tex->GetImage(), tex->GetLayout(), 1, &ic);
-      m_vram_texture.TransitionToLayout(buf, old_vram_layout);
-      tex->TransitionToLayout(buf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      if (rect.HasExtents())
+      {
+        const VkImageCopy ic = GetStateTextureCopyRegion(rect);
+        const VkImageLayout old_vram_layout = m_vram_texture.GetLayout();
+        tex->TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        m_vram_texture.TransitionToLayout(buf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        vkCmdCopyImage(g_vulkan_context->GetCurrentCommandBuffer(), m_vram_texture.GetImage(),
+                       m_vram_texture.GetLayout(), tex->GetImage(), tex->GetLayout(), 1, &ic);
+        m_vram_texture.TransitionToLayout(buf, old_vram_layout);
+        tex->TransitionToLayout(buf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+      }
     }
   }
 
   return GPU_HW::DoState(sw, host_texture, update_display);
 }
 
+VkImageCopy GPU_HW_Vulkan::GetStateTextureCopyRegion(const Common::Rectangle<u32>& rect) const
+{
+  const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+  const VkOffset3D offset = {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0};
+  return {{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+          offset,
+          {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+          offset,
+          {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}};
+}
+
 void GPU_HW_Vulkan::ResetGraphicsAPIState()
 {
   GPU_HW::ResetGraphicsAPIState();
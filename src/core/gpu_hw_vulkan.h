@@ -57,6 +57,7 @@ private:
   void BeginVRAMRenderPass();
   void EndRenderPass();
   void ExecuteCommandBuffer(bool wait_for_completion, bool restore_state);
+  VkImageCopy GetStateTextureCopyRegion(const Common::Rectangle<u32>& rect) const;
 
   bool CreatePipelineLayouts();
   bool CreateSamplers();
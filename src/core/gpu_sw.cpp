@@ -87,6 +87,16 @@ bool GPU_SW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   return GPU::DoState(sw, nullptr, update_display);
 }
 
+u64 GPU_SW::GetVRAMCopyFence() const
+{
+  return m_backend.GetReadVRAMFence();
+}
+
+void GPU_SW::WaitForVRAMCopies(u64 fence)
+{
+  m_backend.WaitForReadVRAM(fence);
+}
+
 void GPU_SW::Reset(bool clear_vram)
 {
   GPU::Reset(clear_vram);
@@ -852,6 +862,12 @@ void GPU_SW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
   m_backend.Sync(false);
 }
 
+bool GPU_SW::QueueVRAMCopy(u16* buffer)
+{
+  m_backend.QueueReadVRAM(buffer);
+  return true;
+}
+
 void GPU_SW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
   GPUBackendFillVRAMCommand* cmd = m_backend.NewFillVRAMCommand();
@@ -30,11 +30,14 @@ public:
 
   bool Initialize() override;
   bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display) override;
+  u64 GetVRAMCopyFence() const override;
+  void WaitForVRAMCopies(u64 fence) override;
   void Reset(bool clear_vram) override;
   void UpdateSettings() override;
 
 protected:
   void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
+  bool QueueVRAMCopy(u16* buffer) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask) override;
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
@@ -234,6 +234,7 @@ enum class GPUBackendCommandType : u8
   FillVRAM,
   UpdateVRAM,
   CopyVRAM,
+  ReadVRAM,
   SetDrawingArea,
   DrawPolygon,
   DrawRectangle,
@@ -307,6 +308,12 @@ struct GPUBackendCopyVRAMCommand : public GPUBackendCommand
   u16 height;
 };
 
+struct GPUBackendReadVRAMCommand : public GPUBackendCommand
+{
+  u16* buffer;
+  u64 fence;
+};
+
 struct GPUBackendSetDrawingAreaCommand : public GPUBackendCommand
 {
   Common::Rectangle<u32> new_area;
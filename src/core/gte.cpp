@@ -15,6 +15,16 @@
 #include <array>
 #include <numeric>
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 namespace GTE {
 
 static constexpr s64 MAC0_MIN_VALUE = -(INT64_C(1) << 31);
@@ -641,6 +651,269 @@ static void Execute_OP(Instruction inst)
   REGS.FLAG.UpdateError();
 }
 
+// RTPT and the NCT/NCCT/NCDT commands can transform their three vertices side by side, one lane per vertex, as long as
+// none of the 44-bit MAC checks can trigger. That holds when each matrix row's products sum to less than 31 bits for
+// any vector, and the translation leaves that much headroom. Then the 44-bit wrapping is a no-op, the MAC overflow
+// flags can't be raised, and (T*1000h + M*V) SAR (sf*12) only needs 32-bit lanes. Real matrices are in 4.12 fixed
+// point, so this is the usual case; anything else runs the single vertex code three times. The fourth lane repeats
+// the third vertex, so it can't raise a flag the real vertices wouldn't. FLAG is only ever OR'ed into during a
+// command, so raising the bits for all vertices at once gives the same result. The FIFOs are still pushed one vertex
+// at a time.
+static constexpr u32 NUM_LANES = 4;
+using Lanes16 = std::array<s16, NUM_LANES>;
+using Lanes32 = std::array<s32, NUM_LANES>;
+using VectorLanes = std::array<Lanes16, 3>;
+using MACLanes = std::array<Lanes32, 3>;
+
+ALWAYS_INLINE static constexpr u32 IRSaturatedFlag(u32 index)
+{
+  return UINT32_C(1) << (25 - index);
+}
+
+ALWAYS_INLINE static constexpr u32 ColorSaturatedFlag(u32 index)
+{
+  return UINT32_C(1) << (21 - index);
+}
+
+ALWAYS_INLINE static bool IsMatrixInLaneRange(const s16 M[3][3])
+{
+  // |M*V| <= sum(|M|) * 8000h, which must stay below 1 << 31.
+  for (u32 i = 0; i < 3; i++)
+  {
+    if ((std::abs(s32(M[i][0])) + std::abs(s32(M[i][1])) + std::abs(s32(M[i][2]))) >= 0x10000)
+      return false;
+  }
+
+  return true;
+}
+
+ALWAYS_INLINE static bool IsTranslationInLaneRange(const s32 T[3])
+{
+  static constexpr s64 MIN_VALUE = MAC123_MIN_VALUE + (INT64_C(1) << 31);
+  static constexpr s64 MAX_VALUE = MAC123_MAX_VALUE - (INT64_C(1) << 31);
+  for (u32 i = 0; i < 3; i++)
+  {
+    const s64 value = s64(T[i]) << 12;
+    if (value < MIN_VALUE || value > MAX_VALUE)
+      return false;
+  }
+
+  return true;
+}
+
+/// Returns M*V for one matrix row. The matrix must be in lane range.
+ALWAYS_INLINE static Lanes32 MulMatRowLanes(const s16 M[3], const VectorLanes& V)
+{
+  Lanes32 result;
+
+#if defined(CPU_X64)
+  const __m128i vx = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(V[0].data()));
+  const __m128i vy = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(V[1].data()));
+  const __m128i vz = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(V[2].data()));
+  const __m128i mxy = _mm_set1_epi32(static_cast<s32>(ZeroExtend32(static_cast<u16>(M[0])) |
+                                                      (ZeroExtend32(static_cast<u16>(M[1])) << 16)));
+  const __m128i mz = _mm_set1_epi32(static_cast<s32>(ZeroExtend32(static_cast<u16>(M[2]))));
+  const __m128i product = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(vx, vy), mxy),
+                                        _mm_madd_epi16(_mm_unpacklo_epi16(vz, _mm_setzero_si128()), mz));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()), product);
+#elif defined(CPU_AARCH64)
+  int32x4_t product = vmull_n_s16(vld1_s16(V[0].data()), M[0]);
+  product = vmlal_n_s16(product, vld1_s16(V[1].data()), M[1]);
+  product = vmlal_n_s16(product, vld1_s16(V[2].data()), M[2]);
+  vst1q_s32(result.data(), product);
+#else
+  for (u32 lane = 0; lane < NUM_LANES; lane++)
+    result[lane] = (s32(M[0]) * s32(V[0][lane])) + (s32(M[1]) * s32(V[1][lane])) + (s32(M[2]) * s32(V[2][lane]));
+#endif
+
+  return result;
+}
+
+/// Returns the low 32 bits of (T*1000h + value) SAR shift, for a shift of 0 or 12. The translation must be in lane
+/// range, and value must fit in 32 bits.
+ALWAYS_INLINE static Lanes32 TranslateLanes(const Lanes32& value, s32 T, u8 shift)
+{
+  Lanes32 result;
+
+#if defined(CPU_X64)
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value.data()));
+  const __m128i translated = (shift == 0) ? _mm_add_epi32(_mm_set1_epi32(static_cast<s32>(T * 4096u)), v) :
+                                            _mm_add_epi32(_mm_set1_epi32(T), _mm_srai_epi32(v, 12));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()), translated);
+#elif defined(CPU_AARCH64)
+  const int32x4_t v = vld1q_s32(value.data());
+  const int32x4_t translated = (shift == 0) ? vaddq_s32(vdupq_n_s32(static_cast<s32>(T * 4096u)), v) :
+                                              vaddq_s32(vdupq_n_s32(T), vshrq_n_s32(v, 12));
+  vst1q_s32(result.data(), translated);
+#else
+  for (u32 lane = 0; lane < NUM_LANES; lane++)
+    result[lane] = static_cast<s32>(((s64(T) << 12) + value[lane]) >> shift);
+#endif
+
+  return result;
+}
+
+/// Lanes version of TruncateAndSetIR() for IR1-3.
+ALWAYS_INLINE static Lanes16 SaturateIRLanes(const Lanes32& value, bool lm, u32 index, u32* flags)
+{
+  Lanes16 result;
+
+#if defined(CPU_X64)
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value.data()));
+  __m128i saturated = _mm_packs_epi32(v, v);
+  if (lm)
+    saturated = _mm_max_epi16(saturated, _mm_setzero_si128());
+  const __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(saturated, saturated), 16);
+  if (_mm_movemask_epi8(_mm_cmpeq_epi32(widened, v)) != 0xFFFF)
+    *flags |= IRSaturatedFlag(index);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(result.data()), saturated);
+#elif defined(CPU_AARCH64)
+  const int32x4_t v = vld1q_s32(value.data());
+  int16x4_t saturated = vqmovn_s32(v);
+  if (lm)
+    saturated = vmax_s16(saturated, vdup_n_s16(0));
+  if (vminvq_u32(vceqq_s32(vmovl_s16(saturated), v)) == 0)
+    *flags |= IRSaturatedFlag(index);
+  vst1_s16(result.data(), saturated);
+#else
+  const s32 min_value = lm ? 0 : IR123_MIN_VALUE;
+  for (u32 lane = 0; lane < NUM_LANES; lane++)
+  {
+    const s32 saturated = std::clamp(value[lane], min_value, IR123_MAX_VALUE);
+    if (saturated != value[lane])
+      *flags |= IRSaturatedFlag(index);
+    result[lane] = static_cast<s16>(saturated);
+  }
+#endif
+
+  return result;
+}
+
+/// Returns value*M for each lane.
+ALWAYS_INLINE static Lanes32 MultiplyLanes(const Lanes16& value, s16 M)
+{
+  Lanes32 result;
+
+#if defined(CPU_X64)
+  const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(value.data()));
+  const __m128i m = _mm_set1_epi16(M);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()),
+                   _mm_unpacklo_epi16(_mm_mullo_epi16(v, m), _mm_mulhi_epi16(v, m)));
+#elif defined(CPU_AARCH64)
+  vst1q_s32(result.data(), vmull_n_s16(vld1_s16(value.data()), M));
+#else
+  for (u32 lane = 0; lane < NUM_LANES; lane++)
+    result[lane] = s32(value[lane]) * s32(M);
+#endif
+
+  return result;
+}
+
+/// Lanes version of TruncateRGB(), on MAC SAR 4.
+ALWAYS_INLINE static Lanes32 SaturateColorLanes(const Lanes32& mac, u32 index, u32* flags)
+{
+  Lanes32 result;
+
+#if defined(CPU_X64)
+  const __m128i v = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mac.data())), 4);
+  const __m128i words = _mm_packs_epi32(v, v);
+  const __m128i bytes = _mm_packus_epi16(words, words);
+  const __m128i widened = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, _mm_setzero_si128()), _mm_setzero_si128());
+  if (_mm_movemask_epi8(_mm_cmpeq_epi32(widened, v)) != 0xFFFF)
+    *flags |= ColorSaturatedFlag(index);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(result.data()), widened);
+#elif defined(CPU_AARCH64)
+  const int32x4_t v = vshrq_n_s32(vld1q_s32(mac.data()), 4);
+  const uint16x4_t words = vqmovun_s32(v);
+  const uint8x8_t bytes = vqmovn_u16(vcombine_u16(words, words));
+  const int32x4_t widened = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(bytes))));
+  if (vminvq_u32(vceqq_s32(widened, v)) == 0)
+    *flags |= ColorSaturatedFlag(index);
+  vst1q_s32(result.data(), widened);
+#else
+  for (u32 lane = 0; lane < NUM_LANES; lane++)
+  {
+    const s32 value = mac[lane] >> 4;
+    result[lane] = std::clamp(value, 0, 0xFF);
+    if (result[lane] != value)
+      *flags |= ColorSaturatedFlag(index);
+  }
+#endif
+
+  return result;
+}
+
+ALWAYS_INLINE static VectorLanes LoadVertexLanes()
+{
+  VectorLanes V;
+  for (u32 i = 0; i < 3; i++)
+  {
+    V[i][0] = REGS.V0[i];
+    V[i][1] = REGS.V1[i];
+    V[i][2] = REGS.V2[i];
+    V[i][3] = REGS.V2[i];
+  }
+
+  return V;
+}
+
+ALWAYS_INLINE static void SetMACAndIRFromLanes(const MACLanes& mac, const VectorLanes& ir, u32 lane)
+{
+  for (u32 i = 0; i < 3; i++)
+  {
+    REGS.dr32[25 + i] = static_cast<u32>(mac[i][lane]);
+    REGS.dr32[9 + i] = static_cast<u32>(s32(ir[i][lane]));
+  }
+}
+
+/// Lanes version of MulMatVec(). Returns [IR1,IR2,IR3], with [MAC1,MAC2,MAC3] in mac.
+ALWAYS_INLINE static VectorLanes MulMatVecLanes(const s16 M[3][3], const s32 T[3], const VectorLanes& V, u8 shift,
+                                                bool lm, MACLanes* mac, u32* flags)
+{
+  VectorLanes ir;
+  for (u32 i = 0; i < 3; i++)
+  {
+    (*mac)[i] = TranslateLanes(MulMatRowLanes(M[i], V), T[i], shift);
+    ir[i] = SaturateIRLanes((*mac)[i], lm, i + 1, flags);
+  }
+
+  return ir;
+}
+
+/// Returns true if the lighting in NCS, NCCS and NCDS can be done in lanes.
+ALWAYS_INLINE static bool IsLightingInLaneRange()
+{
+  return IsMatrixInLaneRange(REGS.LLM) && IsMatrixInLaneRange(REGS.LCM) && IsTranslationInLaneRange(REGS.BK);
+}
+
+/// Lanes version of the lighting shared by NCS, NCCS and NCDS.
+ALWAYS_INLINE static VectorLanes LightVertexLanes(u8 shift, bool lm, MACLanes* mac, u32* flags)
+{
+  static constexpr s32 zero_T[3] = {};
+
+  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (LLM*V0) SAR (sf*12)
+  const VectorLanes ir = MulMatVecLanes(REGS.LLM, zero_T, LoadVertexLanes(), shift, lm, mac, flags);
+
+  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (BK*1000h + LCM*IR) SAR (sf*12)
+  return MulMatVecLanes(REGS.LCM, REGS.BK, ir, shift, lm, mac, flags);
+}
+
+/// Lanes version of PushRGBFromMAC(). Three pushes replace the whole FIFO.
+ALWAYS_INLINE static void PushRGBFromMACLanes(const MACLanes& mac, u32* flags)
+{
+  const Lanes32 r = SaturateColorLanes(mac[0], 0, flags);
+  const Lanes32 g = SaturateColorLanes(mac[1], 1, flags);
+  const Lanes32 b = SaturateColorLanes(mac[2], 2, flags);
+  const u32 c = ZeroExtend32(REGS.RGBC[3]);
+  for (u32 i = 0; i < 3; i++)
+  {
+    REGS.dr32[20 + i] =
+      static_cast<u32>(r[i]) | (static_cast<u32>(g[i]) << 8) | (static_cast<u32>(b[i]) << 16) | (c << 24);
+  }
+}
+
+static void RTPSProject(s64 x, s64 y, s64 z, u8 shift, bool lm, bool last);
+
 static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
 {
 #define dot3(i)                                                                                                        \
@@ -670,6 +943,11 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
   // SZ3 = MAC3 SAR ((1-sf)*12)                           ;ScreenZ FIFO 0..+FFFFh
   PushSZ(s32(z >> 12));
 
+  RTPSProject(x, y, z, shift, lm, last);
+}
+
+static void RTPSProject(s64 x, s64 y, s64 z, u8 shift, bool lm, bool last)
+{
   // MAC0=(((H*20000h/SZ3)+1)/2)*IR1+OFX, SX2=MAC0/10000h ;ScrX FIFO -400h..+3FFh
   // MAC0=(((H*20000h/SZ3)+1)/2)*IR2+OFY, SY2=MAC0/10000h ;ScrY FIFO -400h..+3FFh
   const s64 result = static_cast<s64>(ZeroExtend64(UNRDivide(REGS.H, REGS.SZ3)));
@@ -801,9 +1079,44 @@ static void Execute_RTPT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  RTPS(REGS.V0, shift, lm, false);
-  RTPS(REGS.V1, shift, lm, false);
-  RTPS(REGS.V2, shift, lm, true);
+  if (!IsMatrixInLaneRange(REGS.RT) || !IsTranslationInLaneRange(REGS.TR))
+  {
+    RTPS(REGS.V0, shift, lm, false);
+    RTPS(REGS.V1, shift, lm, false);
+    RTPS(REGS.V2, shift, lm, true);
+    REGS.FLAG.UpdateError();
+    return;
+  }
+
+  // Same as RTPS() for each vertex.
+  u32 flags = 0;
+  const VectorLanes V = LoadVertexLanes();
+  MACLanes products;
+  MACLanes mac;
+  VectorLanes ir;
+  for (u32 i = 0; i < 3; i++)
+  {
+    products[i] = MulMatRowLanes(REGS.RT[i], V);
+    mac[i] = TranslateLanes(products[i], REGS.TR[i], shift);
+  }
+  ir[0] = SaturateIRLanes(mac[0], lm, 1, &flags);
+  ir[1] = SaturateIRLanes(mac[1], lm, 2, &flags);
+
+  // IR3 is saturated from MAC3, but the flag comes from MAC3 SAR 12 regardless of sf.
+  u32 ir3_value_flags = 0;
+  const Lanes32 screen_z = TranslateLanes(products[2], REGS.TR[2], 12);
+  SaturateIRLanes(screen_z, false, 3, &flags);
+  ir[2] = SaturateIRLanes(mac[2], lm, 3, &ir3_value_flags);
+  REGS.FLAG.bits |= flags;
+
+  // Projection needs the divide, so it's done one vertex at a time, with the vertex's IR1/IR2 in the registers.
+  for (u32 i = 0; i < 3; i++)
+  {
+    SetMACAndIRFromLanes(mac, ir, i);
+    PushSZ(screen_z[i]);
+    RTPSProject((s64(REGS.TR[0]) << 12) + products[0][i], (s64(REGS.TR[1]) << 12) + products[1][i],
+                (s64(REGS.TR[2]) << 12) + products[2][i], shift, lm, i == 2);
+  }
 
   REGS.FLAG.UpdateError();
 }
@@ -899,10 +1212,23 @@ static void Execute_NCT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  NCS(REGS.V0, shift, lm);
-  NCS(REGS.V1, shift, lm);
-  NCS(REGS.V2, shift, lm);
+  if (!IsLightingInLaneRange())
+  {
+    NCS(REGS.V0, shift, lm);
+    NCS(REGS.V1, shift, lm);
+    NCS(REGS.V2, shift, lm);
+    REGS.FLAG.UpdateError();
+    return;
+  }
+
+  // Same as NCS() for each vertex.
+  u32 flags = 0;
+  MACLanes mac;
+  const VectorLanes ir = LightVertexLanes(shift, lm, &mac, &flags);
+  PushRGBFromMACLanes(mac, &flags);
+  SetMACAndIRFromLanes(mac, ir, 2);
 
+  REGS.FLAG.bits |= flags;
   REGS.FLAG.UpdateError();
 }
 
@@ -940,10 +1266,33 @@ static void Execute_NCCT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  NCCS(REGS.V0, shift, lm);
-  NCCS(REGS.V1, shift, lm);
-  NCCS(REGS.V2, shift, lm);
+  if (!IsLightingInLaneRange())
+  {
+    NCCS(REGS.V0, shift, lm);
+    NCCS(REGS.V1, shift, lm);
+    NCCS(REGS.V2, shift, lm);
+    REGS.FLAG.UpdateError();
+    return;
+  }
 
+  // Same as NCCS() for each vertex.
+  u32 flags = 0;
+  MACLanes mac;
+  VectorLanes ir = LightVertexLanes(shift, lm, &mac, &flags);
+
+  // [MAC1,MAC2,MAC3] = ([R*IR1,G*IR2,B*IR3] SHL 4) SAR (sf*12), which can't overflow
+  for (u32 i = 0; i < 3; i++)
+  {
+    const Lanes32 color = MultiplyLanes(ir[i], static_cast<s16>(ZeroExtend16(REGS.RGBC[i])));
+    for (u32 lane = 0; lane < NUM_LANES; lane++)
+      mac[i][lane] = (color[lane] << 4) >> shift;
+    ir[i] = SaturateIRLanes(mac[i], lm, i + 1, &flags);
+  }
+
+  PushRGBFromMACLanes(mac, &flags);
+  SetMACAndIRFromLanes(mac, ir, 2);
+
+  REGS.FLAG.bits |= flags;
   REGS.FLAG.UpdateError();
 }
 
@@ -984,10 +1333,42 @@ static void Execute_NCDT(Instruction inst)
   const u8 shift = inst.GetShift();
   const bool lm = inst.lm;
 
-  NCDS(REGS.V0, shift, lm);
-  NCDS(REGS.V1, shift, lm);
-  NCDS(REGS.V2, shift, lm);
+  if (!IsLightingInLaneRange() || !IsTranslationInLaneRange(REGS.FC))
+  {
+    NCDS(REGS.V0, shift, lm);
+    NCDS(REGS.V1, shift, lm);
+    NCDS(REGS.V2, shift, lm);
+    REGS.FLAG.UpdateError();
+    return;
+  }
+
+  // Same as NCDS() for each vertex.
+  u32 flags = 0;
+  MACLanes mac;
+  VectorLanes ir = LightVertexLanes(shift, lm, &mac, &flags);
+
+  for (u32 i = 0; i < 3; i++)
+  {
+    // [MAC1,MAC2,MAC3] = [R*IR1,G*IR2,B*IR3] SHL 4, kept negated for the subtraction from the far color
+    Lanes32 neg_in_MAC = MultiplyLanes(ir[i], static_cast<s16>(ZeroExtend16(REGS.RGBC[i])));
+    for (u32 lane = 0; lane < NUM_LANES; lane++)
+      neg_in_MAC[lane] = -(neg_in_MAC[lane] << 4);
+
+    // [IR1,IR2,IR3] = (([RFC,GFC,BFC] SHL 12) - [MAC1,MAC2,MAC3]) SAR (sf*12)
+    mac[i] = TranslateLanes(neg_in_MAC, REGS.FC[i], shift);
+    ir[i] = SaturateIRLanes(mac[i], false, i + 1, &flags);
+
+    // [MAC1,MAC2,MAC3] = (([IR1,IR2,IR3] * IR0) + [MAC1,MAC2,MAC3]) SAR (sf*12), which can't overflow
+    const Lanes32 interpolated = MultiplyLanes(ir[i], REGS.IR0);
+    for (u32 lane = 0; lane < NUM_LANES; lane++)
+      mac[i][lane] = (interpolated[lane] - neg_in_MAC[lane]) >> shift;
+    ir[i] = SaturateIRLanes(mac[i], lm, i + 1, &flags);
+  }
+
+  PushRGBFromMACLanes(mac, &flags);
+  SetMACAndIRFromLanes(mac, ir, 2);
 
+  REGS.FLAG.bits |= flags;
   REGS.FLAG.UpdateError();
 }
 
@@ -15,6 +15,16 @@
 #include <array>
 #include <memory>
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 Log_SetChannel(MDEC);
 
 namespace MDEC {
@@ -105,12 +115,13 @@ static void CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late);
 
 // from nocash spec
 static bool rl_decode_block(s16* blk, const u8* qt);
+static void UpdateIDCTTable();
 static void IDCT(s16* blk);
 static void IDCT_New(s16* blk);
 static void IDCT_Old(s16* blk);
-static void yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                       const std::array<s16, 64>& Yblk);
+static void yuv_to_rgb_macroblock();
 static void y_to_mono(const std::array<s16, 64>& Yblk);
+static void rgb_to_rgb15(u32* out);
 
 static StatusRegister s_status = {};
 static bool s_enable_dma_in = false;
@@ -127,6 +138,10 @@ static std::array<u8, 64> s_iq_y{};
 
 static std::array<s16, 64> s_scale_table{};
 
+// Scale table divided by 8 for the IDCT, and the same values with rows 2k and 2k+1 interleaved for multiply-adds.
+alignas(16) static std::array<s16, 64> s_idct_table{};
+alignas(16) static std::array<u32, 32> s_idct_row_pairs{};
+
 // blocks, for colour: 0 - Crblk, 1 - Cbblk, 2-5 - Y 1-4
 static std::array<std::array<s16, 64>, NUM_BLOCKS> s_blocks;
 static u32 s_current_block = 0;        // block (0-5)
@@ -144,6 +159,7 @@ void MDEC::Initialize()
   s_block_copy_out_event =
     TimingEvents::CreateTimingEvent("MDEC Block Copy Out", 1, 1, &MDEC::CopyOutBlock, nullptr, false);
   s_total_blocks_decoded = 0;
+  UpdateIDCTTable();
   Reset();
 }
 
@@ -179,7 +195,10 @@ bool MDEC::DoState(StateWrapper& sw)
   bool block_copy_out_pending = HasPendingBlockCopyOut();
   sw.Do(&block_copy_out_pending);
   if (sw.IsReading())
+  {
+    UpdateIDCTTable();
     s_block_copy_out_event->SetState(block_copy_out_pending);
+  }
 
   return !sw.HasError();
 }
@@ -531,10 +550,7 @@ bool MDEC::DecodeColoredMacroblock()
   ResetDecoder();
   s_state = State::WritingMacroblock;
 
-  yuv_to_rgb(0, 0, s_blocks[0], s_blocks[1], s_blocks[2]);
-  yuv_to_rgb(8, 0, s_blocks[0], s_blocks[1], s_blocks[3]);
-  yuv_to_rgb(0, 8, s_blocks[0], s_blocks[1], s_blocks[4]);
-  yuv_to_rgb(8, 8, s_blocks[0], s_blocks[1], s_blocks[5]);
+  yuv_to_rgb_macroblock();
   s_total_blocks_decoded += 4;
 
   ScheduleBlockCopyOut(TICKS_PER_BLOCK * 6);
@@ -590,40 +606,20 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
 
     case DataOutputDepth_24Bit:
     {
-      // pack tightly
-      u32 index = 0;
-      u32 state = 0;
-      u32 rgb = 0;
-      while (index < s_block_rgb.size())
+      // pack tightly, four pixels to three words
+      std::array<u32, 64 * 3> packed;
+      u32* out_ptr = packed.data();
+      for (u32 i = 0; i < static_cast<u32>(s_block_rgb.size()); i += 4)
       {
-        switch (state)
-        {
-          case 0:
-            rgb = s_block_rgb[index++]; // RGB-
-            state = 1;
-            break;
-          case 1:
-            rgb |= (s_block_rgb[index] & 0xFF) << 24; // RGBR
-            s_data_out_fifo.Push(rgb);
-            rgb = s_block_rgb[index] >> 8; // GB--
-            index++;
-            state = 2;
-            break;
-          case 2:
-            rgb |= s_block_rgb[index] << 16; // GBRG
-            s_data_out_fifo.Push(rgb);
-            rgb = s_block_rgb[index] >> 16; // B---
-            index++;
-            state = 3;
-            break;
-          case 3:
-            rgb |= s_block_rgb[index] << 8; // BRGB
-            s_data_out_fifo.Push(rgb);
-            index++;
-            state = 0;
-            break;
-        }
+        const u32 p0 = s_block_rgb[i + 0];
+        const u32 p1 = s_block_rgb[i + 1];
+        const u32 p2 = s_block_rgb[i + 2];
+        const u32 p3 = s_block_rgb[i + 3];
+        *(out_ptr++) = p0 | ((p1 & 0xFF) << 24); // RGBR
+        *(out_ptr++) = (p1 >> 8) | (p2 << 16);   // GBRG
+        *(out_ptr++) = (p2 >> 16) | (p3 << 8);   // BRGB
       }
+      s_data_out_fifo.PushRange(packed.data(), static_cast<u32>(packed.size()));
       break;
     }
 
@@ -651,25 +647,9 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
       }
       else
       {
-        const u32 a = ZeroExtend32(s_status.data_output_bit15.GetValue()) << 15;
-        for (u32 i = 0; i < static_cast<u32>(s_block_rgb.size());)
-        {
-#define E8TO5(color) (std::min<u32>((((color) + 4) >> 3), 0x1F))
-          u32 color = s_block_rgb[i++];
-          u32 r = E8TO5(color & 0xFFu);
-          u32 g = E8TO5((color >> 8) & 0xFFu);
-          u32 b = E8TO5((color >> 16) & 0xFFu);
-          const u32 color15a = r | (g << 5) | (b << 10) | a;
-
-          color = s_block_rgb[i++];
-          r = E8TO5(color & 0xFFu);
-          g = E8TO5((color >> 8) & 0xFFu);
-          b = E8TO5((color >> 16) & 0xFFu);
-          const u32 color15b = r | (g << 5) | (b << 10) | a;
-#undef E8TO5
-
-          s_data_out_fifo.Push(color15a | (color15b << 16));
-        }
+        std::array<u32, 256 / 2> packed;
+        rgb_to_rgb15(packed.data());
+        s_data_out_fifo.PushRange(packed.data(), static_cast<u32>(packed.size()));
       }
     }
     break;
@@ -770,6 +750,138 @@ void MDEC::IDCT(s16* blk)
     IDCT_New(blk);
 }
 
+void MDEC::UpdateIDCTTable()
+{
+  for (u32 i = 0; i < 64; i++)
+    s_idct_table[i] = s_scale_table[i] / 8;
+
+  for (u32 k = 0; k < 4; k++)
+  {
+    for (u32 x = 0; x < 8; x++)
+    {
+      s_idct_row_pairs[k * 8 + x] = ZeroExtend32(static_cast<u16>(s_idct_table[(k * 2 + 0) * 8 + x])) |
+                                    (ZeroExtend32(static_cast<u16>(s_idct_table[(k * 2 + 1) * 8 + x])) << 16);
+    }
+  }
+}
+
+#if defined(CPU_X64)
+
+ALWAYS_INLINE static __m128i IDCTRound(__m128i sum)
+{
+  // (sum + 0xfff) / 0x2000, truncating towards zero like the division does.
+  const __m128i value = _mm_add_epi32(sum, _mm_set1_epi32(0xfff));
+  const __m128i bias = _mm_and_si128(_mm_srai_epi32(value, 31), _mm_set1_epi32(0x1fff));
+  return _mm_srai_epi32(_mm_add_epi32(value, bias), 13);
+}
+
+void MDEC::IDCT_New(s16* blk)
+{
+  // Each pass is a transposed matrix multiply by the scale table. The first pass produces its result transposed,
+  // which puts the pairs of coefficients the second pass needs next to each other. Coefficients are at most 11 bits
+  // and the table 13 bits, so the intermediate rows fit in 16 bits.
+  const __m128i* row_pairs = reinterpret_cast<const __m128i*>(s_idct_row_pairs.data());
+
+  __m128i blk_pairs_lo[4], blk_pairs_hi[4];
+  for (u32 k = 0; k < 4; k++)
+  {
+    const __m128i row0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[(k * 2 + 0) * 8]));
+    const __m128i row1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[(k * 2 + 1) * 8]));
+    blk_pairs_lo[k] = _mm_unpacklo_epi16(row0, row1);
+    blk_pairs_hi[k] = _mm_unpackhi_epi16(row0, row1);
+  }
+
+  __m128i temp[8];
+  for (u32 x = 0; x < 8; x++)
+  {
+    __m128i sum_lo = _mm_setzero_si128();
+    __m128i sum_hi = _mm_setzero_si128();
+    for (u32 k = 0; k < 4; k++)
+    {
+      const __m128i coeff = _mm_set1_epi32(static_cast<s32>(s_idct_row_pairs[k * 8 + x]));
+      sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(blk_pairs_lo[k], coeff));
+      sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(blk_pairs_hi[k], coeff));
+    }
+    temp[x] = _mm_packs_epi32(IDCTRound(sum_lo), IDCTRound(sum_hi));
+  }
+
+  for (u32 y = 0; y < 8; y++)
+  {
+    const __m128i t01 = _mm_shuffle_epi32(temp[y], _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128i t23 = _mm_shuffle_epi32(temp[y], _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128i t45 = _mm_shuffle_epi32(temp[y], _MM_SHUFFLE(2, 2, 2, 2));
+    const __m128i t67 = _mm_shuffle_epi32(temp[y], _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i sum_lo =
+      _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(t01, row_pairs[0]), _mm_madd_epi16(t23, row_pairs[2])),
+                    _mm_add_epi32(_mm_madd_epi16(t45, row_pairs[4]), _mm_madd_epi16(t67, row_pairs[6])));
+    const __m128i sum_hi =
+      _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(t01, row_pairs[1]), _mm_madd_epi16(t23, row_pairs[3])),
+                    _mm_add_epi32(_mm_madd_epi16(t45, row_pairs[5]), _mm_madd_epi16(t67, row_pairs[7])));
+    const __m128i result = _mm_packs_epi32(IDCTRound(sum_lo), IDCTRound(sum_hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&blk[y * 8]),
+                     _mm_min_epi16(_mm_max_epi16(result, _mm_set1_epi16(-128)), _mm_set1_epi16(127)));
+  }
+}
+
+#elif defined(CPU_AARCH64)
+
+ALWAYS_INLINE static int32x4_t IDCTRound(int32x4_t sum)
+{
+  // (sum + 0xfff) / 0x2000, truncating towards zero like the division does.
+  const int32x4_t value = vaddq_s32(sum, vdupq_n_s32(0xfff));
+  const int32x4_t bias = vandq_s32(vshrq_n_s32(value, 31), vdupq_n_s32(0x1fff));
+  return vshrq_n_s32(vaddq_s32(value, bias), 13);
+}
+
+void MDEC::IDCT_New(s16* blk)
+{
+  // Each pass is a transposed matrix multiply by the scale table. The first pass produces its result transposed, so
+  // the second pass can take its multipliers from lanes. Intermediate rows fit in 16 bits, see the x64 version.
+  int16x8_t rows[8], table[8];
+  for (u32 z = 0; z < 8; z++)
+  {
+    rows[z] = vld1q_s16(&blk[z * 8]);
+    table[z] = vld1q_s16(&s_idct_table[z * 8]);
+  }
+
+  int16x8_t temp[8];
+  for (u32 x = 0; x < 8; x++)
+  {
+    int32x4_t sum_lo = vdupq_n_s32(0);
+    int32x4_t sum_hi = vdupq_n_s32(0);
+    for (u32 z = 0; z < 8; z++)
+    {
+      const s16 coeff = s_idct_table[z * 8 + x];
+      sum_lo = vmlal_n_s16(sum_lo, vget_low_s16(rows[z]), coeff);
+      sum_hi = vmlal_n_s16(sum_hi, vget_high_s16(rows[z]), coeff);
+    }
+    temp[x] = vcombine_s16(vqmovn_s32(IDCTRound(sum_lo)), vqmovn_s32(IDCTRound(sum_hi)));
+  }
+
+  for (u32 y = 0; y < 8; y++)
+  {
+    int32x4_t sum_lo = vdupq_n_s32(0);
+    int32x4_t sum_hi = vdupq_n_s32(0);
+#define IDCT_ROW(z)                                                                                                    \
+  sum_lo = vmlal_laneq_s16(sum_lo, vget_low_s16(table[z]), temp[y], z);                                                \
+  sum_hi = vmlal_laneq_s16(sum_hi, vget_high_s16(table[z]), temp[y], z)
+    IDCT_ROW(0);
+    IDCT_ROW(1);
+    IDCT_ROW(2);
+    IDCT_ROW(3);
+    IDCT_ROW(4);
+    IDCT_ROW(5);
+    IDCT_ROW(6);
+    IDCT_ROW(7);
+#undef IDCT_ROW
+
+    const int16x8_t result = vcombine_s16(vqmovn_s32(IDCTRound(sum_lo)), vqmovn_s32(IDCTRound(sum_hi)));
+    vst1q_s16(&blk[y * 8], vminq_s16(vmaxq_s16(result, vdupq_n_s16(-128)), vdupq_n_s16(127)));
+  }
+}
+
+#else
+
 void MDEC::IDCT_New(s16* blk)
 {
   std::array<s32, 64> temp;
@@ -777,11 +889,9 @@ void MDEC::IDCT_New(s16* blk)
   {
     for (u32 y = 0; y < 8; y++)
     {
-      // TODO: We could alter zigzag and invert scale_table to get these in row-major order,
-      // in which case we could do optimize this to a vector multiply.
       s32 sum = 0;
       for (u32 z = 0; z < 8; z++)
-        sum += s32(blk[y + z * 8]) * s32(s_scale_table[x + z * 8] / 8);
+        sum += s32(blk[y + z * 8]) * s32(s_idct_table[x + z * 8]);
       temp[x + y * 8] = static_cast<s32>((sum + 0xfff) / 0x2000);
     }
   }
@@ -791,12 +901,14 @@ void MDEC::IDCT_New(s16* blk)
     {
       s32 sum = 0;
       for (u32 z = 0; z < 8; z++)
-        sum += temp[y + z * 8] * s32(s_scale_table[x + z * 8] / 8);
+        sum += temp[y + z * 8] * s32(s_idct_table[x + z * 8]);
       blk[x + y * 8] = static_cast<s16>(std::clamp<s32>((sum + 0xfff) / 0x2000, -128, 127));
     }
   }
 }
 
+#endif
+
 void MDEC::IDCT_Old(s16* blk)
 {
   std::array<s64, 64> temp_buffer;
@@ -824,29 +936,91 @@ void MDEC::IDCT_Old(s16* blk)
   }
 }
 
-void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                      const std::array<s16, 64>& Yblk)
+void MDEC::yuv_to_rgb_macroblock()
 {
+  const std::array<s16, 64>& Crblk = s_blocks[0];
+  const std::array<s16, 64>& Cbblk = s_blocks[1];
+
+  // The colour terms only depend on the 8x8 chroma blocks, so compute them once per chroma sample instead of for
+  // each of the four pixels which share it. Same float expressions as per-pixel conversion.
+  alignas(16) std::array<s16, 64> Rblk, Gblk, Bblk;
+  for (u32 i = 0; i < 64; i++)
+  {
+    const s16 R = Crblk[i];
+    const s16 B = Cbblk[i];
+    Gblk[i] = static_cast<s16>((-0.3437f * static_cast<float>(B)) + (-0.7143f * static_cast<float>(R)));
+    Rblk[i] = static_cast<s16>(1.402f * static_cast<float>(R));
+    Bblk[i] = static_cast<s16>(1.772f * static_cast<float>(B));
+  }
+
   const s16 addval = s_status.data_output_signed ? 0 : 0x80;
-  for (u32 y = 0; y < 8; y++)
+  for (u32 y = 0; y < 16; y++)
   {
-    for (u32 x = 0; x < 8; x++)
+    for (u32 half = 0; half < 2; half++)
     {
-      s16 R = Crblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
-      s16 B = Cbblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
-      s16 G = static_cast<s16>((-0.3437f * static_cast<float>(B)) + (-0.7143f * static_cast<float>(R)));
-
-      R = static_cast<s16>(1.402f * static_cast<float>(R));
-      B = static_cast<s16>(1.772f * static_cast<float>(B));
-
-      s16 Y = Yblk[x + y * 8];
-      R = static_cast<s16>(std::clamp(static_cast<int>(Y) + R, -128, 127)) + addval;
-      G = static_cast<s16>(std::clamp(static_cast<int>(Y) + G, -128, 127)) + addval;
-      B = static_cast<s16>(std::clamp(static_cast<int>(Y) + B, -128, 127)) + addval;
-
-      s_block_rgb[(x + xx) + ((y + yy) * 16)] = ZeroExtend32(static_cast<u16>(R)) |
-                                                (ZeroExtend32(static_cast<u16>(G)) << 8) |
-                                                (ZeroExtend32(static_cast<u16>(B)) << 16);
+      // 8 output pixels use 4 chroma samples, each duplicated horizontally.
+      const s16* Yrow = &s_blocks[2 + ((y / 8) * 2) + half][(y % 8) * 8];
+      const u32 chroma_index = ((y / 2) * 8) + (half * 4);
+      u32* out = &s_block_rgb[(y * 16) + (half * 8)];
+
+#if defined(CPU_X64)
+      const __m128i Y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Yrow));
+      const __m128i min = _mm_set1_epi16(-128);
+      const __m128i max = _mm_set1_epi16(127);
+      const __m128i add = _mm_set1_epi16(addval);
+      const auto convert = [&](const s16* chroma) {
+        const __m128i C = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(chroma));
+        const __m128i value = _mm_add_epi16(Y, _mm_unpacklo_epi16(C, C));
+        return _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(value, min), max), add);
+      };
+      const __m128i r = convert(&Rblk[chroma_index]);
+      const __m128i g = convert(&Gblk[chroma_index]);
+      const __m128i b = convert(&Bblk[chroma_index]);
+
+      // Components are ORed in as zero-extended 16-bit values, same as the scalar conversion.
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i rgb_lo =
+        _mm_or_si128(_mm_or_si128(_mm_unpacklo_epi16(r, zero), _mm_slli_epi32(_mm_unpacklo_epi16(g, zero), 8)),
+                     _mm_slli_epi32(_mm_unpacklo_epi16(b, zero), 16));
+      const __m128i rgb_hi =
+        _mm_or_si128(_mm_or_si128(_mm_unpackhi_epi16(r, zero), _mm_slli_epi32(_mm_unpackhi_epi16(g, zero), 8)),
+                     _mm_slli_epi32(_mm_unpackhi_epi16(b, zero), 16));
+      _mm_store_si128(reinterpret_cast<__m128i*>(out), rgb_lo);
+      _mm_store_si128(reinterpret_cast<__m128i*>(out + 4), rgb_hi);
+#elif defined(CPU_AARCH64)
+      const int16x8_t Y = vld1q_s16(Yrow);
+      const int16x8_t min = vdupq_n_s16(-128);
+      const int16x8_t max = vdupq_n_s16(127);
+      const int16x8_t add = vdupq_n_s16(addval);
+      const auto convert = [&](const s16* chroma) {
+        const int16x4_t C = vld1_s16(chroma);
+        const int16x8_t value = vaddq_s16(Y, vcombine_s16(vzip1_s16(C, C), vzip2_s16(C, C)));
+        return vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(value, min), max), add));
+      };
+      const uint16x8_t r = convert(&Rblk[chroma_index]);
+      const uint16x8_t g = convert(&Gblk[chroma_index]);
+      const uint16x8_t b = convert(&Bblk[chroma_index]);
+
+      // Components are ORed in as zero-extended 16-bit values, same as the scalar conversion.
+      const uint32x4_t rgb_lo =
+        vorrq_u32(vorrq_u32(vmovl_u16(vget_low_u16(r)), vshlq_n_u32(vmovl_u16(vget_low_u16(g)), 8)),
+                  vshlq_n_u32(vmovl_u16(vget_low_u16(b)), 16));
+      const uint32x4_t rgb_hi = vorrq_u32(vorrq_u32(vmovl_high_u16(r), vshlq_n_u32(vmovl_high_u16(g), 8)),
+                                          vshlq_n_u32(vmovl_high_u16(b), 16));
+      vst1q_u32(out, rgb_lo);
+      vst1q_u32(out + 4, rgb_hi);
+#else
+      for (u32 x = 0; x < 8; x++)
+      {
+        const s16 Y = Yrow[x];
+        const u32 ci = chroma_index + (x / 2);
+        const s16 R = static_cast<s16>(std::clamp(static_cast<int>(Y) + Rblk[ci], -128, 127)) + addval;
+        const s16 G = static_cast<s16>(std::clamp(static_cast<int>(Y) + Gblk[ci], -128, 127)) + addval;
+        const s16 B = static_cast<s16>(std::clamp(static_cast<int>(Y) + Bblk[ci], -128, 127)) + addval;
+        out[x] = ZeroExtend32(static_cast<u16>(R)) | (ZeroExtend32(static_cast<u16>(G)) << 8) |
+                 (ZeroExtend32(static_cast<u16>(B)) << 16);
+      }
+#endif
     }
   }
 }
@@ -863,6 +1037,76 @@ void MDEC::y_to_mono(const std::array<s16, 64>& Yblk)
   }
 }
 
+void MDEC::rgb_to_rgb15(u32* out)
+{
+  // Two pixels per output word. E8TO5: min((c + 4) >> 3, 0x1F).
+  const u32 a = ZeroExtend32(s_status.data_output_bit15.GetValue()) << 15;
+
+#if defined(CPU_X64)
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  const __m128i round = _mm_set1_epi32(4);
+  const __m128i max = _mm_set1_epi32(0x1F);
+  const __m128i alpha = _mm_set1_epi32(static_cast<s32>(a));
+  const auto convert = [&](__m128i color) {
+    // Components are at most 0x20, so 16-bit min is fine.
+    const __m128i r = _mm_min_epi16(_mm_srli_epi32(_mm_add_epi32(_mm_and_si128(color, mask), round), 3), max);
+    const __m128i g =
+      _mm_min_epi16(_mm_srli_epi32(_mm_add_epi32(_mm_and_si128(_mm_srli_epi32(color, 8), mask), round), 3), max);
+    const __m128i b =
+      _mm_min_epi16(_mm_srli_epi32(_mm_add_epi32(_mm_and_si128(_mm_srli_epi32(color, 16), mask), round), 3), max);
+    const __m128i color15 =
+      _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 5)), _mm_or_si128(_mm_slli_epi32(b, 10), alpha));
+
+    // Sign extend so the saturating pack passes the 16-bit values through unchanged.
+    return _mm_srai_epi32(_mm_slli_epi32(color15, 16), 16);
+  };
+
+  for (u32 i = 0; i < static_cast<u32>(s_block_rgb.size()); i += 8)
+  {
+    const __m128i lo = convert(_mm_load_si128(reinterpret_cast<const __m128i*>(&s_block_rgb[i])));
+    const __m128i hi = convert(_mm_load_si128(reinterpret_cast<const __m128i*>(&s_block_rgb[i + 4])));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i / 2]), _mm_packs_epi32(lo, hi));
+  }
+#elif defined(CPU_AARCH64)
+  const uint32x4_t mask = vdupq_n_u32(0xFF);
+  const uint32x4_t round = vdupq_n_u32(4);
+  const uint32x4_t max = vdupq_n_u32(0x1F);
+  const uint32x4_t alpha = vdupq_n_u32(a);
+  const auto convert = [&](uint32x4_t color) {
+    const uint32x4_t r = vminq_u32(vshrq_n_u32(vaddq_u32(vandq_u32(color, mask), round), 3), max);
+    const uint32x4_t g = vminq_u32(vshrq_n_u32(vaddq_u32(vandq_u32(vshrq_n_u32(color, 8), mask), round), 3), max);
+    const uint32x4_t b = vminq_u32(vshrq_n_u32(vaddq_u32(vandq_u32(vshrq_n_u32(color, 16), mask), round), 3), max);
+    return vmovn_u32(vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 5)), vorrq_u32(vshlq_n_u32(b, 10), alpha)));
+  };
+
+  for (u32 i = 0; i < static_cast<u32>(s_block_rgb.size()); i += 8)
+  {
+    const uint16x8_t color15 =
+      vcombine_u16(convert(vld1q_u32(&s_block_rgb[i])), convert(vld1q_u32(&s_block_rgb[i + 4])));
+    vst1q_u32(&out[i / 2], vreinterpretq_u32_u16(color15));
+  }
+#else
+  for (u32 i = 0; i < static_cast<u32>(s_block_rgb.size()); i += 2)
+  {
+#define E8TO5(color) (std::min<u32>((((color) + 4) >> 3), 0x1F))
+    u32 color = s_block_rgb[i];
+    u32 r = E8TO5(color & 0xFFu);
+    u32 g = E8TO5((color >> 8) & 0xFFu);
+    u32 b = E8TO5((color >> 16) & 0xFFu);
+    const u32 color15a = r | (g << 5) | (b << 10) | a;
+
+    color = s_block_rgb[i + 1];
+    r = E8TO5(color & 0xFFu);
+    g = E8TO5((color >> 8) & 0xFFu);
+    b = E8TO5((color >> 16) & 0xFFu);
+    const u32 color15b = r | (g << 5) | (b << 10) | a;
+#undef E8TO5
+
+    out[i / 2] = color15a | (color15b << 16);
+  }
+#endif
+}
+
 void MDEC::HandleSetQuantTableCommand()
 {
   DebugAssert(s_remaining_halfwords >= 32);
@@ -891,6 +1135,7 @@ void MDEC::HandleSetScaleCommand()
   s_data_in_fifo.PopRange(packed_data.data(), static_cast<u32>(packed_data.size()));
   s_remaining_halfwords -= 32;
   std::memcpy(s_scale_table.data(), packed_data.data(), s_scale_table.size() * sizeof(s16));
+  UpdateIDCTTable();
 }
 
 void MDEC::DrawDebugStateWindow()
@@ -23,6 +23,7 @@
 #include "common/log.h"
 #include "cpu_core.h"
 #include "settings.h"
+#include <array>
 #include <climits>
 #include <cmath>
 Log_SetChannel(PGXP);
@@ -34,9 +35,14 @@ enum : u32
   VERTEX_CACHE_WIDTH = 0x800 * 2,
   VERTEX_CACHE_HEIGHT = 0x800 * 2,
   VERTEX_CACHE_SIZE = VERTEX_CACHE_WIDTH * VERTEX_CACHE_HEIGHT,
-  PGXP_MEM_SIZE = (Bus::RAM_8MB_SIZE + CPU::DCACHE_SIZE) / 4,
-  PGXP_MEM_SCRATCH_OFFSET = Bus::RAM_8MB_SIZE / 4
+  MEM_PAGE_SHIFT = 12,
+  MEM_PAGE_SIZE = 1u << MEM_PAGE_SHIFT,
+  MEM_PAGE_WORDS = MEM_PAGE_SIZE / 4,
+  MEM_RAM_PAGE_COUNT = Bus::RAM_8MB_SIZE / MEM_PAGE_SIZE,
+  MEM_SCRATCH_PAGE = MEM_RAM_PAGE_COUNT,
+  MEM_PAGE_COUNT = MEM_RAM_PAGE_COUNT + 1,
 };
+static_assert(static_cast<u32>(CPU::DCACHE_SIZE) <= static_cast<u32>(MEM_PAGE_SIZE));
 
 #define NONE 0
 #define ALL 0xFFFFFFFF
@@ -64,6 +70,22 @@ typedef struct PGXP_value_Tag
   unsigned int value;
 } PGXP_value;
 
+// Memory is shadowed in guest pages which are only allocated once something other than an invalid value is stored
+// to them. The component flags are only ever VALID or zero, so they're packed down to a nibble per word.
+struct PGXP_mem_value
+{
+  float x;
+  float y;
+  float z;
+  u32 value;
+};
+
+struct PGXP_mem_page
+{
+  PGXP_mem_value values[MEM_PAGE_WORDS];
+  u8 flags[MEM_PAGE_WORDS];
+};
+
 typedef union
 {
   struct
@@ -96,8 +118,10 @@ static double f16Sign(double in);
 static double f16Unsign(double in);
 static double f16Overflow(double in);
 
-static PGXP_value* GetPtr(u32 addr);
-static PGXP_value* ReadMem(u32 addr);
+static bool GetMemPage(u32 addr, bool allocate, PGXP_mem_page** page, u32* index);
+static void LoadMem(const PGXP_mem_page* page, u32 index, PGXP_value* dest);
+static void StoreMem(PGXP_mem_page* page, u32 index, const PGXP_value& value);
+static bool ReadMem(u32 addr, PGXP_value* dest);
 
 static const PGXP_value PGXP_value_invalid = {0.f, 0.f, 0.f, {0}, 0};
 static const PGXP_value PGXP_value_zero = {0.f, 0.f, 0.f, {VALID_ALL}, 0};
@@ -111,7 +135,7 @@ static PGXP_value CP0_reg[32];
 static PGXP_value GTE_data_reg[32];
 static PGXP_value GTE_ctrl_reg[32];
 
-static PGXP_value* Mem = nullptr;
+static std::array<PGXP_mem_page*, MEM_PAGE_COUNT> s_mem_pages = {};
 static PGXP_value* vertexCache = nullptr;
 
 ALWAYS_INLINE_RELEASE void MakeValid(PGXP_value* pV, u32 psxV)
@@ -155,30 +179,110 @@ ALWAYS_INLINE_RELEASE double f16Overflow(double in)
   return out;
 }
 
-ALWAYS_INLINE_RELEASE PGXP_value* GetPtr(u32 addr)
+ALWAYS_INLINE static u8 PackFlags(u32 flags)
 {
-  if ((addr & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION)
-    return &Mem[PGXP_MEM_SCRATCH_OFFSET + ((addr & CPU::DCACHE_OFFSET_MASK) >> 2)];
+  return static_cast<u8>((flags & VALID_0) | ((flags & VALID_1) >> 7) | ((flags & VALID_2) >> 14) |
+                         ((flags & VALID_3) >> 21));
+}
 
-  const u32 paddr = (addr & CPU::PHYSICAL_MEMORY_ADDRESS_MASK);
-  if (paddr < Bus::RAM_MIRROR_END)
-    return &Mem[(paddr & Bus::g_ram_mask) >> 2];
-  else
+ALWAYS_INLINE static u32 UnpackFlags(u8 packed)
+{
+  return (packed & 1u) | ((packed & 2u) << 7) | ((packed & 4u) << 14) | ((packed & 8u) << 21);
+}
+
+ALWAYS_INLINE static bool IsInvalidValue(const PGXP_value& value)
+{
+  // Bitwise, so that negative zero still gets stored.
+  return (std::memcmp(&value, &PGXP_value_invalid, sizeof(PGXP_value)) == 0);
+}
+
+static PGXP_mem_page* AllocateMemPage(u32 page_index)
+{
+  PGXP_mem_page* page = static_cast<PGXP_mem_page*>(std::calloc(1, sizeof(PGXP_mem_page)));
+  if (!page)
+  {
+    // Stores to this page will be dropped, which only costs precision.
+    Log_ErrorPrintf("Failed to allocate PGXP memory page %u", page_index);
     return nullptr;
+  }
+
+  s_mem_pages[page_index] = page;
+  return page;
+}
+
+ALWAYS_INLINE_RELEASE bool GetMemPage(u32 addr, bool allocate, PGXP_mem_page** page, u32* index)
+{
+  u32 page_index;
+  if ((addr & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION)
+  {
+    page_index = MEM_SCRATCH_PAGE;
+    *index = (addr & CPU::DCACHE_OFFSET_MASK) >> 2;
+  }
+  else
+  {
+    const u32 paddr = (addr & CPU::PHYSICAL_MEMORY_ADDRESS_MASK);
+    if (paddr >= Bus::RAM_MIRROR_END)
+      return false;
+
+    const u32 ram_offset = (paddr & Bus::g_ram_mask);
+    page_index = ram_offset >> MEM_PAGE_SHIFT;
+    *index = (ram_offset & (MEM_PAGE_SIZE - 1)) >> 2;
+  }
+
+  *page = s_mem_pages[page_index];
+  if (!*page && allocate)
+    *page = AllocateMemPage(page_index);
+
+  return true;
+}
+
+ALWAYS_INLINE_RELEASE void LoadMem(const PGXP_mem_page* page, u32 index, PGXP_value* dest)
+{
+  // Pages which haven't been allocated read as invalid.
+  if (!page)
+  {
+    *dest = PGXP_value_invalid;
+    return;
+  }
+
+  const PGXP_mem_value& mv = page->values[index];
+  dest->x = mv.x;
+  dest->y = mv.y;
+  dest->z = mv.z;
+  dest->flags = UnpackFlags(page->flags[index]);
+  dest->value = mv.value;
 }
 
-ALWAYS_INLINE_RELEASE PGXP_value* ReadMem(u32 addr)
+ALWAYS_INLINE_RELEASE void StoreMem(PGXP_mem_page* page, u32 index, const PGXP_value& value)
 {
-  return GetPtr(addr);
+  PGXP_mem_value& mv = page->values[index];
+  mv.x = value.x;
+  mv.y = value.y;
+  mv.z = value.z;
+  mv.value = value.value;
+  page->flags[index] = PackFlags(value.flags);
+}
+
+ALWAYS_INLINE_RELEASE bool ReadMem(u32 addr, PGXP_value* dest)
+{
+  PGXP_mem_page* page;
+  u32 index;
+  if (!GetMemPage(addr, false, &page, &index))
+    return false;
+
+  LoadMem(page, index, dest);
+  return true;
 }
 
 ALWAYS_INLINE_RELEASE void ValidateAndCopyMem(PGXP_value* dest, u32 addr, u32 value)
 {
-  PGXP_value* pMem = GetPtr(addr);
-  if (pMem != NULL)
+  PGXP_mem_page* page;
+  u32 index;
+  if (GetMemPage(addr, false, &page, &index) && page)
   {
-    Validate(pMem, value);
-    *dest = *pMem;
+    LoadMem(page, index, dest);
+    Validate(dest, value);
+    page->flags[index] = PackFlags(dest->flags);
     return;
   }
 
@@ -189,8 +293,9 @@ ALWAYS_INLINE_RELEASE static void ValidateAndCopyMem16(PGXP_value* dest, u32 add
 {
   u32 validMask = 0;
   psx_value val, mask;
-  PGXP_value* pMem = GetPtr(addr);
-  if (pMem != NULL)
+  PGXP_mem_page* page;
+  u32 index;
+  if (GetMemPage(addr, false, &page, &index))
   {
     mask.d = val.d = 0;
     // determine if high or low word
@@ -208,8 +313,12 @@ ALWAYS_INLINE_RELEASE static void ValidateAndCopyMem16(PGXP_value* dest, u32 add
     }
 
     // validate and copy whole value
-    MaskValidate(pMem, val.d, mask.d, validMask);
-    *dest = *pMem;
+    LoadMem(page, index, dest);
+    if (page)
+    {
+      MaskValidate(dest, val.d, mask.d, validMask);
+      page->flags[index] = PackFlags(dest->flags);
+    }
 
     // if high word then shift
     if ((addr % 4) == 2)
@@ -230,42 +339,67 @@ ALWAYS_INLINE_RELEASE static void ValidateAndCopyMem16(PGXP_value* dest, u32 add
 
 ALWAYS_INLINE_RELEASE void WriteMem(const PGXP_value* value, u32 addr)
 {
-  PGXP_value* pMem = GetPtr(addr);
-
-  if (pMem)
-    *pMem = *value;
+  PGXP_mem_page* page;
+  u32 index;
+  if (GetMemPage(addr, !IsInvalidValue(*value), &page, &index) && page)
+    StoreMem(page, index, *value);
 }
 
 ALWAYS_INLINE_RELEASE static void WriteMem16(const PGXP_value* src, u32 addr)
 {
-  PGXP_value* dest = GetPtr(addr);
-  psx_value* pVal = NULL;
+  PGXP_mem_page* page;
+  u32 index;
+  if (!GetMemPage(addr, !IsInvalidValue(*src), &page, &index) || !page)
+    return;
+
+  PGXP_value dest_value;
+  PGXP_value* dest = &dest_value;
+  LoadMem(page, index, dest);
 
-  if (dest)
+  psx_value* pVal = (psx_value*)&dest->value;
+  // determine if high or low word
+  if ((addr % 4) == 2)
   {
-    pVal = (psx_value*)&dest->value;
-    // determine if high or low word
-    if ((addr % 4) == 2)
-    {
-      dest->y = src->x;
-      dest->compFlags[1] = src->compFlags[0];
-      pVal->w.h = (u16)src->value;
-    }
-    else
-    {
-      dest->x = src->x;
-      dest->compFlags[0] = src->compFlags[0];
-      pVal->w.l = (u16)src->value;
-    }
+    dest->y = src->x;
+    dest->compFlags[1] = src->compFlags[0];
+    pVal->w.h = (u16)src->value;
+  }
+  else
+  {
+    dest->x = src->x;
+    dest->compFlags[0] = src->compFlags[0];
+    pVal->w.l = (u16)src->value;
+  }
+
+  // overwrite z/w if valid
+  if (src->compFlags[2] == VALID)
+  {
+    dest->z = src->z;
+    dest->compFlags[2] = src->compFlags[2];
+  }
+
+  // dest->valid = dest->valid && src->valid;
+  StoreMem(page, index, *dest);
+}
+
+static void InvalidateMemPages()
+{
+  for (PGXP_mem_page* page : s_mem_pages)
+  {
+    if (page)
+      std::memset(page, 0, sizeof(PGXP_mem_page));
+  }
+}
 
-    // overwrite z/w if valid
-    if (src->compFlags[2] == VALID)
+static void FreeMemPages()
+{
+  for (PGXP_mem_page*& page : s_mem_pages)
+  {
+    if (page)
     {
-      dest->z = src->z;
-      dest->compFlags[2] = src->compFlags[2];
+      std::free(page);
+      page = nullptr;
     }
-
-    // dest->valid = dest->valid && src->valid;
   }
 }
 
@@ -277,15 +411,7 @@ void Initialize()
   std::memset(GTE_data_reg, 0, sizeof(GTE_data_reg));
   std::memset(GTE_ctrl_reg, 0, sizeof(GTE_ctrl_reg));
 
-  if (!Mem)
-  {
-    Mem = static_cast<PGXP_value*>(std::calloc(PGXP_MEM_SIZE, sizeof(PGXP_value)));
-    if (!Mem)
-    {
-      std::fprintf(stderr, "Failed to allocate PGXP memory\n");
-      std::abort();
-    }
-  }
+  InvalidateMemPages();
 
   if (g_settings.gpu_pgxp_vertex_cache && !vertexCache)
   {
@@ -309,8 +435,7 @@ void Reset()
   std::memset(GTE_data_reg, 0, sizeof(GTE_data_reg));
   std::memset(GTE_ctrl_reg, 0, sizeof(GTE_ctrl_reg));
 
-  if (Mem)
-    std::memset(Mem, 0, sizeof(PGXP_value) * PGXP_MEM_SIZE);
+  InvalidateMemPages();
 
   if (vertexCache)
     std::memset(vertexCache, 0, sizeof(PGXP_value) * VERTEX_CACHE_SIZE);
@@ -323,11 +448,7 @@ void Shutdown()
     std::free(vertexCache);
     vertexCache = nullptr;
   }
-  if (Mem)
-  {
-    std::free(Mem);
-    Mem = nullptr;
-  }
+  FreeMemPages();
 
   std::memset(GTE_data_reg, 0, sizeof(GTE_data_reg));
   std::memset(GTE_ctrl_reg, 0, sizeof(GTE_ctrl_reg));
@@ -524,7 +645,8 @@ static ALWAYS_INLINE_RELEASE bool IsWithinTolerance(float precise_x, float preci
 
 bool GetPreciseVertex(u32 addr, u32 value, int x, int y, int xOffs, int yOffs, float* out_x, float* out_y, float* out_w)
 {
-  const PGXP_value* vert = ReadMem(addr);
+  PGXP_value mem_value;
+  const PGXP_value* vert = ReadMem(addr, &mem_value) ? &mem_value : nullptr;
   if (vert && ((vert->flags & VALID_01) == VALID_01) && (vert->value == value))
   {
     // There is a value here with valid X and Y coordinates
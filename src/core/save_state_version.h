@@ -21,6 +21,7 @@ struct SAVE_STATE_HEADER
     COMPRESSION_TYPE_NONE = 0,
     COMPRESSION_TYPE_ZLIB = 1,
     COMPRESSION_TYPE_ZSTD = 2,
+    COMPRESSION_TYPE_SECTIONED_ZSTD = 3,
   };
 
   u32 magic;
@@ -43,4 +44,28 @@ struct SAVE_STATE_HEADER
   u32 data_uncompressed_size;
   u32 offset_to_data;
 };
+
+/// Data for COMPRESSION_TYPE_SECTIONED_ZSTD starts with this table. Each section is a consecutive range of the
+/// uncompressed state, compressed on its own, so sections can be decompressed in any order or in parallel.
+struct SAVE_STATE_SECTION_TABLE
+{
+  u32 num_sections;
+  u32 reserved;
+};
+
+struct SAVE_STATE_SECTION
+{
+  enum : u32
+  {
+    MAX_NAME_LENGTH = 32,
+  };
+
+  char name[MAX_NAME_LENGTH];
+  u32 offset_to_data;
+  u32 compressed_size;
+  u32 uncompressed_size;
+  u32 reserved;
+  u64 hash_low; // XXH3-128 of the uncompressed data.
+  u64 hash_high;
+};
 #pragma pack(pop)
@@ -181,7 +181,10 @@ void Settings::Load(SettingsInterface& si)
   rewind_enable = si.GetBoolValue("Main", "RewindEnable", false);
   rewind_save_frequency = si.GetFloatValue("Main", "RewindFrequency", 10.0f);
   rewind_save_slots = static_cast<u32>(si.GetIntValue("Main", "RewindSaveSlots", 10));
+  rewind_memory_budget = static_cast<u32>(si.GetIntValue("Main", "RewindMemoryBudget", 256));
   runahead_frames = static_cast<u32>(si.GetIntValue("Main", "RunaheadFrameCount", 0));
+  runahead_preemptive = si.GetBoolValue("Main", "RunaheadPreemptive", false);
+  adaptive_frame_budget = si.GetBoolValue("Main", "AdaptiveFrameBudget", DEFAULT_ADAPTIVE_FRAME_BUDGET);
 
   cpu_execution_mode =
     ParseCPUExecutionMode(
@@ -193,6 +196,7 @@ void Settings::Load(SettingsInterface& si)
   UpdateOverclockActive();
   cpu_recompiler_memory_exceptions = si.GetBoolValue("CPU", "RecompilerMemoryExceptions", false);
   cpu_recompiler_block_linking = si.GetBoolValue("CPU", "RecompilerBlockLinking", true);
+  cpu_recompiler_async_compilation = si.GetBoolValue("CPU", "RecompilerAsyncCompilation", false);
   cpu_recompiler_icache = si.GetBoolValue("CPU", "RecompilerICache", false);
   cpu_fastmem_mode = ParseCPUFastmemMode(
                        si.GetStringValue("CPU", "FastmemMode", GetCPUFastmemModeName(DEFAULT_CPU_FASTMEM_MODE)).c_str())
@@ -278,6 +282,9 @@ void Settings::Load(SettingsInterface& si)
 
   cdrom_readahead_sectors =
     static_cast<u8>(si.GetIntValue("CDROM", "ReadaheadSectors", DEFAULT_CDROM_READAHEAD_SECTORS));
+  cdrom_chd_hunk_cache_mb = static_cast<u16>(
+    std::clamp<int>(si.GetIntValue("CDROM", "CHDHunkCacheSize", DEFAULT_CDROM_CHD_HUNK_CACHE_MB), 0,
+                    MAX_CDROM_CHD_HUNK_CACHE_MB));
   cdrom_region_check = si.GetBoolValue("CDROM", "RegionCheck", false);
   cdrom_load_image_to_ram = si.GetBoolValue("CDROM", "LoadImageToRAM", false);
   cdrom_load_image_patches = si.GetBoolValue("CDROM", "LoadImagePatches", false);
@@ -423,7 +430,10 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Main", "RewindEnable", rewind_enable);
   si.SetFloatValue("Main", "RewindFrequency", rewind_save_frequency);
   si.SetIntValue("Main", "RewindSaveSlots", rewind_save_slots);
+  si.SetIntValue("Main", "RewindMemoryBudget", rewind_memory_budget);
   si.SetIntValue("Main", "RunaheadFrameCount", runahead_frames);
+  si.SetBoolValue("Main", "RunaheadPreemptive", runahead_preemptive);
+  si.SetBoolValue("Main", "AdaptiveFrameBudget", adaptive_frame_budget);
 
   si.SetStringValue("CPU", "ExecutionMode", GetCPUExecutionModeName(cpu_execution_mode));
   si.SetBoolValue("CPU", "OverclockEnable", cpu_overclock_enable);
@@ -431,6 +441,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetIntValue("CPU", "OverclockDenominator", cpu_overclock_denominator);
   si.SetBoolValue("CPU", "RecompilerMemoryExceptions", cpu_recompiler_memory_exceptions);
   si.SetBoolValue("CPU", "RecompilerBlockLinking", cpu_recompiler_block_linking);
+  si.SetBoolValue("CPU", "RecompilerAsyncCompilation", cpu_recompiler_async_compilation);
   si.SetBoolValue("CPU", "RecompilerICache", cpu_recompiler_icache);
   si.SetStringValue("CPU", "FastmemMode", GetCPUFastmemModeName(cpu_fastmem_mode));
 
@@ -498,6 +509,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetFloatValue("Display", "OSDScale", display_osd_scale);
 
   si.SetIntValue("CDROM", "ReadaheadSectors", cdrom_readahead_sectors);
+  si.SetIntValue("CDROM", "CHDHunkCacheSize", cdrom_chd_hunk_cache_mb);
   si.SetBoolValue("CDROM", "RegionCheck", cdrom_region_check);
   si.SetBoolValue("CDROM", "LoadImageToRAM", cdrom_load_image_to_ram);
   si.SetBoolValue("CDROM", "LoadImagePatches", cdrom_load_image_patches);
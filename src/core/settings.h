@@ -8,6 +8,7 @@
 #include "types.h"
 #include "util/audio_stream.h"
 #include <array>
+#include <limits>
 #include <optional>
 #include <string>
 #include <vector>
@@ -63,6 +64,7 @@ struct Settings
   bool cpu_overclock_active = false;
   bool cpu_recompiler_memory_exceptions = false;
   bool cpu_recompiler_block_linking = true;
+  bool cpu_recompiler_async_compilation = false;
   bool cpu_recompiler_icache = false;
   CPUFastmemMode cpu_fastmem_mode = DEFAULT_CPU_FASTMEM_MODE;
 
@@ -89,7 +91,10 @@ struct Settings
   bool rewind_enable = false;
   float rewind_save_frequency = 10.0f;
   u32 rewind_save_slots = 10;
+  u32 rewind_memory_budget = 256; // in MB, for the compressed states
   u32 runahead_frames = 0;
+  bool runahead_preemptive = false;
+  bool adaptive_frame_budget = DEFAULT_ADAPTIVE_FRAME_BUDGET;
 
   GPURenderer gpu_renderer = DEFAULT_GPU_RENDERER;
   std::string gpu_adapter;
@@ -151,6 +156,7 @@ struct Settings
   float gpu_pgxp_depth_clear_threshold = DEFAULT_GPU_PGXP_DEPTH_THRESHOLD / GPU_PGXP_DEPTH_THRESHOLD_SCALE;
 
   u8 cdrom_readahead_sectors = DEFAULT_CDROM_READAHEAD_SECTORS;
+  u16 cdrom_chd_hunk_cache_mb = DEFAULT_CDROM_CHD_HUNK_CACHE_MB;
   bool cdrom_region_check = false;
   bool cdrom_load_image_to_ram = false;
   bool cdrom_load_image_patches = false;
@@ -299,6 +305,12 @@ struct Settings
     return (port == 0) ? IsPort1MultitapEnabled() : IsPort2MultitapEnabled();
   }
 
+  ALWAYS_INLINE u32 GetCDROMCHDHunkCacheSizeInBytes() const
+  {
+    static_assert((static_cast<u64>(MAX_CDROM_CHD_HUNK_CACHE_MB) * 1048576) <= std::numeric_limits<u32>::max());
+    return static_cast<u32>(static_cast<u64>(cdrom_chd_hunk_cache_mb) * 1048576);
+  }
+
   ALWAYS_INLINE static bool IsPerGameMemoryCardType(MemoryCardType type)
   {
     return (type == MemoryCardType::PerGame || type == MemoryCardType::PerGameTitle ||
@@ -440,7 +452,11 @@ struct Settings
   static constexpr DisplayAlignment DEFAULT_DISPLAY_ALIGNMENT = DisplayAlignment::Center;
   static constexpr float DEFAULT_OSD_SCALE = 100.0f;
 
+  static constexpr bool DEFAULT_ADAPTIVE_FRAME_BUDGET = false;
+
   static constexpr u8 DEFAULT_CDROM_READAHEAD_SECTORS = 8;
+  static constexpr u16 DEFAULT_CDROM_CHD_HUNK_CACHE_MB = 16;
+  static constexpr u16 MAX_CDROM_CHD_HUNK_CACHE_MB = 256;
 
 #ifndef __ANDROID__
   // Android still defaults to digital controller for now.
@@ -16,6 +16,16 @@
 #include "util/state_wrapper.h"
 #include "util/wav_writer.h"
 #include <memory>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 Log_SetChannel(SPU);
 
 // Enable to dump all voices of the SPU audio individually.
@@ -256,7 +266,6 @@ struct Voice
   void ForceOff();
 
   void DecodeBlock(const ADPCMBlock& block);
-  s32 Interpolate() const;
 
   // Switches to the specified phase, filling in target.
   void UpdateADSREnvelope();
@@ -265,6 +274,24 @@ struct Voice
   void TickADSR();
 };
 
+// Mixer inputs and outputs for the current frame, stored as structure-of-arrays so that several voices can be mixed
+// at once. Interpolation taps are interleaved in pairs per voice, to suit 16-bit multiply-add instructions.
+struct VoiceMixLanes
+{
+  alignas(16) std::array<s16, NUM_VOICES * 2> interp_weights_01;
+  alignas(16) std::array<s16, NUM_VOICES * 2> interp_samples_01;
+  alignas(16) std::array<s16, NUM_VOICES * 2> interp_weights_23;
+  alignas(16) std::array<s16, NUM_VOICES * 2> interp_samples_23;
+  alignas(16) std::array<s32, NUM_VOICES> adsr_volume;
+  alignas(16) std::array<s32, NUM_VOICES> left_volume;
+  alignas(16) std::array<s32, NUM_VOICES> right_volume;
+  alignas(16) std::array<s32, NUM_VOICES> reverb_mask;
+
+  alignas(16) std::array<s32, NUM_VOICES> volume_out;
+  alignas(16) std::array<s32, NUM_VOICES> left_out;
+  alignas(16) std::array<s32, NUM_VOICES> right_out;
+};
+
 struct ReverbRegisters
 {
   s16 vLOUT;
@@ -321,16 +348,22 @@ static void WriteToCaptureBuffer(u32 index, s16 value);
 static void IncrementCaptureBufferPosition();
 
 static void ReadADPCMBlock(u16 address, ADPCMBlock* block);
-static std::tuple<s32, s32> SampleVoice(u32 voice_index);
+static bool PrepareVoice(u32 voice_index);
+template<bool output_audio>
+static void MixVoices(s32* left_sum, s32* right_sum, s32* reverb_in_left, s32* reverb_in_right);
+static void AdvanceVoice(u32 voice_index);
 
 static void UpdateNoise();
 
 static u32 ReverbMemoryAddress(u32 address);
 static s16 ReverbRead(u32 address, s32 offset = 0);
 static void ReverbWrite(u32 address, s16 data);
+template<bool output_audio>
 static void ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out);
 
 static void Execute(void* param, TickCount ticks, TickCount ticks_late);
+template<bool output_audio>
+static void GenerateFrame(s16* output_frame, bool first_frame);
 static void UpdateEventInterval();
 
 static void ExecuteFIFOWriteToRAM(TickCount& ticks);
@@ -346,7 +379,6 @@ static std::unique_ptr<TimingEvent> s_tick_event;
 static std::unique_ptr<TimingEvent> s_transfer_event;
 static std::unique_ptr<Common::WAVWriter> s_dump_writer;
 static std::unique_ptr<AudioStream> s_audio_stream;
-static std::unique_ptr<AudioStream> s_null_audio_stream;
 static bool s_audio_output_muted = false;
 
 static TickCount s_ticks_carry = 0;
@@ -392,6 +424,7 @@ static std::array<std::array<s16, 64>, 2> s_reverb_upsample_buffer;
 static s32 s_reverb_resample_buffer_position = 0;
 
 static std::array<Voice, NUM_VOICES> s_voices{};
+static VoiceMixLanes s_voice_mix_lanes{};
 
 static InlineFIFOQueue<u16, FIFO_SIZE_IN_HALFWORDS> s_transfer_fifo;
 
@@ -412,7 +445,6 @@ void SPU::Initialize()
                                                  &SPU::Execute, nullptr, false);
   s_transfer_event = TimingEvents::CreateTimingEvent(
     "SPU Transfer", TRANSFER_TICKS_PER_HALFWORD, TRANSFER_TICKS_PER_HALFWORD, &SPU::ExecuteTransfer, nullptr, false);
-  s_null_audio_stream = AudioStream::CreateNullStream(SAMPLE_RATE, NUM_CHANNELS, g_settings.audio_buffer_ms);
 
   CreateOutputStream();
   Reset();
@@ -1806,84 +1838,73 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   current_block_flags.bits = block.flags.bits;
 }
 
-s32 SPU::Voice::Interpolate() const
-{
-  static constexpr std::array<s16, 0x200> gauss = {{
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
-    0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
-    0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
-    0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
-    0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
-    0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
-    0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
-    0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
-    0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
-    0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
-    0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
-    0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
-    0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
-    0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
-    0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
-    0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
-    0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
-    0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
-    0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
-    0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
-    0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
-    0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
-    0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
-    0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
-    0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
-    0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
-    0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
-    0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
-    0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
-    0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
-    0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
-    0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
-    0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
-    0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
-    0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
-    0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
-    0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
-    0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
-    0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
-    0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
-    0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
-    0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
-    0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
-    0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
-    0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
-    0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
-    0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
-    0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
-    0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
-    0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
-    0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
-    0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
-    0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
-    0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
-    0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
-    0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
-    0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
-    0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
-    0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
-    0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
-    0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
-    0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
-  }};
-
-  const u8 i = counter.interpolation_index;
-  const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(counter.sample_index.GetValue());
-
-  s32 out = s32(gauss[0x0FF - i]) * s32(current_block_samples[s - 3]);
-  out += s32(gauss[0x1FF - i]) * s32(current_block_samples[s - 2]);
-  out += s32(gauss[0x100 + i]) * s32(current_block_samples[s - 1]);
-  out += s32(gauss[0x000 + i]) * s32(current_block_samples[s - 0]);
-  return out >> 15;
-}
+// Gaussian interpolation weights, indexed by the voice counter's interpolation index.
+static constexpr std::array<s16, 0x200> s_gauss_table = {{
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
+  0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
+  0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
+  0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
+  0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
+  0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
+  0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
+  0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
+  0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
+  0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
+  0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
+  0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
+  0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
+  0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
+  0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
+  0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
+  0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
+  0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
+  0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
+  0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
+  0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
+  0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
+  0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
+  0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
+  0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
+  0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
+  0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
+  0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
+  0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
+  0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
+  0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
+  0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
+  0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
+  0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
+  0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
+  0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
+  0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
+  0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
+  0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
+  0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
+  0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
+  0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
+  0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
+  0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
+  0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
+  0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
+  0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
+  0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
+  0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
+  0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
+  0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
+  0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
+  0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
+  0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
+  0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
+  0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
+  0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
+  0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
+  0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
+  0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
+  0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
+  0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
+}};
 
 void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
 {
@@ -1912,22 +1933,15 @@ void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
   }
 }
 
-ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
+ALWAYS_INLINE_RELEASE bool SPU::PrepareVoice(u32 voice_index)
 {
   Voice& voice = s_voices[voice_index];
+  VoiceMixLanes& lanes = s_voice_mix_lanes;
+  lanes.reverb_mask[voice_index] = -static_cast<s32>((s_reverb_on_register >> voice_index) & 1u);
   if (!voice.IsOn() && !s_SPUCNT.irq9_enable)
   {
-    voice.last_volume = 0;
-
-#ifdef SPU_DUMP_ALL_VOICES
-    if (s_voice_dump_writers[voice_index])
-    {
-      const s16 dump_samples[2] = {0, 0};
-      s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
-    }
-#endif
-
-    return {};
+    lanes.adsr_volume[voice_index] = 0;
+    return false;
   }
 
   if (!voice.has_samples)
@@ -1944,26 +1958,203 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
     }
   }
 
+  lanes.adsr_volume[voice_index] = voice.regs.adsr_volume;
+  lanes.left_volume[voice_index] = voice.left_volume.current_level;
+  lanes.right_volume[voice_index] = voice.right_volume.current_level;
+
   // skip interpolation when the volume is muted anyway
-  s32 volume;
-  if (voice.regs.adsr_volume != 0)
+  if (voice.regs.adsr_volume == 0)
+    return true;
+
+  s16* weights_01 = &lanes.interp_weights_01[voice_index * 2];
+  s16* samples_01 = &lanes.interp_samples_01[voice_index * 2];
+  s16* weights_23 = &lanes.interp_weights_23[voice_index * 2];
+  s16* samples_23 = &lanes.interp_samples_23[voice_index * 2];
+  if (IsVoiceNoiseEnabled(voice_index))
   {
-    // interpolate/sample and apply ADSR volume
-    s32 sample;
-    if (IsVoiceNoiseEnabled(voice_index))
-      sample = GetVoiceNoiseLevel();
-    else
-      sample = voice.Interpolate();
-
-    volume = ApplyVolume(sample, voice.regs.adsr_volume);
+    // 0x4000 + 0x4000 sums to 1.0 after the shift, passing the noise level through unchanged.
+    const s16 noise_level = GetVoiceNoiseLevel();
+    weights_01[0] = 0x4000;
+    weights_01[1] = 0x4000;
+    weights_23[0] = 0;
+    weights_23[1] = 0;
+    samples_01[0] = noise_level;
+    samples_01[1] = noise_level;
+    samples_23[0] = 0;
+    samples_23[1] = 0;
   }
   else
   {
-    volume = 0;
+    const u8 i = voice.counter.interpolation_index;
+    const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(voice.counter.sample_index.GetValue());
+    weights_01[0] = s_gauss_table[0x0FF - i];
+    weights_01[1] = s_gauss_table[0x1FF - i];
+    weights_23[0] = s_gauss_table[0x100 + i];
+    weights_23[1] = s_gauss_table[0x000 + i];
+    samples_01[0] = voice.current_block_samples[s - 3];
+    samples_01[1] = voice.current_block_samples[s - 2];
+    samples_23[0] = voice.current_block_samples[s - 1];
+    samples_23[1] = voice.current_block_samples[s - 0];
   }
 
-  voice.last_volume = volume;
+  return true;
+}
+
+#if defined(CPU_X64)
 
+ALWAYS_INLINE static __m128i MultiplyLow32(__m128i a, __m128i b)
+{
+  // SSE2 has no 32-bit multiply-low, so multiply the even and odd lanes separately and interleave the results.
+  const __m128i even = _mm_mul_epu32(a, b);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+ALWAYS_INLINE static s32 HorizontalSum32(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+#endif
+
+template<bool output_audio>
+void SPU::MixVoices(s32* left_sum, s32* right_sum, s32* reverb_in_left, s32* reverb_in_right)
+{
+  // Same arithmetic as ApplyVolume(), four voices at a time. Inactive and muted voices have an ADSR volume of zero,
+  // so whatever is left in their interpolation lanes drops out. The 32-bit products can't overflow, so the sums are
+  // identical to mixing each voice in turn. Without audio output, only the per-voice volumes and reverb input are
+  // needed, since both end up in the save state.
+  VoiceMixLanes& lanes = s_voice_mix_lanes;
+  static_assert(NUM_VOICES % 4 == 0);
+
+#if defined(CPU_X64)
+  __m128i left_acc = _mm_setzero_si128();
+  __m128i right_acc = _mm_setzero_si128();
+  __m128i reverb_left_acc = _mm_setzero_si128();
+  __m128i reverb_right_acc = _mm_setzero_si128();
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const __m128i weights_01 = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.interp_weights_01[i * 2]));
+    const __m128i samples_01 = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.interp_samples_01[i * 2]));
+    const __m128i weights_23 = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.interp_weights_23[i * 2]));
+    const __m128i samples_23 = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.interp_samples_23[i * 2]));
+    const __m128i sample = _mm_srai_epi32(
+      _mm_add_epi32(_mm_madd_epi16(weights_01, samples_01), _mm_madd_epi16(weights_23, samples_23)), 15);
+
+    const __m128i adsr_volume = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.adsr_volume[i]));
+    const __m128i volume = _mm_srai_epi32(MultiplyLow32(sample, adsr_volume), 15);
+    _mm_store_si128(reinterpret_cast<__m128i*>(&lanes.volume_out[i]), volume);
+
+    const __m128i left_volume = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.left_volume[i]));
+    const __m128i right_volume = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.right_volume[i]));
+    const __m128i left = _mm_srai_epi32(MultiplyLow32(volume, left_volume), 15);
+    const __m128i right = _mm_srai_epi32(MultiplyLow32(volume, right_volume), 15);
+    if constexpr (output_audio)
+    {
+      _mm_store_si128(reinterpret_cast<__m128i*>(&lanes.left_out[i]), left);
+      _mm_store_si128(reinterpret_cast<__m128i*>(&lanes.right_out[i]), right);
+      left_acc = _mm_add_epi32(left_acc, left);
+      right_acc = _mm_add_epi32(right_acc, right);
+    }
+
+    const __m128i reverb_mask = _mm_load_si128(reinterpret_cast<const __m128i*>(&lanes.reverb_mask[i]));
+    reverb_left_acc = _mm_add_epi32(reverb_left_acc, _mm_and_si128(left, reverb_mask));
+    reverb_right_acc = _mm_add_epi32(reverb_right_acc, _mm_and_si128(right, reverb_mask));
+  }
+
+  if constexpr (output_audio)
+  {
+    *left_sum = HorizontalSum32(left_acc);
+    *right_sum = HorizontalSum32(right_acc);
+  }
+  *reverb_in_left = HorizontalSum32(reverb_left_acc);
+  *reverb_in_right = HorizontalSum32(reverb_right_acc);
+#elif defined(CPU_AARCH64)
+  int32x4_t left_acc = vdupq_n_s32(0);
+  int32x4_t right_acc = vdupq_n_s32(0);
+  int32x4_t reverb_left_acc = vdupq_n_s32(0);
+  int32x4_t reverb_right_acc = vdupq_n_s32(0);
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const int16x8_t weights_01 = vld1q_s16(&lanes.interp_weights_01[i * 2]);
+    const int16x8_t samples_01 = vld1q_s16(&lanes.interp_samples_01[i * 2]);
+    const int16x8_t weights_23 = vld1q_s16(&lanes.interp_weights_23[i * 2]);
+    const int16x8_t samples_23 = vld1q_s16(&lanes.interp_samples_23[i * 2]);
+    const int32x4_t products_01 = vpaddq_s32(vmull_s16(vget_low_s16(weights_01), vget_low_s16(samples_01)),
+                                             vmull_high_s16(weights_01, samples_01));
+    const int32x4_t products_23 = vpaddq_s32(vmull_s16(vget_low_s16(weights_23), vget_low_s16(samples_23)),
+                                             vmull_high_s16(weights_23, samples_23));
+    const int32x4_t sample = vshrq_n_s32(vaddq_s32(products_01, products_23), 15);
+
+    const int32x4_t volume = vshrq_n_s32(vmulq_s32(sample, vld1q_s32(&lanes.adsr_volume[i])), 15);
+    vst1q_s32(&lanes.volume_out[i], volume);
+
+    const int32x4_t left = vshrq_n_s32(vmulq_s32(volume, vld1q_s32(&lanes.left_volume[i])), 15);
+    const int32x4_t right = vshrq_n_s32(vmulq_s32(volume, vld1q_s32(&lanes.right_volume[i])), 15);
+    if constexpr (output_audio)
+    {
+      vst1q_s32(&lanes.left_out[i], left);
+      vst1q_s32(&lanes.right_out[i], right);
+      left_acc = vaddq_s32(left_acc, left);
+      right_acc = vaddq_s32(right_acc, right);
+    }
+
+    const int32x4_t reverb_mask = vld1q_s32(&lanes.reverb_mask[i]);
+    reverb_left_acc = vaddq_s32(reverb_left_acc, vandq_s32(left, reverb_mask));
+    reverb_right_acc = vaddq_s32(reverb_right_acc, vandq_s32(right, reverb_mask));
+  }
+
+  if constexpr (output_audio)
+  {
+    *left_sum = vaddvq_s32(left_acc);
+    *right_sum = vaddvq_s32(right_acc);
+  }
+  *reverb_in_left = vaddvq_s32(reverb_left_acc);
+  *reverb_in_right = vaddvq_s32(reverb_right_acc);
+#else
+  s32 left_acc = 0;
+  s32 right_acc = 0;
+  s32 reverb_left_acc = 0;
+  s32 reverb_right_acc = 0;
+  for (u32 i = 0; i < NUM_VOICES; i++)
+  {
+    const s32 sample = (s32(lanes.interp_weights_01[i * 2 + 0]) * s32(lanes.interp_samples_01[i * 2 + 0]) +
+                        s32(lanes.interp_weights_01[i * 2 + 1]) * s32(lanes.interp_samples_01[i * 2 + 1]) +
+                        s32(lanes.interp_weights_23[i * 2 + 0]) * s32(lanes.interp_samples_23[i * 2 + 0]) +
+                        s32(lanes.interp_weights_23[i * 2 + 1]) * s32(lanes.interp_samples_23[i * 2 + 1])) >>
+                       15;
+    const s32 volume = (sample * lanes.adsr_volume[i]) >> 15;
+    const s32 left = (volume * lanes.left_volume[i]) >> 15;
+    const s32 right = (volume * lanes.right_volume[i]) >> 15;
+    lanes.volume_out[i] = volume;
+    if constexpr (output_audio)
+    {
+      lanes.left_out[i] = left;
+      lanes.right_out[i] = right;
+      left_acc += left;
+      right_acc += right;
+    }
+
+    reverb_left_acc += left & lanes.reverb_mask[i];
+    reverb_right_acc += right & lanes.reverb_mask[i];
+  }
+
+  if constexpr (output_audio)
+  {
+    *left_sum = left_acc;
+    *right_sum = right_acc;
+  }
+  *reverb_in_left = reverb_left_acc;
+  *reverb_in_right = reverb_right_acc;
+#endif
+}
+
+ALWAYS_INLINE_RELEASE void SPU::AdvanceVoice(u32 voice_index)
+{
+  Voice& voice = s_voices[voice_index];
   if (voice.adsr_phase != ADSRPhase::Off)
     voice.TickADSR();
 
@@ -2008,21 +2199,9 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
     }
   }
 
-  // apply per-channel volume
-  const s32 left = ApplyVolume(volume, voice.left_volume.current_level);
-  const s32 right = ApplyVolume(volume, voice.right_volume.current_level);
+  // per-channel volume was applied by the mixer, with the levels from before this tick
   voice.left_volume.Tick();
   voice.right_volume.Tick();
-
-#ifdef SPU_DUMP_ALL_VOICES
-  if (s_voice_dump_writers[voice_index])
-  {
-    const s16 dump_samples[2] = {static_cast<s16>(Clamp16(left)), static_cast<s16>(Clamp16(right))};
-    s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
-  }
-#endif
-
-  return std::make_tuple(left, right);
 }
 
 void SPU::UpdateNoise()
@@ -2149,6 +2328,7 @@ ALWAYS_INLINE static s32 IIASM(const s16 IIR_ALPHA, const s16 insamp)
     return insamp * (32768 - IIR_ALPHA);
 }
 
+template<bool output_audio>
 void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out)
 {
   s_last_reverb_input[0] = left_in;
@@ -2161,9 +2341,13 @@ void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out
   s32 out[2];
   if (s_reverb_resample_buffer_position & 1u)
   {
+    // The downsampled input only feeds the IIR stage, which is skipped when reverb writes are disabled.
     std::array<s32, 2> downsampled;
-    for (unsigned lr = 0; lr < 2; lr++)
-      downsampled[lr] = Reverb4422(&s_reverb_downsample_buffer[lr][(s_reverb_resample_buffer_position - 38) & 0x3F]);
+    if (s_SPUCNT.reverb_master_enable)
+    {
+      for (unsigned lr = 0; lr < 2; lr++)
+        downsampled[lr] = Reverb4422(&s_reverb_downsample_buffer[lr][(s_reverb_resample_buffer_position - 38) & 0x3F]);
+    }
 
     for (unsigned lr = 0; lr < 2; lr++)
     {
@@ -2217,11 +2401,14 @@ void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out
     if (s_reverb_current_address == 0)
       s_reverb_current_address = s_reverb_base_address;
 
-    for (unsigned lr = 0; lr < 2; lr++)
-      out[lr] =
-        Reverb2244<false>(&s_reverb_upsample_buffer[lr][((s_reverb_resample_buffer_position >> 1) - 19) & 0x1F]);
+    if constexpr (output_audio)
+    {
+      for (unsigned lr = 0; lr < 2; lr++)
+        out[lr] =
+          Reverb2244<false>(&s_reverb_upsample_buffer[lr][((s_reverb_resample_buffer_position >> 1) - 19) & 0x1F]);
+    }
   }
-  else
+  else if constexpr (output_audio)
   {
     for (unsigned lr = 0; lr < 2; lr++)
       out[lr] = Reverb2244<true>(&s_reverb_upsample_buffer[lr][((s_reverb_resample_buffer_position >> 1) - 19) & 0x1F]);
@@ -2229,17 +2416,126 @@ void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out
 
   s_reverb_resample_buffer_position = (s_reverb_resample_buffer_position + 1) & 0x3F;
 
-  s_last_reverb_output[0] = *left_out = ApplyVolume(out[0], s_reverb_registers.vLOUT);
-  s_last_reverb_output[1] = *right_out = ApplyVolume(out[1], s_reverb_registers.vROUT);
+  // The upsampled output is only heard, it never feeds back into reverb RAM.
+  if constexpr (output_audio)
+  {
+    s_last_reverb_output[0] = *left_out = ApplyVolume(out[0], s_reverb_registers.vLOUT);
+    s_last_reverb_output[1] = *right_out = ApplyVolume(out[1], s_reverb_registers.vROUT);
 
 #ifdef SPU_DUMP_ALL_VOICES
-  if (s_voice_dump_writers[NUM_VOICES])
-  {
-    const s16 dump_samples[2] = {static_cast<s16>(Clamp16(s_last_reverb_output[0])),
-                                 static_cast<s16>(Clamp16(s_last_reverb_output[1]))};
-    s_voice_dump_writers[NUM_VOICES]->WriteFrames(dump_samples, 1);
+    if (s_voice_dump_writers[NUM_VOICES])
+    {
+      const s16 dump_samples[2] = {static_cast<s16>(Clamp16(s_last_reverb_output[0])),
+                                   static_cast<s16>(Clamp16(s_last_reverb_output[1]))};
+      s_voice_dump_writers[NUM_VOICES]->WriteFrames(dump_samples, 1);
+    }
+#endif
   }
+}
+
+template<bool output_audio>
+ALWAYS_INLINE_RELEASE void SPU::GenerateFrame(s16* output_frame, bool first_frame)
+{
+  // Decode and gather interpolation inputs, mix all voices at once, then step each voice in order. Pitch
+  // modulation uses the previous voice's volume from this frame, which the mixer has already computed.
+  u32 active_voices = 0;
+  for (u32 voice = 0; voice < NUM_VOICES; voice++)
+    active_voices |= BoolToUInt32(PrepareVoice(voice)) << voice;
+
+  s32 left_sum = 0, right_sum = 0, reverb_in_left, reverb_in_right;
+  MixVoices<output_audio>(&left_sum, &right_sum, &reverb_in_left, &reverb_in_right);
+
+  for (u32 voice = 0; voice < NUM_VOICES; voice++)
+  {
+    s_voices[voice].last_volume = s_voice_mix_lanes.volume_out[voice];
+    if (active_voices & (1u << voice))
+      AdvanceVoice(voice);
+
+#ifdef SPU_DUMP_ALL_VOICES
+    if (output_audio && s_voice_dump_writers[voice])
+    {
+      const s16 dump_samples[2] = {static_cast<s16>(Clamp16(s_voice_mix_lanes.left_out[voice])),
+                                   static_cast<s16>(Clamp16(s_voice_mix_lanes.right_out[voice]))};
+      s_voice_dump_writers[voice]->WriteFrames(dump_samples, 1);
+    }
 #endif
+  }
+
+  if (!s_SPUCNT.mute_n)
+  {
+    left_sum = 0;
+    right_sum = 0;
+  }
+
+  // Update noise once per frame.
+  UpdateNoise();
+
+  // Mix in CD audio.
+  const auto [cd_audio_left, cd_audio_right] = CDROM::GetAudioFrame();
+  if (s_SPUCNT.cd_audio_enable)
+  {
+    const s32 cd_audio_volume_left = ApplyVolume(s32(cd_audio_left), s_cd_audio_volume_left);
+    const s32 cd_audio_volume_right = ApplyVolume(s32(cd_audio_right), s_cd_audio_volume_right);
+
+    left_sum += cd_audio_volume_left;
+    right_sum += cd_audio_volume_right;
+
+    if (s_SPUCNT.cd_audio_reverb)
+    {
+      reverb_in_left += cd_audio_volume_left;
+      reverb_in_right += cd_audio_volume_right;
+    }
+  }
+
+  // Compute reverb.
+  s32 reverb_out_left = 0, reverb_out_right = 0;
+  ProcessReverb<output_audio>(static_cast<s16>(Clamp16(reverb_in_left)), static_cast<s16>(Clamp16(reverb_in_right)),
+                              &reverb_out_left, &reverb_out_right);
+
+  if constexpr (output_audio)
+  {
+    // Mix in reverb.
+    left_sum += reverb_out_left;
+    right_sum += reverb_out_right;
+
+    // Apply main volume after clamping. A maximum volume should not overflow here because both are 16-bit values.
+    output_frame[0] = static_cast<s16>(ApplyVolume(Clamp16(left_sum), s_main_volume_left.current_level));
+    output_frame[1] = static_cast<s16>(ApplyVolume(Clamp16(right_sum), s_main_volume_right.current_level));
+  }
+
+  s_main_volume_left.Tick();
+  s_main_volume_right.Tick();
+
+  // Write to capture buffers.
+  WriteToCaptureBuffer(0, cd_audio_left);
+  WriteToCaptureBuffer(1, cd_audio_right);
+  WriteToCaptureBuffer(2, static_cast<s16>(Clamp16(s_voices[1].last_volume)));
+  WriteToCaptureBuffer(3, static_cast<s16>(Clamp16(s_voices[3].last_volume)));
+  IncrementCaptureBufferPosition();
+
+  // Key off/on voices after the first frame.
+  if (first_frame && (s_key_off_register != 0 || s_key_on_register != 0))
+  {
+    u32 key_off_register = s_key_off_register;
+    s_key_off_register = 0;
+
+    u32 key_on_register = s_key_on_register;
+    s_key_on_register = 0;
+
+    for (u32 voice = 0; voice < NUM_VOICES; voice++)
+    {
+      if (key_off_register & 1u)
+        s_voices[voice].KeyOff();
+      key_off_register >>= 1;
+
+      if (key_on_register & 1u)
+      {
+        s_endx_register &= ~(1u << voice);
+        s_voices[voice].KeyOn();
+      }
+      key_on_register >>= 1;
+    }
+  }
 }
 
 void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
@@ -2258,116 +2554,33 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
     s_ticks_carry = (ticks + s_ticks_carry) % SYSCLK_TICKS_PER_SPU_TICK;
   }
 
-  AudioStream* output_stream = s_audio_output_muted ? s_null_audio_stream.get() : s_audio_stream.get();
+  if (s_audio_output_muted)
+  {
+    // Resimulating for rollback or runahead, nobody will hear these frames. Only advance the state the game can see.
+    for (u32 i = 0; i < remaining_frames; i++)
+      GenerateFrame<false>(nullptr, i == 0);
+
+    return;
+  }
 
   while (remaining_frames > 0)
   {
     s16* output_frame_start;
     u32 output_frame_space = remaining_frames;
-    output_stream->BeginWrite(&output_frame_start, &output_frame_space);
+    s_audio_stream->BeginWrite(&output_frame_start, &output_frame_space);
 
     s16* output_frame = output_frame_start;
     const u32 frames_in_this_batch = std::min(remaining_frames, output_frame_space);
     for (u32 i = 0; i < frames_in_this_batch; i++)
     {
-      s32 left_sum = 0;
-      s32 right_sum = 0;
-      s32 reverb_in_left = 0;
-      s32 reverb_in_right = 0;
-
-      u32 reverb_on_register = s_reverb_on_register;
-
-      for (u32 voice = 0; voice < NUM_VOICES; voice++)
-      {
-        const auto [left, right] = SampleVoice(voice);
-        left_sum += left;
-        right_sum += right;
-
-        if (reverb_on_register & 1u)
-        {
-          reverb_in_left += left;
-          reverb_in_right += right;
-        }
-        reverb_on_register >>= 1;
-      }
-
-      if (!s_SPUCNT.mute_n)
-      {
-        left_sum = 0;
-        right_sum = 0;
-      }
-
-      // Update noise once per frame.
-      UpdateNoise();
-
-      // Mix in CD audio.
-      const auto [cd_audio_left, cd_audio_right] = CDROM::GetAudioFrame();
-      if (s_SPUCNT.cd_audio_enable)
-      {
-        const s32 cd_audio_volume_left = ApplyVolume(s32(cd_audio_left), s_cd_audio_volume_left);
-        const s32 cd_audio_volume_right = ApplyVolume(s32(cd_audio_right), s_cd_audio_volume_right);
-
-        left_sum += cd_audio_volume_left;
-        right_sum += cd_audio_volume_right;
-
-        if (s_SPUCNT.cd_audio_reverb)
-        {
-          reverb_in_left += cd_audio_volume_left;
-          reverb_in_right += cd_audio_volume_right;
-        }
-      }
-
-      // Compute reverb.
-      s32 reverb_out_left, reverb_out_right;
-      ProcessReverb(static_cast<s16>(Clamp16(reverb_in_left)), static_cast<s16>(Clamp16(reverb_in_right)),
-                    &reverb_out_left, &reverb_out_right);
-
-      // Mix in reverb.
-      left_sum += reverb_out_left;
-      right_sum += reverb_out_right;
-
-      // Apply main volume after clamping. A maximum volume should not overflow here because both are 16-bit values.
-      *(output_frame++) = static_cast<s16>(ApplyVolume(Clamp16(left_sum), s_main_volume_left.current_level));
-      *(output_frame++) = static_cast<s16>(ApplyVolume(Clamp16(right_sum), s_main_volume_right.current_level));
-      s_main_volume_left.Tick();
-      s_main_volume_right.Tick();
-
-      // Write to capture buffers.
-      WriteToCaptureBuffer(0, cd_audio_left);
-      WriteToCaptureBuffer(1, cd_audio_right);
-      WriteToCaptureBuffer(2, static_cast<s16>(Clamp16(s_voices[1].last_volume)));
-      WriteToCaptureBuffer(3, static_cast<s16>(Clamp16(s_voices[3].last_volume)));
-      IncrementCaptureBufferPosition();
-
-      // Key off/on voices after the first frame.
-      if (i == 0 && (s_key_off_register != 0 || s_key_on_register != 0))
-      {
-        u32 key_off_register = s_key_off_register;
-        s_key_off_register = 0;
-
-        u32 key_on_register = s_key_on_register;
-        s_key_on_register = 0;
-
-        for (u32 voice = 0; voice < NUM_VOICES; voice++)
-        {
-          if (key_off_register & 1u)
-            s_voices[voice].KeyOff();
-          key_off_register >>= 1;
-
-          if (key_on_register & 1u)
-          {
-            s_endx_register &= ~(1u << voice);
-            s_voices[voice].KeyOn();
-          }
-          key_on_register >>= 1;
-        }
-      }
+      GenerateFrame<true>(output_frame, i == 0);
+      output_frame += NUM_CHANNELS;
     }
 
     if (s_dump_writer)
       s_dump_writer->WriteFrames(output_frame_start, frames_in_this_batch);
 
-    output_stream->EndWrite(frames_in_this_batch);
+    s_audio_stream->EndWrite(frames_in_this_batch);
     remaining_frames -= frames_in_this_batch;
   }
 }
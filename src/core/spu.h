@@ -49,7 +49,8 @@ bool StopDumpingAudio();
 const std::array<u8, RAM_SIZE>& GetRAM();
 std::array<u8, RAM_SIZE>& GetWritableRAM();
 
-/// Change output stream - used for runahead.
+/// Mutes output while resimulating frames for runahead or rollback. While muted, only the state visible to the game
+/// is advanced: the final mix, output resampling of reverb and the audio stream are skipped.
 // TODO: Make it use system "running ahead" flag
 bool IsAudioOutputMuted();
 void SetAudioOutputMuted(bool muted);
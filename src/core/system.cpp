@@ -8,6 +8,7 @@
 #include "bus.h"
 #include "cdrom.h"
 #include "cheats.h"
+#include "common/compressed_state_buffer.h"
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
@@ -48,14 +49,18 @@
 #include "util/iso_reader.h"
 #include "util/state_wrapper.h"
 #include "xxhash.h"
+#include <atomic>
 #include <cctype>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <deque>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <thread>
+#include <utility>
 Log_SetChannel(System);
 
 #ifdef _WIN32
@@ -65,6 +70,32 @@ Log_SetChannel(System);
 
 // #define PROFILE_MEMORY_SAVE_STATES 1
 
+MemorySaveState::MemorySaveState() = default;
+
+MemorySaveState::MemorySaveState(MemorySaveState&& other)
+  : vram_texture(std::move(other.vram_texture)), state_stream(std::move(other.state_stream)),
+    vram_copy_fence(std::exchange(other.vram_copy_fence, 0))
+{
+}
+
+MemorySaveState::~MemorySaveState()
+{
+  // the renderer could still be writing to the stream
+  if (vram_copy_fence != 0 && g_gpu)
+    g_gpu->WaitForVRAMCopies(vram_copy_fence);
+}
+
+MemorySaveState& MemorySaveState::operator=(MemorySaveState&& other)
+{
+  if (vram_copy_fence != 0 && g_gpu)
+    g_gpu->WaitForVRAMCopies(vram_copy_fence);
+
+  vram_texture = std::move(other.vram_texture);
+  state_stream = std::move(other.state_stream);
+  vram_copy_fence = std::exchange(other.vram_copy_fence, 0);
+  return *this;
+}
+
 SystemBootParameters::SystemBootParameters() = default;
 
 SystemBootParameters::SystemBootParameters(const SystemBootParameters&) = default;
@@ -75,18 +106,58 @@ SystemBootParameters::SystemBootParameters(std::string filename_) : filename(std
 
 SystemBootParameters::~SystemBootParameters() = default;
 
-struct MemorySaveState
+namespace System {
+/// State captured on the CPU thread, which can be compressed and written out on any thread.
+struct SaveStateBuffer
 {
-  std::unique_ptr<GPUTexture> vram_texture;
+  std::string title;
+  std::string serial;
+  std::string media_filename;
+  u32 media_subimage_index = 0;
+
+  std::vector<u32> screenshot_data;
+  u32 screenshot_width = 0;
+  u32 screenshot_height = 0;
+  u32 screenshot_stride = 0;
+  GPUTexture::Format screenshot_format = GPUTexture::Format::Unknown;
+  bool screenshot_flip = false;
+
   std::unique_ptr<GrowableMemoryByteStream> state_stream;
+  std::vector<StateMarkerPosition> markers;
+};
+
+/// Range of the uncompressed state which is stored as one section.
+struct SaveStateSectionRange
+{
+  const char* name;
+  u32 start;
+  u32 size;
+};
+
+struct SaveStateWrite
+{
+  std::string filename;
+  std::unique_ptr<SaveStateBuffer> buffer;
+  u32 compression_method;
+  bool backup_existing_save;
 };
 
-namespace System {
 static std::optional<ExtendedSaveStateInfo> InternalGetExtendedSaveStateInfo(ByteStream* stream);
 static bool InternalSaveState(ByteStream* state, u32 screenshot_size = 256,
                               u32 compression_method = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
-static bool SaveMemoryState(MemorySaveState* mss);
-static bool LoadMemoryState(const MemorySaveState& mss);
+static bool SaveStateToBuffer(SaveStateBuffer* buffer, u32 screenshot_size);
+static bool SaveStateBufferToStream(ByteStream* state, SaveStateBuffer& buffer, u32 compression_method);
+static std::vector<SaveStateSectionRange> GetSaveStateSectionRanges(const SaveStateBuffer& buffer);
+static bool WriteSaveStateSections(ByteStream* state, const SaveStateBuffer& buffer);
+static bool ReadSaveStateSections(ByteStream* state, const SAVE_STATE_HEADER& header, std::vector<u8>* data);
+template<typename T>
+static void ForEachSaveStateSection(u32 count, const T& func);
+static void QueueSaveStateWrite(SaveStateWrite write);
+static void WaitForSaveStateWrites();
+static void SaveStateWriterThreadEntryPoint();
+static void WriteSaveStateFile(SaveStateWrite& write);
+static bool LoadMemoryState(u8* data, u32 size, GPUTexture* vram_texture,
+                            std::vector<StateMarkerPosition>* markers = nullptr);
 
 static bool LoadEXE(const char* filename);
 
@@ -113,10 +184,15 @@ static bool SaveRewindState();
 static void DoRewind();
 
 static void SaveRunaheadState();
+static bool UpdateRunaheadInputState();
 static void DoRunahead();
 
 static void DoMemorySaveStates();
 
+static void UpdateFrameBudget();
+static void SetRunaheadFrames(u32 frames);
+static void SetRewindSaveFrequencyScale(u32 scale);
+
 static bool Initialize(bool force_software_renderer);
 
 static bool UpdateGameSettingsLayer();
@@ -197,7 +273,12 @@ static std::unique_ptr<ByteStream> m_undo_load_state;
 
 static bool s_memory_saves_enabled = false;
 
-static std::deque<MemorySaveState> s_rewind_states;
+// Rewind states are delta compressed in the background, only the VRAM textures are kept as-is.
+static constexpr u32 REWIND_KEYFRAME_INTERVAL = 30;
+static CompressedStateBuffer s_rewind_states;
+static std::deque<std::unique_ptr<GPUTexture>> s_rewind_vram_textures;
+static MemorySaveState s_rewind_save_state;
+static std::vector<u8> s_rewind_load_buffer;
 static s32 s_rewind_load_frequency = -1;
 static s32 s_rewind_load_counter = -1;
 static s32 s_rewind_save_frequency = -1;
@@ -207,9 +288,51 @@ static bool s_rewinding_first_save = false;
 static std::deque<MemorySaveState> s_runahead_states;
 static bool s_runahead_replay_pending = false;
 static u32 s_runahead_frames = 0;
+static u32 s_runahead_stale_states = 0;
+static std::array<u64, NUM_CONTROLLER_AND_CARD_PORTS> s_runahead_input_state = {};
+
+// Runahead depth and rewind frequency are lowered when the emulation takes too much of the frame period, and raised
+// again once the measured frame and save costs say the next step up fits comfortably.
+static constexpr float FRAME_BUDGET_OVERRUN_THRESHOLD = 0.9f;
+static constexpr float FRAME_BUDGET_HEADROOM_THRESHOLD = 0.7f;
+static constexpr u32 FRAME_BUDGET_MAX_OVERRUN_PERCENT = 5;
+static constexpr u32 FRAME_BUDGET_RAISE_COOLDOWN = 5;
+static constexpr u32 MAX_REWIND_SAVE_FREQUENCY_SCALE = 8;
+static Common::Timer::Value s_run_frame_time_accumulator = 0;
+static Common::Timer::Value s_memory_save_time_accumulator = 0;
+static Common::Timer::Value s_memory_load_time_accumulator = 0;
+static u32 s_run_frame_count = 0;
+static u32 s_memory_save_count = 0;
+static u32 s_memory_load_count = 0;
+static u32 s_frame_budget_frames = 0;
+static u32 s_frame_budget_overruns = 0;
+static u32 s_frame_budget_cooldown = 0;
+static float s_average_run_frame_time = 0.0f;
+static float s_average_memory_save_time = 0.0f;
+static float s_average_memory_load_time = 0.0f;
+static s32 s_rewind_base_save_frequency = -1;
+static u32 s_rewind_save_frequency_scale = 1;
 
 static std::deque<MemorySaveState> s_netplay_states;
 
+static std::thread s_save_state_writer_thread;
+static std::mutex s_save_state_writer_mutex;
+static std::condition_variable s_save_state_writer_cv;
+static std::condition_variable s_save_state_writer_done_cv;
+static std::deque<System::SaveStateWrite> s_save_state_writes;
+static bool s_save_state_writer_busy = false;
+static bool s_save_state_writer_shutdown = false;
+
+// Sections smaller than this are grouped with their neighbours, they're not worth compressing on their own.
+static constexpr u32 MIN_SAVE_STATE_SECTION_SIZE = 64 * 1024;
+static constexpr u32 MAX_SAVE_STATE_SECTIONS = 256;
+static constexpr u32 MAX_SAVE_STATE_SECTION_THREADS = 4;
+
+// Compressed sections from the last sectioned save. Anything which hasn't changed since, such as RAM between
+// auto-saves while paused, is copied from here instead of being compressed again.
+static std::mutex s_save_state_section_cache_mutex;
+static std::vector<std::pair<XXH128_hash_t, std::shared_ptr<const std::vector<u8>>>> s_save_state_section_cache;
+
 static TinyString GetTimestampStringForFileName()
 {
   return TinyString::FromFmt("{:%Y-%m-%d_%H-%M-%S}", fmt::localtime(std::time(nullptr)));
@@ -406,6 +529,26 @@ u32 System::GetFrameTimeHistoryPos()
 {
   return s_frame_time_history_pos;
 }
+float System::GetAverageRunFrameTime()
+{
+  return s_average_run_frame_time;
+}
+float System::GetAverageMemorySaveStateTime()
+{
+  return s_average_memory_save_time;
+}
+u32 System::GetRunaheadFrames()
+{
+  return s_runahead_frames;
+}
+s32 System::GetRewindSaveFrequency()
+{
+  return s_rewind_save_frequency;
+}
+bool System::IsFrameBudgetLimited()
+{
+  return (s_runahead_frames < g_settings.runahead_frames || s_rewind_save_frequency_scale > 1);
+}
 
 bool System::IsExeFileName(const std::string_view& path)
 {
@@ -1010,6 +1153,8 @@ bool System::LoadState(const char* filename)
 
   Common::Timer load_timer;
 
+  WaitForSaveStateWrites();
+
   std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
   if (!stream)
     return false;
@@ -1047,45 +1192,133 @@ bool System::LoadState(const char* filename)
 
 bool System::SaveState(const char* filename, bool backup_existing_save)
 {
-  if (backup_existing_save && FileSystem::FileExists(filename))
+  Common::Timer save_timer;
+
+  // Only the snapshot happens here. Compression and the file write happen on the writer thread, so the game doesn't
+  // stall while the file is written.
+  std::unique_ptr<SaveStateBuffer> buffer = std::make_unique<SaveStateBuffer>();
+  if (!SaveStateToBuffer(buffer.get(), 256))
+  {
+    Host::ReportFormattedErrorAsync(Host::TranslateString("OSDMessage", "Save State"),
+                                    Host::TranslateString("OSDMessage", "Saving state to '%s' failed."), filename);
+    return false;
+  }
+
+  Log_InfoPrintf("Saving state to '%s'...", filename);
+  Log_VerbosePrintf("Capturing state took %.2f msec", save_timer.GetTimeMilliseconds());
+
+  const u32 compression_method = g_settings.compress_save_states ?
+                                   static_cast<u32>(SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONED_ZSTD) :
+                                   static_cast<u32>(SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
+  QueueSaveStateWrite({filename, std::move(buffer), compression_method, backup_existing_save});
+  return true;
+}
+
+bool System::SaveStateToStream(ByteStream* stream, u32 compression_method)
+{
+  return InternalSaveState(stream, 0, compression_method);
+}
+
+bool System::LoadStateFromStream(ByteStream* stream)
+{
+  return IsValid() && DoLoadState(stream, false, false);
+}
+
+void System::QueueSaveStateWrite(SaveStateWrite write)
+{
+  std::unique_lock lock(s_save_state_writer_mutex);
+  if (!s_save_state_writer_thread.joinable())
+  {
+    s_save_state_writer_shutdown = false;
+    s_save_state_writer_thread = std::thread(&System::SaveStateWriterThreadEntryPoint);
+  }
+
+  s_save_state_writes.push_back(std::move(write));
+  s_save_state_writer_cv.notify_one();
+}
+
+void System::WaitForSaveStateWrites()
+{
+  std::unique_lock lock(s_save_state_writer_mutex);
+  s_save_state_writer_done_cv.wait(lock, []() { return (s_save_state_writes.empty() && !s_save_state_writer_busy); });
+}
+
+void System::FlushSaveStates()
+{
+  {
+    std::unique_lock lock(s_save_state_writer_mutex);
+    if (!s_save_state_writer_thread.joinable())
+      return;
+
+    // the thread drains the queue before exiting
+    s_save_state_writer_shutdown = true;
+    s_save_state_writer_cv.notify_one();
+  }
+
+  s_save_state_writer_thread.join();
+}
+
+void System::SaveStateWriterThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Save State Writer");
+
+  std::unique_lock lock(s_save_state_writer_mutex);
+  for (;;)
+  {
+    s_save_state_writer_cv.wait(lock, []() { return (!s_save_state_writes.empty() || s_save_state_writer_shutdown); });
+    if (s_save_state_writes.empty())
+      break;
+
+    // writes are done in order, so the last save to a slot wins
+    SaveStateWrite write = std::move(s_save_state_writes.front());
+    s_save_state_writes.pop_front();
+    s_save_state_writer_busy = true;
+    lock.unlock();
+
+    WriteSaveStateFile(write);
+    write = {};
+
+    lock.lock();
+    s_save_state_writer_busy = false;
+    if (s_save_state_writes.empty())
+      s_save_state_writer_done_cv.notify_all();
+  }
+}
+
+void System::WriteSaveStateFile(SaveStateWrite& write)
+{
+  const char* filename = write.filename.c_str();
+  if (write.backup_existing_save && FileSystem::FileExists(filename))
   {
     const std::string backup_filename(Path::ReplaceExtension(filename, "bak"));
     if (!FileSystem::RenamePath(filename, backup_filename.c_str()))
       Log_ErrorPrintf("Failed to rename save state backup '%s'", backup_filename.c_str());
   }
 
-  Common::Timer save_timer;
+  Common::Timer write_timer;
 
   std::unique_ptr<ByteStream> stream =
     ByteStream::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
                                      BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
-    return false;
-
-  Log_InfoPrintf("Saving state to '%s'...", filename);
-
-  const u32 screenshot_size = 256;
-  const bool result = InternalSaveState(stream.get(), screenshot_size,
-                                        g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
-                                                                          SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
-  if (!result)
+  if (!stream || !SaveStateBufferToStream(stream.get(), *write.buffer, write.compression_method))
   {
     Host::ReportFormattedErrorAsync(Host::TranslateString("OSDMessage", "Save State"),
                                     Host::TranslateString("OSDMessage", "Saving state to '%s' failed."), filename);
-    stream->Discard();
-  }
-  else
-  {
-    const std::string display_name(FileSystem::GetDisplayNameFromPath(filename));
-    Host::AddIconOSDMessage("save_state", ICON_FA_SAVE,
-                            fmt::format(Host::TranslateString("OSDMessage", "State saved to '{}'.").GetCharArray(),
-                                        Path::GetFileName(display_name)),
-                            5.0f);
-    stream->Commit();
+    if (stream)
+      stream->Discard();
+
+    return;
   }
 
-  Log_VerbosePrintf("Saving state took %.2f msec", save_timer.GetTimeMilliseconds());
-  return result;
+  stream->Commit();
+
+  const std::string display_name(FileSystem::GetDisplayNameFromPath(filename));
+  Host::AddIconOSDMessage("save_state", ICON_FA_SAVE,
+                          fmt::format(Host::TranslateString("OSDMessage", "State saved to '{}'.").GetCharArray(),
+                                      Path::GetFileName(display_name)),
+                          5.0f);
+
+  Log_VerbosePrintf("Writing state took %.2f msec", write_timer.GetTimeMilliseconds());
 }
 
 bool System::SaveResumeState()
@@ -1308,6 +1541,8 @@ bool System::BootSystem(SystemBootParameters parameters)
   // try to load the state, if it fails, bail out
   if (!parameters.save_state.empty())
   {
+    WaitForSaveStateWrites();
+
     std::unique_ptr<ByteStream> stream =
       ByteStream::OpenFile(parameters.save_state.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
     if (!stream)
@@ -1883,6 +2118,8 @@ std::string System::GetMediaPathFromSaveState(const char* path)
 {
   std::string ret;
 
+  WaitForSaveStateWrites();
+
   std::unique_ptr<ByteStream> stream(ByteStream::OpenFile(path, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_SEEKABLE));
   if (stream)
   {
@@ -2044,6 +2281,19 @@ bool System::DoLoadState(ByteStream* state, bool force_software_renderer, bool u
     if (!DoState(sw, nullptr, update_display, false))
       return false;
   }
+  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONED_ZSTD)
+  {
+    std::vector<u8> data;
+    if (!ReadSaveStateSections(state, header, &data))
+    {
+      Host::ReportErrorAsync("Error", Host::TranslateStdString("System", "Save state data is corrupted."));
+      return false;
+    }
+
+    StateWrapper sw(data.data(), static_cast<u32>(data.size()), StateWrapper::Mode::Read, header.version);
+    if (!DoState(sw, nullptr, update_display, false))
+      return false;
+  }
   else
   {
     Host::ReportFormattedErrorAsync("Error", "Unknown save state compression type %u", header.data_compression_type);
@@ -2061,32 +2311,25 @@ bool System::DoLoadState(ByteStream* state, bool force_software_renderer, bool u
 bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 */,
                                u32 compression_method /* = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE*/)
 {
-  if (IsShutdown())
-    return false;
-
-  SAVE_STATE_HEADER header = {};
+  SaveStateBuffer buffer;
+  return SaveStateToBuffer(&buffer, screenshot_size) && SaveStateBufferToStream(state, buffer, compression_method);
+}
 
-  const u64 header_position = state->GetPosition();
-  if (!state->Write2(&header, sizeof(header)))
+bool System::SaveStateToBuffer(SaveStateBuffer* buffer, u32 screenshot_size)
+{
+  if (IsShutdown())
     return false;
 
-  // fill in header
-  header.magic = SAVE_STATE_MAGIC;
-  header.version = SAVE_STATE_VERSION;
-  StringUtil::Strlcpy(header.title, s_running_game_title.c_str(), sizeof(header.title));
-  StringUtil::Strlcpy(header.serial, s_running_game_serial.c_str(), sizeof(header.serial));
+  buffer->title = s_running_game_title;
+  buffer->serial = s_running_game_serial;
 
   if (CDROM::HasMedia())
   {
-    const std::string& media_filename = CDROM::GetMediaFileName();
-    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
-    header.media_filename_length = static_cast<u32>(media_filename.length());
-    header.media_subimage_index = CDROM::GetMedia()->HasSubImages() ? CDROM::GetMedia()->GetCurrentSubImage() : 0;
-    if (!media_filename.empty() && !state->Write2(media_filename.data(), header.media_filename_length))
-      return false;
+    buffer->media_filename = CDROM::GetMediaFileName();
+    buffer->media_subimage_index = CDROM::GetMedia()->HasSubImages() ? CDROM::GetMedia()->GetCurrentSubImage() : 0;
   }
 
-  // save screenshot
+  // save screenshot, it's converted to RGBA8 along with the compression
   if (screenshot_size > 0)
   {
     // assume this size is the width
@@ -2097,66 +2340,126 @@ bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 *
                                     ((display_aspect_ratio > 0.0f) ? display_aspect_ratio : 1.0f)));
     Log_VerbosePrintf("Saving %ux%u screenshot for state", screenshot_width, screenshot_height);
 
-    std::vector<u32> screenshot_buffer;
-    u32 screenshot_stride;
-    GPUTexture::Format screenshot_format;
-    if (g_host_display->RenderScreenshot(screenshot_width, screenshot_height, &screenshot_buffer, &screenshot_stride,
-                                         &screenshot_format) &&
-        GPUTexture::ConvertTextureDataToRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride,
-                                              screenshot_format))
+    if (g_host_display->RenderScreenshot(screenshot_width, screenshot_height, &buffer->screenshot_data,
+                                         &buffer->screenshot_stride, &buffer->screenshot_format))
     {
-      if (screenshot_stride != (screenshot_width * sizeof(u32)))
-      {
-        Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to incorrect stride(%u)",
-                          screenshot_width, screenshot_height, screenshot_stride);
-      }
-      else
-      {
-        if (g_host_display->UsesLowerLeftOrigin())
-        {
-          GPUTexture::FlipTextureDataRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride);
-        }
+      buffer->screenshot_width = screenshot_width;
+      buffer->screenshot_height = screenshot_height;
+      buffer->screenshot_flip = g_host_display->UsesLowerLeftOrigin();
+    }
+    else
+    {
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to render failure", screenshot_width,
+                        screenshot_height);
+    }
+  }
 
-        header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
-        header.screenshot_width = screenshot_width;
-        header.screenshot_height = screenshot_height;
-        header.screenshot_size = static_cast<u32>(screenshot_buffer.size() * sizeof(u32));
-        if (!state->Write2(screenshot_buffer.data(), header.screenshot_size))
-          return false;
-      }
+  // write data straight into memory, the file is written later
+  if (!buffer->state_stream)
+    buffer->state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+
+  GrowableMemoryByteStream* stream = buffer->state_stream.get();
+  StateWrapper sw(stream->GetMemoryPointer(), stream->GetMemorySize(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  buffer->markers.clear();
+  sw.SetMarkerPositions(&buffer->markers);
+
+  g_gpu->RestoreGraphicsAPIState();
+  const bool result = DoState(sw, nullptr, false, false);
+  g_gpu->ResetGraphicsAPIState();
+  if (!result)
+    return false;
+
+  // the buffer is handed to the writer thread, so any VRAM copy into it has to be finished
+  g_gpu->WaitForVRAMCopies(g_gpu->GetVRAMCopyFence());
+
+  const u32 state_size = static_cast<u32>(sw.GetPosition());
+  stream->Resize(state_size);
+  stream->SeekAbsolute(state_size);
+  return true;
+}
+
+bool System::SaveStateBufferToStream(ByteStream* state, SaveStateBuffer& buffer, u32 compression_method)
+{
+  SAVE_STATE_HEADER header = {};
+
+  const u64 header_position = state->GetPosition();
+  if (!state->Write2(&header, sizeof(header)))
+    return false;
+
+  // fill in header
+  header.magic = SAVE_STATE_MAGIC;
+  header.version = SAVE_STATE_VERSION;
+  StringUtil::Strlcpy(header.title, buffer.title.c_str(), sizeof(header.title));
+  StringUtil::Strlcpy(header.serial, buffer.serial.c_str(), sizeof(header.serial));
+
+  if (!buffer.media_filename.empty())
+  {
+    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
+    header.media_filename_length = static_cast<u32>(buffer.media_filename.length());
+    header.media_subimage_index = buffer.media_subimage_index;
+    if (!state->Write2(buffer.media_filename.data(), header.media_filename_length))
+      return false;
+  }
+
+  if (!buffer.screenshot_data.empty())
+  {
+    const u32 screenshot_width = buffer.screenshot_width;
+    const u32 screenshot_height = buffer.screenshot_height;
+    if (!GPUTexture::ConvertTextureDataToRGBA8(screenshot_width, screenshot_height, buffer.screenshot_data,
+                                               buffer.screenshot_stride, buffer.screenshot_format))
+    {
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to conversion failure", screenshot_width,
+                        screenshot_height);
+    }
+    else if (buffer.screenshot_stride != (screenshot_width * sizeof(u32)))
+    {
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to incorrect stride(%u)", screenshot_width,
+                        screenshot_height, buffer.screenshot_stride);
     }
     else
     {
-      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to render/conversion failure",
-                        screenshot_width, screenshot_height);
+      if (buffer.screenshot_flip)
+      {
+        GPUTexture::FlipTextureDataRGBA8(screenshot_width, screenshot_height, buffer.screenshot_data,
+                                         buffer.screenshot_stride);
+      }
+
+      header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
+      header.screenshot_width = screenshot_width;
+      header.screenshot_height = screenshot_height;
+      header.screenshot_size = static_cast<u32>(buffer.screenshot_data.size() * sizeof(u32));
+      if (!state->Write2(buffer.screenshot_data.data(), header.screenshot_size))
+        return false;
     }
   }
 
   // write data
   {
     header.offset_to_data = static_cast<u32>(state->GetPosition());
-
-    g_gpu->RestoreGraphicsAPIState();
-
     header.data_compression_type = compression_method;
 
+    const u8* data = buffer.state_stream->GetMemoryPointer();
+    const u32 data_size = static_cast<u32>(buffer.state_stream->GetSize());
+
     bool result = false;
     if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
     {
-      StateWrapper sw(state, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false);
-      header.data_uncompressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+      result = state->Write2(data, data_size);
+      header.data_uncompressed_size = data_size;
     }
     else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
     {
       std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(state, 0));
-      StateWrapper sw(cstream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false) && cstream->Commit();
-      header.data_uncompressed_size = static_cast<u32>(cstream->GetPosition());
+      result = cstream->Write2(data, data_size) && cstream->Commit();
+      header.data_uncompressed_size = data_size;
+      header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+    }
+    else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONED_ZSTD)
+    {
+      result = WriteSaveStateSections(state, buffer);
+      header.data_uncompressed_size = data_size;
       header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
     }
-
-    g_gpu->ResetGraphicsAPIState();
 
     if (!result)
       return false;
@@ -2173,6 +2476,216 @@ bool System::InternalSaveState(ByteStream* state, u32 screenshot_size /* = 256 *
   return true;
 }
 
+template<typename T>
+void System::ForEachSaveStateSection(u32 count, const T& func)
+{
+  const u32 num_threads =
+    std::min(std::min(count, std::max(std::thread::hardware_concurrency(), 1u)), MAX_SAVE_STATE_SECTION_THREADS);
+
+  std::atomic<u32> next_section{0};
+  const auto worker = [&next_section, count, &func]() {
+    for (u32 i = next_section.fetch_add(1); i < count; i = next_section.fetch_add(1))
+      func(i);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (u32 i = 1; i < num_threads; i++)
+    threads.emplace_back(worker);
+
+  worker();
+
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+std::vector<System::SaveStateSectionRange> System::GetSaveStateSectionRanges(const SaveStateBuffer& buffer)
+{
+  // Split at the markers. Big ranges such as RAM and VRAM get a section each, runs of small ones are grouped.
+  const u32 data_size = static_cast<u32>(buffer.state_stream->GetSize());
+  std::vector<SaveStateSectionRange> ranges;
+  bool last_range_is_group = false;
+  for (size_t i = 0; i < buffer.markers.size(); i++)
+  {
+    const u32 start = static_cast<u32>(buffer.markers[i].position);
+    const u32 end = (i + 1 < buffer.markers.size()) ? static_cast<u32>(buffer.markers[i + 1].position) : data_size;
+    const u32 size = end - start;
+    if (size < MIN_SAVE_STATE_SECTION_SIZE && last_range_is_group)
+    {
+      ranges.back().size += size;
+      continue;
+    }
+
+    ranges.push_back({buffer.markers[i].name, start, size});
+    last_range_is_group = (size < MIN_SAVE_STATE_SECTION_SIZE);
+  }
+
+  if (ranges.empty())
+  {
+    ranges.push_back({"State", 0, data_size});
+  }
+  else
+  {
+    // anything before the first marker goes in the first section
+    ranges.front().size += ranges.front().start;
+    ranges.front().start = 0;
+  }
+
+  return ranges;
+}
+
+bool System::WriteSaveStateSections(ByteStream* state, const SaveStateBuffer& buffer)
+{
+  const std::vector<SaveStateSectionRange> ranges = GetSaveStateSectionRanges(buffer);
+  const u32 num_sections = static_cast<u32>(ranges.size());
+  const u8* data = buffer.state_stream->GetMemoryPointer();
+
+  std::vector<XXH128_hash_t> hashes(num_sections);
+  std::vector<std::shared_ptr<const std::vector<u8>>> compressed(num_sections);
+  for (u32 i = 0; i < num_sections; i++)
+    hashes[i] = XXH3_128bits(data + ranges[i].start, ranges[i].size);
+
+  {
+    std::unique_lock lock(s_save_state_section_cache_mutex);
+    for (u32 i = 0; i < num_sections; i++)
+    {
+      for (const auto& [hash, cached] : s_save_state_section_cache)
+      {
+        if (XXH128_isEqual(hash, hashes[i]))
+        {
+          compressed[i] = cached;
+          break;
+        }
+      }
+    }
+  }
+
+  std::atomic_bool result{true};
+  ForEachSaveStateSection(num_sections, [&](u32 i) {
+    if (compressed[i])
+      return;
+
+    GrowableMemoryByteStream cdata(nullptr, ranges[i].size / 2);
+    std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(&cdata, 0));
+    if (!cstream->Write2(data + ranges[i].start, ranges[i].size) || !cstream->Commit())
+    {
+      result.store(false);
+      return;
+    }
+
+    const u8* cdata_ptr = cdata.GetMemoryPointer();
+    compressed[i] = std::make_shared<const std::vector<u8>>(cdata_ptr, cdata_ptr + cdata.GetSize());
+  });
+  if (!result.load())
+    return false;
+
+  {
+    std::unique_lock lock(s_save_state_section_cache_mutex);
+    s_save_state_section_cache.clear();
+    for (u32 i = 0; i < num_sections; i++)
+      s_save_state_section_cache.emplace_back(hashes[i], compressed[i]);
+  }
+
+  SAVE_STATE_SECTION_TABLE table = {};
+  table.num_sections = num_sections;
+
+  std::vector<SAVE_STATE_SECTION> sections(num_sections);
+  u32 offset = static_cast<u32>(state->GetPosition() + sizeof(table) + sizeof(SAVE_STATE_SECTION) * num_sections);
+  for (u32 i = 0; i < num_sections; i++)
+  {
+    SAVE_STATE_SECTION& section = sections[i];
+    std::memset(&section, 0, sizeof(section));
+    StringUtil::Strlcpy(section.name, ranges[i].name, sizeof(section.name));
+    section.offset_to_data = offset;
+    section.compressed_size = static_cast<u32>(compressed[i]->size());
+    section.uncompressed_size = ranges[i].size;
+    section.hash_low = hashes[i].low64;
+    section.hash_high = hashes[i].high64;
+    offset += section.compressed_size;
+  }
+
+  if (!state->Write2(&table, sizeof(table)) ||
+      !state->Write2(sections.data(), static_cast<u32>(sizeof(SAVE_STATE_SECTION) * num_sections)))
+  {
+    return false;
+  }
+
+  for (u32 i = 0; i < num_sections; i++)
+  {
+    if (!state->Write2(compressed[i]->data(), static_cast<u32>(compressed[i]->size())))
+      return false;
+  }
+
+  return true;
+}
+
+bool System::ReadSaveStateSections(ByteStream* state, const SAVE_STATE_HEADER& header, std::vector<u8>* data)
+{
+  SAVE_STATE_SECTION_TABLE table;
+  if (!state->Read2(&table, sizeof(table)) || table.num_sections == 0 || table.num_sections > MAX_SAVE_STATE_SECTIONS)
+    return false;
+
+  const u32 num_sections = table.num_sections;
+  std::vector<SAVE_STATE_SECTION> sections(num_sections);
+  if (!state->Read2(sections.data(), static_cast<u32>(sizeof(SAVE_STATE_SECTION) * num_sections)))
+    return false;
+
+  // the compressed sections follow the table, read them all in one go
+  const u64 compressed_start = state->GetPosition();
+  const u64 compressed_end = static_cast<u64>(header.offset_to_data) + header.data_compressed_size;
+  if (compressed_end < compressed_start)
+    return false;
+
+  std::vector<u8> compressed(static_cast<size_t>(compressed_end - compressed_start));
+  if (!state->Read2(compressed.data(), static_cast<u32>(compressed.size())))
+    return false;
+
+  std::vector<u32> output_offsets(num_sections);
+  u64 total_size = 0;
+  for (u32 i = 0; i < num_sections; i++)
+  {
+    const SAVE_STATE_SECTION& section = sections[i];
+    if (section.offset_to_data < compressed_start ||
+        (static_cast<u64>(section.offset_to_data) + section.compressed_size) > compressed_end)
+    {
+      return false;
+    }
+
+    output_offsets[i] = static_cast<u32>(total_size);
+    total_size += section.uncompressed_size;
+  }
+  if (total_size != header.data_uncompressed_size)
+    return false;
+
+  data->resize(static_cast<size_t>(total_size));
+
+  std::atomic_bool result{true};
+  ForEachSaveStateSection(num_sections, [&](u32 i) {
+    const SAVE_STATE_SECTION& section = sections[i];
+    u8* section_data = data->data() + output_offsets[i];
+
+    ReadOnlyMemoryByteStream cdata(&compressed[section.offset_to_data - compressed_start], section.compressed_size);
+    std::unique_ptr<ByteStream> dstream(ByteStream::CreateZstdDecompressStream(&cdata, section.compressed_size));
+    if (!dstream->Read2(section_data, section.uncompressed_size))
+    {
+      Log_ErrorPrintf("Failed to decompress save state section '%.*s'", static_cast<int>(sizeof(section.name)),
+                      section.name);
+      result.store(false);
+      return;
+    }
+
+    const XXH128_hash_t hash = XXH3_128bits(section_data, section.uncompressed_size);
+    if (hash.low64 != section.hash_low || hash.high64 != section.hash_high)
+    {
+      Log_ErrorPrintf("Save state section '%.*s' is corrupted", static_cast<int>(sizeof(section.name)),
+                      section.name);
+      result.store(false);
+    }
+  });
+
+  return result.load();
+}
+
 void System::SingleStepCPU()
 {
   const u32 old_frame_number = s_frame_number;
@@ -2193,6 +2706,7 @@ void System::SingleStepCPU()
 
 void System::DoRunFrame()
 {
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
   g_gpu->RestoreGraphicsAPIState();
 
   if (CPU::g_state.use_debug_dispatcher)
@@ -2229,6 +2743,9 @@ void System::DoRunFrame()
     s_cheat_list->Apply();
 
   g_gpu->ResetGraphicsAPIState();
+
+  s_run_frame_time_accumulator += Common::Timer::GetCurrentValue() - start_time;
+  s_run_frame_count++;
 }
 
 void System::RunFrame()
@@ -2239,6 +2756,8 @@ void System::RunFrame()
     return;
   }
 
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+
   if (s_runahead_frames > 0)
     DoRunahead();
 
@@ -2248,6 +2767,12 @@ void System::RunFrame()
 
   if (s_memory_saves_enabled)
     DoMemorySaveStates();
+
+  // Presenting and throttling are left out, only the emulation side can be scaled back.
+  const Common::Timer::Value work_time = Common::Timer::GetCurrentValue() - start_time;
+  s_frame_budget_overruns +=
+    BoolToUInt32(static_cast<double>(work_time) > static_cast<double>(s_frame_period) * FRAME_BUDGET_OVERRUN_THRESHOLD);
+  s_frame_budget_frames++;
 }
 
 float System::GetTargetSpeed()
@@ -2389,12 +2914,81 @@ void System::UpdatePerformanceCounters()
   s_accumulated_gpu_time = 0.0f;
   s_presents_since_last_update = 0;
 
+  UpdateFrameBudget();
+
   Log_VerbosePrintf("FPS: %.2f VPS: %.2f CPU: %.2f GPU: %.2f Average: %.2fms Min: %.2fms Max: %.2f ms", s_fps, s_vps,
                     s_cpu_thread_usage, s_gpu_usage, s_average_frame_time, s_minimum_frame_time, s_maximum_frame_time);
 
   Host::OnPerformanceCountersUpdated();
 }
 
+void System::UpdateFrameBudget()
+{
+  // Keep the last known costs if nothing was measured, so there's still a figure to go by when raising from zero.
+  const auto update_average = [](float* average, Common::Timer::Value* accumulator, u32* count) {
+    if (*count > 0)
+      *average = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(*accumulator) / *count);
+    *accumulator = 0;
+    *count = 0;
+  };
+  update_average(&s_average_run_frame_time, &s_run_frame_time_accumulator, &s_run_frame_count);
+  update_average(&s_average_memory_save_time, &s_memory_save_time_accumulator, &s_memory_save_count);
+  update_average(&s_average_memory_load_time, &s_memory_load_time_accumulator, &s_memory_load_count);
+
+  const u32 frames = std::exchange(s_frame_budget_frames, 0);
+  const u32 overruns = std::exchange(s_frame_budget_overruns, 0);
+  if (frames == 0 || !g_settings.adaptive_frame_budget ||
+      (!g_settings.IsRunaheadEnabled() && !g_settings.rewind_enable) || s_fast_forward_enabled || s_turbo_enabled ||
+      s_target_speed == 0.0f || Netplay::Session::IsActive())
+  {
+    return;
+  }
+
+  // The worst case is a runahead replay, which loads the oldest state, then runs and saves every frame after it.
+  const float rewind_save_time = (s_rewind_save_frequency >= 0) ? s_average_memory_save_time : 0.0f;
+  const auto get_runahead_time = [](u32 runahead_frames) {
+    if (runahead_frames == 0)
+      return 0.0f;
+
+    return s_average_memory_load_time +
+           static_cast<float>(runahead_frames) * (s_average_run_frame_time + s_average_memory_save_time);
+  };
+
+  const float budget = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(s_frame_period));
+  if ((overruns * 100) > (frames * FRAME_BUDGET_MAX_OVERRUN_PERCENT))
+  {
+    // Rewind only saves every few frames, so runahead goes first if it doesn't fit by itself.
+    const bool runahead_over_budget =
+      (s_average_run_frame_time + get_runahead_time(s_runahead_frames)) > (budget * FRAME_BUDGET_OVERRUN_THRESHOLD);
+    const bool can_lower_rewind =
+      (s_rewind_save_frequency >= 0 && s_rewind_save_frequency_scale < MAX_REWIND_SAVE_FREQUENCY_SCALE);
+    if (s_runahead_frames > 0 && (runahead_over_budget || !can_lower_rewind))
+      SetRunaheadFrames(s_runahead_frames - 1);
+    else if (can_lower_rewind)
+      SetRewindSaveFrequencyScale(s_rewind_save_frequency_scale * 2);
+
+    s_frame_budget_cooldown = FRAME_BUDGET_RAISE_COOLDOWN;
+  }
+  else if (s_frame_budget_cooldown > 0)
+  {
+    s_frame_budget_cooldown--;
+  }
+  else if (overruns == 0)
+  {
+    const float headroom = budget * FRAME_BUDGET_HEADROOM_THRESHOLD;
+    const float frame_time = s_average_run_frame_time + rewind_save_time;
+    if (s_runahead_frames < g_settings.runahead_frames &&
+        (frame_time + get_runahead_time(s_runahead_frames + 1)) < headroom)
+    {
+      SetRunaheadFrames(s_runahead_frames + 1);
+    }
+    else if (s_rewind_save_frequency_scale > 1 && (frame_time + get_runahead_time(s_runahead_frames)) < headroom)
+    {
+      SetRewindSaveFrequencyScale(s_rewind_save_frequency_scale / 2);
+    }
+  }
+}
+
 void System::ResetPerformanceCounters()
 {
   s_last_frame_number = s_frame_number;
@@ -2409,6 +3003,8 @@ void System::ResetPerformanceCounters()
   s_average_frame_time_accumulator = 0.0f;
   s_minimum_frame_time_accumulator = 0.0f;
   s_maximum_frame_time_accumulator = 0.0f;
+  s_frame_budget_frames = 0;
+  s_frame_budget_overruns = 0;
   s_frame_timer.Reset();
   s_fps_timer.Reset();
   ResetThrottler();
@@ -3318,13 +3914,15 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     if (g_settings.cpu_execution_mode == CPUExecutionMode::Recompiler &&
         (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
          g_settings.cpu_recompiler_block_linking != old_settings.cpu_recompiler_block_linking ||
+         g_settings.cpu_recompiler_async_compilation != old_settings.cpu_recompiler_async_compilation ||
          g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache))
     {
       Host::AddOSDMessage(Host::TranslateStdString("OSDMessage", "Recompiler options changed, flushing all blocks."),
                           5.0f);
 
-      // changing memory exceptions can re-enable fastmem
-      if (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions)
+      // changing memory exceptions can re-enable fastmem, and the compile thread is started on initialization
+      if (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
+          g_settings.cpu_recompiler_async_compilation != old_settings.cpu_recompiler_async_compilation)
         CPU::CodeCache::Reinitialize();
       else
         CPU::CodeCache::Flush();
@@ -3401,6 +3999,9 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     if (g_settings.cdrom_readahead_sectors != old_settings.cdrom_readahead_sectors)
       CDROM::SetReadaheadSectors(g_settings.cdrom_readahead_sectors);
 
+    if (g_settings.cdrom_chd_hunk_cache_mb != old_settings.cdrom_chd_hunk_cache_mb)
+      CDROM::SetDecompressionCacheSize(g_settings.GetCDROMCHDHunkCacheSizeInBytes());
+
     if (g_settings.memory_card_types != old_settings.memory_card_types ||
         g_settings.memory_card_paths != old_settings.memory_card_paths ||
         (g_settings.memory_card_use_playlist_title != old_settings.memory_card_use_playlist_title &&
@@ -3412,7 +4013,9 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     if (g_settings.rewind_enable != old_settings.rewind_enable ||
         g_settings.rewind_save_frequency != old_settings.rewind_save_frequency ||
         g_settings.rewind_save_slots != old_settings.rewind_save_slots ||
-        g_settings.runahead_frames != old_settings.runahead_frames)
+        g_settings.runahead_frames != old_settings.runahead_frames ||
+        g_settings.runahead_preemptive != old_settings.runahead_preemptive ||
+        g_settings.adaptive_frame_budget != old_settings.adaptive_frame_budget)
     {
       UpdateMemorySaveStateSettings();
     }
@@ -3480,17 +4083,26 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     UpdateMultitaps();
 }
 
-void System::CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage)
+void System::CalculateRewindMemoryUsage(u32 num_saves, u32 memory_budget, u64* ram_usage, u64* vram_usage)
 {
-  *ram_usage = MAX_SAVE_STATE_SIZE * static_cast<u64>(num_saves);
+  *ram_usage = std::min<u64>(MAX_SAVE_STATE_SIZE * static_cast<u64>(num_saves),
+                             static_cast<u64>(memory_budget) * 1048576);
   *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(std::max(g_settings.gpu_resolution_scale, 1u)) *
                 static_cast<u64>(g_settings.gpu_multisamples) * static_cast<u64>(num_saves);
 }
 
 void System::ClearMemorySaveStates()
 {
-  s_rewind_states.clear();
+  s_rewind_states.Clear();
+  s_rewind_vram_textures.clear();
+  s_rewind_save_state = {};
+  s_rewind_load_buffer = {};
   s_runahead_states.clear();
+  s_runahead_stale_states = 0;
+
+  // The empty slots get refilled with whatever the pads read now, so that's what replays are compared against.
+  if (s_runahead_frames > 0)
+    UpdateRunaheadInputState();
 }
 
 void System::UpdateMemorySaveStateSettings()
@@ -3502,35 +4114,54 @@ void System::UpdateMemorySaveStateSettings()
   if (g_settings.rewind_enable)
   {
     s_rewind_save_frequency = static_cast<s32>(std::ceil(g_settings.rewind_save_frequency * s_throttle_frequency));
+    s_rewind_base_save_frequency = s_rewind_save_frequency;
     s_rewind_save_counter = 0;
+    s_rewind_states.SetKeyframeInterval(REWIND_KEYFRAME_INTERVAL);
 
     u64 ram_usage, vram_usage;
-    CalculateRewindMemoryUsage(g_settings.rewind_save_slots, &ram_usage, &vram_usage);
+    CalculateRewindMemoryUsage(g_settings.rewind_save_slots, g_settings.rewind_memory_budget, &ram_usage,
+                               &vram_usage);
     Log_InfoPrintf(
-      "Rewind is enabled, saving every %d frames, with %u slots and %" PRIu64 "MB RAM and %" PRIu64 "MB VRAM usage",
+      "Rewind is enabled, saving every %d frames, with %u slots and up to %" PRIu64 "MB RAM and %" PRIu64
+      "MB VRAM usage",
       std::max(s_rewind_save_frequency, 1), g_settings.rewind_save_slots, ram_usage / 1048576, vram_usage / 1048576);
   }
   else
   {
     s_rewind_save_frequency = -1;
+    s_rewind_base_save_frequency = -1;
     s_rewind_save_counter = -1;
   }
 
+  s_rewind_save_frequency_scale = 1;
+  s_frame_budget_cooldown = 0;
   s_rewind_load_frequency = -1;
   s_rewind_load_counter = -1;
 
   s_runahead_frames = g_settings.runahead_frames;
   s_runahead_replay_pending = false;
   if (s_runahead_frames > 0)
-    Log_InfoPrintf("Runahead is active with %u frames", s_runahead_frames);
+  {
+    UpdateRunaheadInputState();
+    Log_InfoPrintf("Runahead is active with %u frames%s", s_runahead_frames,
+                   g_settings.runahead_preemptive ? " (preemptive)" : "");
+  }
 }
 
-bool System::LoadMemoryState(const MemorySaveState& mss)
+bool System::LoadMemoryState(const MemorySaveState& mss, std::vector<StateMarkerPosition>* markers /* = nullptr */)
 {
-  mss.state_stream->SeekAbsolute(0);
+  g_gpu->WaitForVRAMCopies(mss.vram_copy_fence);
+  return LoadMemoryState(mss.state_stream->GetMemoryPointer(), static_cast<u32>(mss.state_stream->GetSize()),
+                         mss.vram_texture.get(), markers);
+}
 
-  StateWrapper sw(mss.state_stream.get(), StateWrapper::Mode::Read, SAVE_STATE_VERSION);
-  GPUTexture* host_texture = mss.vram_texture.get();
+bool System::LoadMemoryState(u8* data, u32 size, GPUTexture* vram_texture,
+                             std::vector<StateMarkerPosition>* markers /* = nullptr */)
+{
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+  StateWrapper sw(data, size, StateWrapper::Mode::Read, SAVE_STATE_VERSION);
+  sw.SetMarkerPositions(markers);
+  GPUTexture* host_texture = vram_texture;
   if (!DoState(sw, &host_texture, true, true))
   {
     Host::ReportErrorAsync("Error", "Failed to load memory save state, resetting.");
@@ -3538,18 +4169,25 @@ bool System::LoadMemoryState(const MemorySaveState& mss)
     return false;
   }
 
+  s_memory_load_time_accumulator += Common::Timer::GetCurrentValue() - start_time;
+  s_memory_load_count++;
   return true;
 }
 
-bool System::SaveMemoryState(MemorySaveState* mss)
+bool System::SaveMemoryState(MemorySaveState* mss, std::vector<StateMarkerPosition>* markers /* = nullptr */)
 {
   if (!mss->state_stream)
     mss->state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
-  else
-    mss->state_stream->SeekAbsolute(0);
 
+  // The last save's VRAM copy has to land before the stream is rewritten, in case the layout moved.
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+  g_gpu->WaitForVRAMCopies(mss->vram_copy_fence);
+
+  // Write straight into the stream's memory, skipping the stream itself.
+  GrowableMemoryByteStream* stream = mss->state_stream.get();
   GPUTexture* host_texture = mss->vram_texture.release();
-  StateWrapper sw(mss->state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  StateWrapper sw(stream->GetMemoryPointer(), stream->GetMemorySize(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  sw.SetMarkerPositions(markers);
   if (!DoState(sw, &host_texture, false, true))
   {
     Log_ErrorPrint("Failed to create rewind state.");
@@ -3557,7 +4195,13 @@ bool System::SaveMemoryState(MemorySaveState* mss)
     return false;
   }
 
+  const u32 state_size = static_cast<u32>(sw.GetPosition());
+  stream->Resize(state_size);
+  stream->SeekAbsolute(state_size);
   mss->vram_texture.reset(host_texture);
+  mss->vram_copy_fence = g_gpu->GetVRAMCopyFence();
+  s_memory_save_time_accumulator += Common::Timer::GetCurrentValue() - start_time;
+  s_memory_save_count++;
   return true;
 }
 
@@ -3567,23 +4211,35 @@ bool System::SaveRewindState()
   Common::Timer save_timer;
 #endif
 
-  // try to reuse the frontmost slot
+  // try to reuse the frontmost slot's texture
   const u32 save_slots = g_settings.rewind_save_slots;
-  MemorySaveState mss;
-  while (s_rewind_states.size() >= save_slots)
+  while (s_rewind_states.GetCount() >= save_slots)
   {
-    mss = std::move(s_rewind_states.front());
-    s_rewind_states.pop_front();
+    s_rewind_states.PopFront();
+    s_rewind_save_state.vram_texture = std::move(s_rewind_vram_textures.front());
+    s_rewind_vram_textures.pop_front();
   }
 
-  if (!SaveMemoryState(&mss))
+  if (!SaveMemoryState(&s_rewind_save_state))
     return false;
 
-  s_rewind_states.push_back(std::move(mss));
+  // the state is copied out here, and compressed on the worker thread
+  g_gpu->WaitForVRAMCopies(s_rewind_save_state.vram_copy_fence);
+  const u32 state_size = static_cast<u32>(s_rewind_save_state.state_stream->GetPosition());
+  s_rewind_states.PushBack(s_rewind_save_state.state_stream->GetMemoryPointer(), state_size);
+  s_rewind_vram_textures.push_back(std::move(s_rewind_save_state.vram_texture));
+
+  // Compressed states vary a lot in size, so how many fit in the budget decides how far back rewind goes.
+  const u64 memory_budget = static_cast<u64>(g_settings.rewind_memory_budget) * 1048576;
+  while (s_rewind_states.GetCount() > 1 && s_rewind_states.GetMemoryUsage() > memory_budget)
+  {
+    s_rewind_states.PopFront();
+    s_rewind_vram_textures.pop_front();
+  }
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
-  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, took %.4f ms)", s_rewind_states.back().state_stream->GetSize(),
-                save_timer.GetTimeMilliseconds());
+  Log_DevPrintf("Saved rewind state (%u bytes, took %.4f ms, %" PRIu64 " bytes for %u states)", state_size,
+                save_timer.GetTimeMilliseconds(), s_rewind_states.GetMemoryUsage(), s_rewind_states.GetCount());
 #endif
 
   return true;
@@ -3591,24 +4247,35 @@ bool System::SaveRewindState()
 
 bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true */)
 {
-  while (skip_saves > 0 && !s_rewind_states.empty())
+  while (skip_saves > 0 && !s_rewind_states.IsEmpty())
   {
-    s_rewind_states.pop_back();
+    s_rewind_states.PopBack();
+    s_rewind_vram_textures.pop_back();
     skip_saves--;
   }
 
-  if (s_rewind_states.empty())
+  if (s_rewind_states.IsEmpty())
     return false;
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Common::Timer load_timer;
 #endif
 
-  if (!LoadMemoryState(s_rewind_states.back()))
+  if (!s_rewind_states.ReadBack(&s_rewind_load_buffer))
+  {
+    Log_ErrorPrint("Failed to decompress rewind state.");
+    return false;
+  }
+
+  if (!LoadMemoryState(s_rewind_load_buffer.data(), static_cast<u32>(s_rewind_load_buffer.size()),
+                       s_rewind_vram_textures.back().get()))
     return false;
 
   if (consume_state)
-    s_rewind_states.pop_back();
+  {
+    s_rewind_states.PopBack();
+    s_rewind_vram_textures.pop_back();
+  }
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Log_DevPrintf("Rewind load took %.4f ms", load_timer.GetTimeMilliseconds());
@@ -3660,8 +4327,15 @@ void System::DoRewind()
 
 void System::SaveRunaheadState()
 {
-  // try to reuse the frontmost slot
+  // try to reuse the frontmost slot, stale states from before a replay go first
   MemorySaveState mss;
+  if (s_runahead_stale_states > 0)
+  {
+    mss = std::move(s_runahead_states.front());
+    s_runahead_states.pop_front();
+    s_runahead_stale_states--;
+  }
+
   while (s_runahead_states.size() >= s_runahead_frames)
   {
     mss = std::move(s_runahead_states.front());
@@ -3677,6 +4351,27 @@ void System::SaveRunaheadState()
   s_runahead_states.push_back(std::move(mss));
 }
 
+bool System::UpdateRunaheadInputState()
+{
+  // Everything the game can read back from the pads. Returns true if it changed since the last call.
+  std::array<u64, NUM_CONTROLLER_AND_CARD_PORTS> state = {};
+  for (u32 i = 0; i < NUM_CONTROLLER_AND_CARD_PORTS; i++)
+  {
+    const Controller* controller = Pad::GetController(i);
+    if (!controller)
+      continue;
+
+    state[i] = (static_cast<u64>(controller->GetAnalogInputBytes().value_or(0)) << 32) |
+               (static_cast<u64>(controller->InAnalogMode()) << 16) | controller->GetButtonStateBits();
+  }
+
+  if (state == s_runahead_input_state)
+    return false;
+
+  s_runahead_input_state = state;
+  return true;
+}
+
 void System::DoRunahead()
 {
 #ifdef PROFILE_MEMORY_SAVE_STATES
@@ -3686,25 +4381,32 @@ void System::DoRunahead()
 
   if (s_runahead_replay_pending)
   {
-    // we need to replay and catch up - load the state,
+    // In preemptive mode, only replay when the pads read differently to what the frames ahead were run with. Buttons
+    // which were released again before the frame started, or analog movement too small to register, are skipped.
     s_runahead_replay_pending = false;
-    if (s_runahead_states.empty() || !LoadMemoryState(s_runahead_states.front()))
+    if (!g_settings.runahead_preemptive || UpdateRunaheadInputState())
     {
-      s_runahead_states.clear();
-      return;
-    }
+      // we need to replay and catch up - load the state,
+      if (s_runahead_states.empty() || !LoadMemoryState(s_runahead_states.front()))
+      {
+        s_runahead_states.clear();
+        s_runahead_stale_states = 0;
+        return;
+      }
 
-    // and throw away all the states, forcing us to catch up below
-    // TODO: can we leave one frame here and run, avoiding the extra save?
-    s_runahead_states.clear();
+      // and mark all the states as stale, forcing us to catch up below. The slots get overwritten in order as we go,
+      // so their buffers and textures are reused instead of being freed and allocated again.
+      s_runahead_stale_states = static_cast<u32>(s_runahead_states.size());
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
-    Log_VerbosePrintf("Rewound to frame %u, took %.2f ms", s_frame_number, timer.GetTimeMilliseconds());
+      Log_VerbosePrintf("Rewound to frame %u, took %.2f ms", s_frame_number, timer.GetTimeMilliseconds());
 #endif
+    }
   }
 
   // run the frames with no audio
-  s32 frames_to_run = static_cast<s32>(s_runahead_frames) - static_cast<s32>(s_runahead_states.size());
+  s32 frames_to_run = static_cast<s32>(s_runahead_frames) -
+                      static_cast<s32>(s_runahead_states.size() - s_runahead_stale_states);
   if (frames_to_run > 0)
   {
     Common::Timer timer2;
@@ -3757,6 +4459,42 @@ void System::DoMemorySaveStates()
     SaveRunaheadState();
 }
 
+void System::SetRunaheadFrames(u32 frames)
+{
+  Log_InfoPrintf("Frame time budget: %s runahead from %u to %u frames",
+                 (frames < s_runahead_frames) ? "lowering" : "raising", s_runahead_frames, frames);
+
+  // Dropping the oldest states leaves the front one the new number of frames behind. Going up, the next runahead
+  // runs the extra frames ahead by itself.
+  if (frames == 0)
+  {
+    s_runahead_states.clear();
+    s_runahead_stale_states = 0;
+    s_runahead_replay_pending = false;
+  }
+  else
+  {
+    while (s_runahead_states.size() > frames)
+    {
+      s_runahead_states.pop_front();
+      s_runahead_stale_states -= BoolToUInt32(s_runahead_stale_states > 0);
+    }
+
+    if (s_runahead_frames == 0)
+      UpdateRunaheadInputState();
+  }
+
+  s_runahead_frames = frames;
+}
+
+void System::SetRewindSaveFrequencyScale(u32 scale)
+{
+  s_rewind_save_frequency_scale = scale;
+  s_rewind_save_frequency = static_cast<s32>(static_cast<u32>(s_rewind_base_save_frequency + 1) * scale) - 1;
+  s_rewind_save_counter = std::min(s_rewind_save_counter, s_rewind_save_frequency);
+  Log_InfoPrintf("Frame time budget: saving rewind states every %d frames", s_rewind_save_frequency + 1);
+}
+
 void System::SetRunaheadReplayFlag()
 {
   if (s_runahead_frames == 0 || s_runahead_states.empty())
@@ -3979,6 +4717,8 @@ std::vector<SaveStateInfo> System::GetAvailableSaveStates(const char* serial)
   std::vector<SaveStateInfo> si;
   std::string path;
 
+  WaitForSaveStateWrites();
+
   auto add_path = [&si](std::string path, s32 slot, bool global) {
     FILESYSTEM_STAT_DATA sd;
     if (!FileSystem::StatFile(path.c_str(), &sd))
@@ -4005,6 +4745,8 @@ std::optional<SaveStateInfo> System::GetSaveStateInfo(const char* serial, s32 sl
   const bool global = (!serial || serial[0] == 0);
   std::string path = global ? GetGlobalSaveStateFileName(slot) : GetGameSaveStateFileName(serial, slot);
 
+  WaitForSaveStateWrites();
+
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path.c_str(), &sd))
     return std::nullopt;
@@ -4014,6 +4756,8 @@ std::optional<SaveStateInfo> System::GetSaveStateInfo(const char* serial, s32 sl
 
 std::optional<ExtendedSaveStateInfo> System::GetExtendedSaveStateInfo(const char* path)
 {
+  WaitForSaveStateWrites();
+
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path, &sd))
     return std::nullopt;
@@ -4094,6 +4838,8 @@ void System::DeleteSaveStates(const char* serial, bool resume)
 
 std::string System::GetMostRecentResumeSaveStatePath()
 {
+  WaitForSaveStateWrites();
+
   std::vector<FILESYSTEM_FIND_DATA> files;
   if (!FileSystem::FindFiles(EmuFolders::SaveStates.c_str(), "*resume.sav", FILESYSTEM_FIND_FILES, &files) ||
       files.empty())
@@ -10,10 +10,14 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 class ByteStream;
 class CDImage;
+class GPUTexture;
+class GrowableMemoryByteStream;
 class StateWrapper;
+struct StateMarkerPosition;
 
 class Controller;
 
@@ -25,6 +29,23 @@ struct ImageInfo;
 struct Hash;
 } // namespace BIOS
 
+/// A snapshot of the system held in memory, for rewind, runahead and netplay rollback. Hardware renderers keep VRAM
+/// in a texture rather than in the stream, so these only make sense within the running session. The software renderer
+/// copies VRAM into the stream on its own thread, so the stream can still be pending until vram_copy_fence is waited
+/// on. Saving and loading the state does this, and so does destroying it.
+struct MemorySaveState
+{
+  MemorySaveState();
+  MemorySaveState(MemorySaveState&& other);
+  ~MemorySaveState();
+
+  MemorySaveState& operator=(MemorySaveState&& other);
+
+  std::unique_ptr<GPUTexture> vram_texture;
+  std::unique_ptr<GrowableMemoryByteStream> state_stream;
+  u64 vram_copy_fence = 0;
+};
+
 struct SystemBootParameters
 {
   SystemBootParameters();
@@ -205,6 +226,16 @@ float GetGPUAverageTime();
 const FrameTimeHistory& GetFrameTimeHistory();
 u32 GetFrameTimeHistoryPos();
 
+/// Measured cost of running a frame and saving a memory state, in milliseconds.
+float GetAverageRunFrameTime();
+float GetAverageMemorySaveStateTime();
+
+/// Runahead depth and rewind save frequency in use. These can be lowered from the settings when the host can't keep
+/// up, see IsFrameBudgetLimited().
+u32 GetRunaheadFrames();
+s32 GetRewindSaveFrequency();
+bool IsFrameBudgetLimited();
+
 /// Loads global settings (i.e. EmuConfig).
 void LoadSettings(bool display_osd_messages);
 void SetDefaultSettings(SettingsInterface& si);
@@ -221,9 +252,20 @@ void ResetSystem();
 
 /// Loads state from the specified filename.
 bool LoadState(const char* filename);
+
+/// Captures the state and queues it to be compressed and written on a worker thread. Returns false if the state could
+/// not be captured, failures when writing are reported when they happen.
 bool SaveState(const char* filename, bool backup_existing_save);
 bool SaveResumeState();
 
+/// Waits for any queued save states to be written, and stops the writer thread. Call before exiting.
+void FlushSaveStates();
+
+/// Writes a state to the stream in the same format as a save state file, without a screenshot, or loads one back.
+/// Compression methods are from SAVE_STATE_HEADER. Mainly useful for benchmarking.
+bool SaveStateToStream(ByteStream* stream, u32 compression_method);
+bool LoadStateFromStream(ByteStream* stream);
+
 /// Runs the VM until the CPU execution is canceled.
 void Execute();
 
@@ -449,7 +491,13 @@ void HostDisplayResized();
 //////////////////////////////////////////////////////////////////////////
 // Memory Save States (Rewind and Runahead)
 //////////////////////////////////////////////////////////////////////////
-void CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage);
+/// RAM usage is capped by the memory budget (in MB), VRAM textures are only capped by the number of saves.
+void CalculateRewindMemoryUsage(u32 num_saves, u32 memory_budget, u64* ram_usage, u64* vram_usage);
+
+/// Marker positions and times can optionally be recorded, to see where the time goes.
+bool SaveMemoryState(MemorySaveState* mss, std::vector<StateMarkerPosition>* markers = nullptr);
+bool LoadMemoryState(const MemorySaveState& mss, std::vector<StateMarkerPosition>* markers = nullptr);
+
 void ClearMemorySaveStates();
 void UpdateMemorySaveStateSettings();
 bool LoadRewindState(u32 skip_saves = 0, bool consume_state = true);
@@ -8,34 +8,38 @@
 #include "cpu_core_private.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+#include <algorithm>
 Log_SetChannel(TimingEvents);
 
 namespace TimingEvents {
 
-static TimingEvent* s_active_events_head;
-static TimingEvent* s_active_events_tail;
+// Active events are kept in a binary min-heap ordered by their absolute run time, so only the events which are
+// actually due need to be touched when time advances.
+static std::vector<TimingEvent*> s_active_events;
 static TimingEvent* s_current_event = nullptr;
-static u32 s_active_event_count = 0;
-static u32 s_global_tick_counter = 0;
+static GlobalTicks s_global_tick_counter = 0;
+static TickCount s_next_event_downcount = 0;
+static u32 s_next_event_order = 0;
 
 u32 GetGlobalTickCounter()
 {
-  return s_global_tick_counter;
+  return static_cast<u32>(s_global_tick_counter);
 }
 
-void Initialize()
+const TickCount* GetNextEventDowncountPtr()
 {
-  Reset();
+  return &s_next_event_downcount;
 }
 
-void Reset()
+void Initialize()
 {
-  s_global_tick_counter = 0;
+  s_active_events.reserve(32);
+  Reset();
 }
 
 void Shutdown()
 {
-  Assert(s_active_event_count == 0);
+  Assert(s_active_events.empty());
 }
 
 std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
@@ -53,205 +57,154 @@ void UpdateCPUDowncount()
 {
   if (!CPU::g_state.frame_done && (!CPU::HasPendingInterrupt() || CPU::g_using_interpreter))
   {
-    CPU::g_state.downcount = s_active_events_head->GetDowncount();
+    CPU::g_state.downcount = s_next_event_downcount;
   }
 }
 
-TimingEvent** GetHeadEventPtr()
+// Returns true if lhs should run before rhs. Times are compared relative to each other so that events which are
+// "late" after a state load don't wrap around. Ties are broken by creation order, which keeps the execution order
+// independent of the heap layout, and therefore deterministic across save state loads.
+static ALWAYS_INLINE bool CompareEvents(const TimingEvent* lhs, const TimingEvent* rhs)
 {
-  return &s_active_events_head;
+  const s64 diff = static_cast<s64>(lhs->m_next_run_time - rhs->m_next_run_time);
+  return (diff < 0 || (diff == 0 && lhs->m_order < rhs->m_order));
 }
 
-static void SortEvent(TimingEvent* event)
+static ALWAYS_INLINE TickCount GetEventDowncount(const TimingEvent* event)
 {
-  const TickCount event_downcount = event->m_downcount;
-
-  if (event->prev && event->prev->m_downcount > event_downcount)
-  {
-    // move backwards
-    TimingEvent* current = event->prev;
-    while (current && current->m_downcount > event_downcount)
-      current = current->prev;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert after current
-    if (current)
-    {
-      event->next = current->next;
-      if (current->next)
-        current->next->prev = event;
-      else
-        s_active_events_tail = event;
-
-      event->prev = current;
-      current->next = event;
-    }
-    else
-    {
-      // insert at front
-      DebugAssert(s_active_events_head);
-      s_active_events_head->prev = event;
-      event->prev = nullptr;
-      event->next = s_active_events_head;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (event->next && event_downcount > event->next->m_downcount)
-  {
-    // move forwards
-    TimingEvent* current = event->next;
-    while (current && event_downcount > current->m_downcount)
-      current = current->next;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert before current
-    if (current)
-    {
-      event->next = current;
-      event->prev = current->prev;
+  return static_cast<TickCount>(event->m_next_run_time - s_global_tick_counter);
+}
 
-      if (current->prev)
-        current->prev->next = event;
-      else
-        s_active_events_head = event;
+static void UpdateNextEventDowncount()
+{
+  if (s_active_events.empty())
+    return;
 
-      current->prev = event;
-    }
-    else
-    {
-      // insert at back
-      DebugAssert(s_active_events_tail);
-      s_active_events_tail->next = event;
-      event->next = nullptr;
-      event->prev = s_active_events_tail;
-      s_active_events_tail = event;
-    }
-  }
+  s_next_event_downcount = GetEventDowncount(s_active_events.front());
+  UpdateCPUDowncount();
 }
 
-static void AddActiveEvent(TimingEvent* event)
+static void SiftUp(u32 index)
 {
-  DebugAssert(!event->prev && !event->next);
-  s_active_event_count++;
-
-  TimingEvent* current = nullptr;
-  TimingEvent* next = s_active_events_head;
-  while (next && event->m_downcount > next->m_downcount)
+  TimingEvent* event = s_active_events[index];
+  while (index > 0)
   {
-    current = next;
-    next = next->next;
+    const u32 parent_index = (index - 1) / 2;
+    TimingEvent* parent = s_active_events[parent_index];
+    if (!CompareEvents(event, parent))
+      break;
+
+    s_active_events[index] = parent;
+    parent->m_heap_index = index;
+    index = parent_index;
   }
 
-  if (!next)
-  {
-    // new tail
-    event->prev = s_active_events_tail;
-    if (s_active_events_tail)
-    {
-      s_active_events_tail->next = event;
-      s_active_events_tail = event;
-    }
-    else
-    {
-      // first event
-      s_active_events_tail = event;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (!current)
+  s_active_events[index] = event;
+  event->m_heap_index = index;
+}
+
+static void SiftDown(u32 index)
+{
+  const u32 count = static_cast<u32>(s_active_events.size());
+  TimingEvent* event = s_active_events[index];
+  for (;;)
   {
-    // new head
-    event->next = s_active_events_head;
-    s_active_events_head->prev = event;
-    s_active_events_head = event;
-    UpdateCPUDowncount();
+    u32 child_index = index * 2 + 1;
+    if (child_index >= count)
+      break;
+    if ((child_index + 1) < count && CompareEvents(s_active_events[child_index + 1], s_active_events[child_index]))
+      child_index++;
+
+    TimingEvent* child = s_active_events[child_index];
+    if (!CompareEvents(child, event))
+      break;
+
+    s_active_events[index] = child;
+    child->m_heap_index = index;
+    index = child_index;
   }
+
+  s_active_events[index] = event;
+  event->m_heap_index = index;
+}
+
+static void SortEvent(TimingEvent* event)
+{
+  const u32 index = event->m_heap_index;
+  DebugAssert(s_active_events[index] == event);
+
+  if (index > 0 && CompareEvents(event, s_active_events[(index - 1) / 2]))
+    SiftUp(index);
   else
-  {
-    // inbetween current < event > next
-    event->prev = current;
-    event->next = next;
-    current->next = event;
-    next->prev = event;
-  }
+    SiftDown(index);
+
+  UpdateNextEventDowncount();
+}
+
+static void AddActiveEvent(TimingEvent* event)
+{
+  const u32 index = static_cast<u32>(s_active_events.size());
+  s_active_events.push_back(event);
+  SiftUp(index);
+  UpdateNextEventDowncount();
 }
 
 static void RemoveActiveEvent(TimingEvent* event)
 {
-  DebugAssert(s_active_event_count > 0);
+  DebugAssert(!s_active_events.empty());
 
-  if (event->next)
-  {
-    event->next->prev = event->prev;
-  }
-  else
-  {
-    s_active_events_tail = event->prev;
-  }
+  const u32 index = event->m_heap_index;
+  DebugAssert(s_active_events[index] == event);
 
-  if (event->prev)
+  // Move the last event into the hole, and restore the heap property from there.
+  TimingEvent* last = s_active_events.back();
+  s_active_events.pop_back();
+  if (last != event)
   {
-    event->prev->next = event->next;
+    s_active_events[index] = last;
+    last->m_heap_index = index;
+    SortEvent(last);
   }
   else
   {
-    s_active_events_head = event->next;
-    if (s_active_events_head)
-      UpdateCPUDowncount();
+    UpdateNextEventDowncount();
   }
 
-  event->prev = nullptr;
-  event->next = nullptr;
-
-  s_active_event_count--;
+  event->m_heap_index = 0;
 }
 
 static void SortEvents()
 {
-  std::vector<TimingEvent*> events;
-  events.reserve(s_active_event_count);
+  const u32 count = static_cast<u32>(s_active_events.size());
+  for (u32 i = 0; i < count; i++)
+    s_active_events[i]->m_heap_index = i;
+  for (u32 i = count / 2; i > 0; i--)
+    SiftDown(i - 1);
+
+  UpdateNextEventDowncount();
+}
 
-  TimingEvent* next = s_active_events_head;
-  while (next)
+static void SetGlobalTickCounter(GlobalTicks value)
+{
+  // Active events are scheduled in absolute time, so they move along with the counter.
+  for (TimingEvent* event : s_active_events)
   {
-    TimingEvent* current = next;
-    events.push_back(current);
-    next = current->next;
-    current->prev = nullptr;
-    current->next = nullptr;
+    event->m_next_run_time = event->m_next_run_time - s_global_tick_counter + value;
+    event->m_last_run_time = event->m_last_run_time - s_global_tick_counter + value;
   }
 
-  s_active_events_head = nullptr;
-  s_active_events_tail = nullptr;
-  s_active_event_count = 0;
+  s_global_tick_counter = value;
+  UpdateNextEventDowncount();
+}
 
-  for (TimingEvent* event : events)
-    AddActiveEvent(event);
+void Reset()
+{
+  SetGlobalTickCounter(0);
 }
 
 static TimingEvent* FindActiveEvent(const char* name)
 {
-  for (TimingEvent* event = s_active_events_head; event; event = event->next)
+  for (TimingEvent* event : s_active_events)
   {
     if (event->GetName().compare(name) == 0)
       return event;
@@ -268,48 +221,44 @@ void RunEvents()
   CPU::ResetPendingTicks();
   while (pending_ticks > 0)
   {
-    const TickCount time = std::min(pending_ticks, s_active_events_head->GetDowncount());
-    s_global_tick_counter += static_cast<u32>(time);
+    const TickCount time = std::min(pending_ticks, GetEventDowncount(s_active_events.front()));
+    s_global_tick_counter += static_cast<GlobalTicks>(time);
     pending_ticks -= time;
 
-    // Apply downcount to all events.
-    // This will result in a negative downcount for those events which are late.
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
+    // Now we can actually run the callbacks. Events which are late will have a negative downcount.
+    TimingEvent* event = s_active_events.front();
+    while (GetEventDowncount(event) <= 0)
     {
-      event->m_downcount -= time;
-      event->m_time_since_last_run += time;
-    }
-
-    // Now we can actually run the callbacks.
-    while (s_active_events_head->m_downcount <= 0)
-    {
-      // move it to the end, since that'll likely be its new position
-      TimingEvent* event = s_active_events_head;
       s_current_event = event;
 
       // Factor late time into the time for the next invocation.
-      const TickCount ticks_late = -event->m_downcount;
-      const TickCount ticks_to_execute = event->m_time_since_last_run;
-      event->m_downcount += event->m_interval;
-      event->m_time_since_last_run = 0;
+      const TickCount ticks_late = -GetEventDowncount(event);
+      const TickCount ticks_to_execute = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
+      event->m_next_run_time += static_cast<GlobalTicks>(event->m_interval);
+      event->m_last_run_time = s_global_tick_counter;
 
       // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
       event->m_callback(event->m_callback_param, ticks_to_execute, ticks_late);
       if (event->m_active)
         SortEvent(event);
+
+      event = s_active_events.front();
     }
   }
 
   s_current_event = nullptr;
-  UpdateCPUDowncount();
+  UpdateNextEventDowncount();
 }
 
 bool DoState(StateWrapper& sw)
 {
-  sw.Do(&s_global_tick_counter);
-
   if (sw.IsReading())
   {
+    // Events which aren't in the save state keep their current relative times.
+    u32 global_tick_counter = 0;
+    sw.Do(&global_tick_counter);
+    SetGlobalTickCounter(global_tick_counter);
+
     // Load timestamps for the clock events.
     // Any oneshot events should be recreated by the load state method, so we can fix up their times here.
     u32 event_count = 0;
@@ -334,9 +283,9 @@ bool DoState(StateWrapper& sw)
         continue;
       }
 
-      // Using reschedule is safe here since we call sort afterwards.
-      event->m_downcount = downcount;
-      event->m_time_since_last_run = time_since_last_run;
+      // Modifying the times directly is safe here since we call sort afterwards.
+      event->m_next_run_time = s_global_tick_counter + static_cast<GlobalTicks>(downcount);
+      event->m_last_run_time = s_global_tick_counter - static_cast<GlobalTicks>(time_since_last_run);
       event->m_period = period;
       event->m_interval = interval;
     }
@@ -352,30 +301,46 @@ bool DoState(StateWrapper& sw)
   }
   else
   {
+    u32 global_tick_counter = GetGlobalTickCounter();
+    sw.Do(&global_tick_counter);
 
-    sw.Do(&s_active_event_count);
+    // Write events in execution order, so the state doesn't depend on the layout of the heap.
+    std::vector<TimingEvent*> events(s_active_events);
+    std::sort(events.begin(), events.end(), CompareEvents);
 
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
+    u32 event_count = static_cast<u32>(events.size());
+    sw.Do(&event_count);
+
+    for (TimingEvent* event : events)
     {
+      TickCount downcount = GetEventDowncount(event);
+      TickCount time_since_last_run = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
       sw.Do(&event->m_name);
-      sw.Do(&event->m_downcount);
-      sw.Do(&event->m_time_since_last_run);
+      sw.Do(&downcount);
+      sw.Do(&time_since_last_run);
       sw.Do(&event->m_period);
       sw.Do(&event->m_interval);
     }
 
-    Log_DevPrintf("Wrote %u events to save state.", s_active_event_count);
+    Log_DevPrintf("Wrote %u events to save state.", event_count);
   }
 
   return !sw.HasError();
 }
 
+// Inactive events store their run times relative to the point they were deactivated, so the time base is zero.
+static ALWAYS_INLINE GlobalTicks GetEventTimeBase(const TimingEvent* event)
+{
+  return (event->m_active ? s_global_tick_counter : 0) + static_cast<GlobalTicks>(CPU::GetPendingTicks());
+}
+
 } // namespace TimingEvents
 
 TimingEvent::TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback,
                          void* callback_param)
-  : m_callback(callback), m_callback_param(callback_param), m_downcount(interval), m_time_since_last_run(0),
-    m_period(period), m_interval(interval), m_name(std::move(name))
+  : m_callback(callback), m_callback_param(callback_param), m_next_run_time(static_cast<GlobalTicks>(interval)),
+    m_last_run_time(0), m_period(period), m_interval(interval), m_order(TimingEvents::s_next_event_order++),
+    m_name(std::move(name))
 {
 }
 
@@ -387,12 +352,13 @@ TimingEvent::~TimingEvent()
 
 TickCount TimingEvent::GetTicksSinceLastExecution() const
 {
-  return CPU::GetPendingTicks() + m_time_since_last_run;
+  return static_cast<TickCount>(TimingEvents::GetEventTimeBase(this) - m_last_run_time);
 }
 
 TickCount TimingEvent::GetTicksUntilNextExecution() const
 {
-  return std::max(m_downcount - CPU::GetPendingTicks(), static_cast<TickCount>(0));
+  return std::max(static_cast<TickCount>(m_next_run_time - TimingEvents::GetEventTimeBase(this)),
+                  static_cast<TickCount>(0));
 }
 
 void TimingEvent::Delay(TickCount ticks)
@@ -403,7 +369,7 @@ void TimingEvent::Delay(TickCount ticks)
     return;
   }
 
-  m_downcount += ticks;
+  m_next_run_time += static_cast<GlobalTicks>(ticks);
 
   DebugAssert(TimingEvents::s_current_event != this);
   TimingEvents::SortEvent(this);
@@ -411,13 +377,14 @@ void TimingEvent::Delay(TickCount ticks)
 
 void TimingEvent::Schedule(TickCount ticks)
 {
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount = pending_ticks + ticks;
+  const GlobalTicks current_time =
+    TimingEvents::s_global_tick_counter + static_cast<GlobalTicks>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<GlobalTicks>(ticks);
 
   if (!m_active)
   {
     // Event is going active, so we want it to only execute ticks from the current timestamp.
-    m_time_since_last_run = -pending_ticks;
+    m_last_run_time = current_time;
     m_active = true;
     TimingEvents::AddActiveEvent(this);
   }
@@ -448,8 +415,8 @@ void TimingEvent::Reset()
   if (!m_active)
     return;
 
-  m_downcount = m_interval;
-  m_time_since_last_run = 0;
+  m_next_run_time = TimingEvents::s_global_tick_counter + static_cast<GlobalTicks>(m_interval);
+  m_last_run_time = TimingEvents::s_global_tick_counter;
   if (TimingEvents::s_current_event != this)
     TimingEvents::SortEvent(this);
 }
@@ -459,13 +426,13 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  const TickCount ticks_to_execute = m_time_since_last_run + pending_ticks;
+  const GlobalTicks current_time = TimingEvents::GetEventTimeBase(this);
+  const TickCount ticks_to_execute = static_cast<TickCount>(current_time - m_last_run_time);
   if ((!force && ticks_to_execute < m_period) || ticks_to_execute <= 0)
     return;
 
-  m_downcount = pending_ticks + m_interval;
-  m_time_since_last_run -= ticks_to_execute;
+  m_next_run_time = current_time + static_cast<GlobalTicks>(m_interval);
+  m_last_run_time = current_time;
   m_callback(m_callback_param, ticks_to_execute, 0);
 
   // Since we've changed the downcount, we need to re-sort the events.
@@ -479,9 +446,10 @@ void TimingEvent::Activate()
     return;
 
   // leave the downcount intact
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount += pending_ticks;
-  m_time_since_last_run -= pending_ticks;
+  const GlobalTicks current_time =
+    TimingEvents::s_global_tick_counter + static_cast<GlobalTicks>(CPU::GetPendingTicks());
+  m_next_run_time += current_time;
+  m_last_run_time += current_time;
 
   m_active = true;
   TimingEvents::AddActiveEvent(this);
@@ -492,9 +460,9 @@ void TimingEvent::Deactivate()
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount -= pending_ticks;
-  m_time_since_last_run += pending_ticks;
+  const GlobalTicks current_time = TimingEvents::GetEventTimeBase(this);
+  m_next_run_time -= current_time;
+  m_last_run_time -= current_time;
 
   m_active = false;
   TimingEvents::RemoveActiveEvent(this);
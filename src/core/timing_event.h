@@ -27,7 +27,6 @@ public:
   // Returns the number of ticks between each event.
   ALWAYS_INLINE TickCount GetPeriod() const { return m_period; }
   ALWAYS_INLINE TickCount GetInterval() const { return m_interval; }
-  ALWAYS_INLINE TickCount GetDowncount() const { return m_downcount; }
 
   // Includes pending time.
   TickCount GetTicksSinceLastExecution() const;
@@ -63,16 +62,18 @@ public:
   void SetInterval(TickCount interval) { m_interval = interval; }
   void SetPeriod(TickCount period) { m_period = period; }
 
-  TimingEvent* prev = nullptr;
-  TimingEvent* next = nullptr;
-
   TimingEventCallback m_callback;
   void* m_callback_param;
 
-  TickCount m_downcount;
-  TickCount m_time_since_last_run;
+  // Absolute times. While the event is inactive, these are relative to the point it was deactivated.
+  GlobalTicks m_next_run_time;
+  GlobalTicks m_last_run_time;
   TickCount m_period;
   TickCount m_interval;
+
+  // Position in the active event heap, and creation order, used to break ties between events due at the same time.
+  u32 m_heap_index = 0;
+  u32 m_order;
   bool m_active = false;
 
   std::string m_name;
@@ -97,6 +98,7 @@ void RunEvents();
 
 void UpdateCPUDowncount();
 
-TimingEvent** GetHeadEventPtr();
+/// Ticks from the last event run until the next event is due. Read directly by the recompiler dispatcher.
+const TickCount* GetNextEventDowncountPtr();
 
-} // namespace TimingEvents
\ No newline at end of file
+} // namespace TimingEvents
@@ -22,6 +22,9 @@ enum class MemoryAccessSize : u32
 
 using TickCount = s32;
 
+// Absolute time in system ticks, used for scheduling.
+using GlobalTicks = u64;
+
 enum class ConsoleRegion
 {
   Auto,
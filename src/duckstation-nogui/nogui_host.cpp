@@ -829,6 +829,11 @@ void Host::OnPerformanceCountersUpdated()
   // noop
 }
 
+void Host::OnNetplayMessage(std::string& message)
+{
+  Log_InfoPrintf("Netplay: %s", message.c_str());
+}
+
 void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name)
 {
   CommonHost::OnGameChanged(disc_path, game_serial, game_name);
@@ -255,6 +255,8 @@ void AdvancedSettingsWidget::addTweakOptions()
                         "RecompilerMemoryExceptions", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Linking"), "CPU",
                         "RecompilerBlockLinking", true);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Background Compilation"), "CPU",
+                        "RecompilerAsyncCompilation", false);
   addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Fast Memory Access"), "CPU",
                        "FastmemMode", Settings::ParseCPUFastmemMode, Settings::GetCPUFastmemModeName,
                        Settings::GetCPUFastmemModeDisplayName, "CPUFastmemMode",
@@ -319,6 +321,7 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                              Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD); // PGXP depth clear threshold
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler memory exceptions
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);              // Recompiler block linking
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler background compilation
     setChoiceTweakOption(m_ui.tweakOptionTable, i++, Settings::DEFAULT_CPU_FASTMEM_MODE); // Recompiler fastmem mode
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                             // Use Old MDEC Routines
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // VRAM write texture replacement
@@ -365,6 +368,7 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("GPU", "PGXPDepthClearThreshold");
   sif->DeleteValue("CPU", "RecompilerMemoryExceptions");
   sif->DeleteValue("CPU", "RecompilerBlockLinking");
+  sif->DeleteValue("CPU", "RecompilerAsyncCompilation");
   sif->DeleteValue("CPU", "FastmemMode");
   sif->DeleteValue("TextureReplacements", "EnableVRAMWriteReplacements");
   sif->DeleteValue("TextureReplacements", "PreloadTextures");
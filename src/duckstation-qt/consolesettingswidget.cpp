@@ -50,6 +50,8 @@ ConsoleSettingsWidget::ConsoleSettingsWidget(SettingsDialog* dialog, QWidget* pa
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.recompilerICache, "CPU", "RecompilerICache", false);
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.cdromReadaheadSectors, "CDROM", "ReadaheadSectors",
                                               Settings::DEFAULT_CDROM_READAHEAD_SECTORS);
+  SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.cdromCHDHunkCacheSize, "CDROM", "CHDHunkCacheSize",
+                                              Settings::DEFAULT_CDROM_CHD_HUNK_CACHE_MB);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromRegionCheck, "CDROM", "RegionCheck", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromLoadImageToRAM, "CDROM", "LoadImageToRAM", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.cdromLoadImagePatches, "CDROM", "LoadImagePatches", false);
@@ -91,6 +93,9 @@ ConsoleSettingsWidget::ConsoleSettingsWidget(SettingsDialog* dialog, QWidget* pa
                              tr("Reduces hitches in emulation by reading/decompressing CD data asynchronously on a "
                                 "worker thread. Higher sector numbers can reduce spikes when streaming FMVs or audio "
                                 "on slower storage or when using compression formats such as CHD."));
+  dialog->registerWidgetHelp(m_ui.cdromCHDHunkCacheSize, tr("CHD Hunk Cache"), tr("16 MB"),
+                             tr("Decompresses CHD images ahead of the read position on worker threads, keeping up to "
+                                "this much data cached. Set to zero to decompress on demand instead."));
   dialog->registerWidgetHelp(m_ui.cdromRegionCheck, tr("Enable Region Check"), tr("Checked"),
                              tr("Simulates the region check present in original, unmodified consoles."));
   dialog->registerWidgetHelp(
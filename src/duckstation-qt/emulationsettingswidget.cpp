@@ -22,7 +22,11 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsDialog* dialog, QWidget
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.rewindEnable, "Main", "RewindEnable", false);
   SettingWidgetBinder::BindWidgetToFloatSetting(sif, m_ui.rewindSaveFrequency, "Main", "RewindFrequency", 10.0f);
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.rewindSaveSlots, "Main", "RewindSaveSlots", 10);
+  SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.rewindMemoryBudget, "Main", "RewindMemoryBudget", 256);
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.runaheadFrames, "Main", "RunaheadFrameCount", 0);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.runaheadPreemptive, "Main", "RunaheadPreemptive", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.adaptiveFrameBudget, "Main", "AdaptiveFrameBudget",
+                                               Settings::DEFAULT_ADAPTIVE_FRAME_BUDGET);
 
   const float effective_emulation_speed = m_dialog->getEffectiveFloatValue("Main", "EmulationSpeed", 1.0f);
   fillComboBoxWithEmulationSpeeds(m_ui.emulationSpeed, effective_emulation_speed);
@@ -74,6 +78,8 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsDialog* dialog, QWidget
           &EmulationSettingsWidget::updateRewind);
   connect(m_ui.rewindSaveSlots, QOverload<int>::of(&QSpinBox::valueChanged), this,
           &EmulationSettingsWidget::updateRewind);
+  connect(m_ui.rewindMemoryBudget, QOverload<int>::of(&QSpinBox::valueChanged), this,
+          &EmulationSettingsWidget::updateRewind);
   connect(m_ui.runaheadFrames, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &EmulationSettingsWidget::updateRewind);
 
@@ -105,11 +111,22 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsDialog* dialog, QWidget
        "<b>Rewind Save Frequency:</b> How often a rewind state will be created. Higher frequencies have greater system "
        "requirements.<br> "
        "<b>Rewind Buffer Size:</b> How many saves will be kept for rewinding. Higher values have greater memory "
-       "requirements."));
+       "requirements.<br> "
+       "<b>Rewind Memory Budget:</b> How much RAM the compressed saves can use. The oldest saves are dropped when "
+       "it runs out, so this limits how far back rewind goes as well."));
   dialog->registerWidgetHelp(
     m_ui.runaheadFrames, tr("Runahead"), tr("Disabled"),
     tr(
       "Simulates the system ahead of time and rolls back/replays to reduce input lag. Very high system requirements."));
+  dialog->registerWidgetHelp(
+    m_ui.runaheadPreemptive, tr("Preemptive Runahead"), tr("Unchecked"),
+    tr("Only rolls back and replays when the controller input actually differs from what the frames ahead were run "
+       "with. Presses which are released again before the next frame, or analog movement too small to register, no "
+       "longer cost a replay. Recommended for 2 or more frames of runahead on slower systems."));
+  dialog->registerWidgetHelp(
+    m_ui.adaptiveFrameBudget, tr("Adapt To Frame Time Budget"), tr("Unchecked"),
+    tr("Lowers the number of runahead frames, then how often rewind saves, when the system can't keep up with them "
+       "at full speed, and raises them back to the configured values once there's room again."));
 
   updateRewind();
 }
@@ -181,6 +198,8 @@ void EmulationSettingsWidget::updateRewind()
   const bool rewind_enabled = m_dialog->getEffectiveBoolValue("Main", "RewindEnable", false);
   const bool runahead_enabled = m_dialog->getIntValue("Main", "RunaheadFrameCount", 0) > 0;
   m_ui.rewindEnable->setEnabled(!runahead_enabled);
+  m_ui.runaheadPreemptive->setEnabled(runahead_enabled);
+  m_ui.adaptiveFrameBudget->setEnabled(runahead_enabled || rewind_enabled);
 
   if (!runahead_enabled && rewind_enabled)
   {
@@ -190,7 +209,8 @@ void EmulationSettingsWidget::updateRewind()
       ((frequency <= std::numeric_limits<float>::epsilon()) ? (1.0f / 60.0f) : frequency) * static_cast<float>(frames);
 
     u64 ram_usage, vram_usage;
-    System::CalculateRewindMemoryUsage(frames, &ram_usage, &vram_usage);
+    System::CalculateRewindMemoryUsage(frames, static_cast<u32>(m_ui.rewindMemoryBudget->value()), &ram_usage,
+                                       &vram_usage);
 
     m_ui.rewindSummary->setText(
       tr("Rewind for %n frame(s), lasting %1 second(s) will require up to %2MB of RAM and %3MB of VRAM.", "", frames)
@@ -199,6 +219,7 @@ void EmulationSettingsWidget::updateRewind()
         .arg(vram_usage / 1048576));
     m_ui.rewindSaveFrequency->setEnabled(true);
     m_ui.rewindSaveSlots->setEnabled(true);
+    m_ui.rewindMemoryBudget->setEnabled(true);
   }
   else
   {
@@ -214,5 +235,6 @@ void EmulationSettingsWidget::updateRewind()
     }
     m_ui.rewindSaveFrequency->setEnabled(false);
     m_ui.rewindSaveSlots->setEnabled(false);
+    m_ui.rewindMemoryBudget->setEnabled(false);
   }
 }
@@ -224,31 +224,17 @@ void GameSummaryWidget::onComputeHashClicked()
 #endif
 
   QtModalProgressCallback progress_callback(this);
-  progress_callback.SetProgressRange(image->GetTrackCount());
-
-  std::vector<CDImageHasher::Hash> track_hashes;
-  track_hashes.reserve(image->GetTrackCount());
 
   // Calculate hashes
-  bool calculate_hash_success = true;
-  for (u8 track = 1; track <= image->GetTrackCount(); track++)
+  std::vector<CDImageHasher::Hash> track_hashes;
+  const bool calculate_hash_success = CDImageHasher::GetTrackHashes(image.get(), &track_hashes, &progress_callback);
+  if (calculate_hash_success)
   {
-    progress_callback.SetProgressValue(track - 1);
-    progress_callback.PushState();
-
-    CDImageHasher::Hash hash;
-    if (!CDImageHasher::GetTrackHash(image.get(), track, &hash, &progress_callback))
+    for (u32 i = 0; i < static_cast<u32>(track_hashes.size()); i++)
     {
-      progress_callback.PopState();
-      calculate_hash_success = false;
-      break;
+      QTableWidgetItem* item = m_ui.tracks->item(static_cast<int>(i), 4);
+      item->setText(QString::fromStdString(CDImageHasher::HashToString(track_hashes[i])));
     }
-    track_hashes.emplace_back(hash);
-
-    QTableWidgetItem* item = m_ui.tracks->item(track - 1, 4);
-    item->setText(QString::fromStdString(CDImageHasher::HashToString(hash)));
-
-    progress_callback.PopState();
   }
 
   // Verify hashes against gamedb
@@ -259,7 +245,6 @@ void GameSummaryWidget::onComputeHashClicked()
     m_redump_search_keyword = CDImageHasher::HashToString(track_hashes.front());
 
     progress_callback.SetStatusText("Verifying hashes...");
-    progress_callback.SetProgressValue(image->GetTrackCount());
 
     // Verification strategy used:
     // 1. First, find all matches for the data track
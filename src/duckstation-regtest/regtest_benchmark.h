@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "common/types.h"
+
+namespace RegTestBenchmark {
+
+/// Runs synthetic R3000A kernels through each CPU execution mode for the specified number of frames, and logs the
+/// guest MIPS and block compilation statistics. Does not require a BIOS or disc image.
+bool RunCPUBenchmark(u32 frames);
+
+/// Decodes a synthetic stream of macroblocks through the MDEC, one 320x240 movie frame's worth per frame, and logs
+/// the time taken per macroblock for each output depth and decoder routine.
+bool RunMDECBenchmark(u32 frames);
+
+/// Decodes and resamples a synthetic stream of XA-ADPCM sectors, one second of double speed audio per frame, and logs
+/// the time taken per sector for each sample format.
+bool RunXABenchmark(u32 frames);
+
+/// Saves and loads states of the running system, advancing a frame between each, and logs the p50/p99 times and the
+/// size. Covers memory states as rewind and runahead use, with a per-marker breakdown, and full save states with each
+/// compression method. Requires a booted system.
+bool RunStateBenchmark(u32 iterations);
+
+} // namespace RegTestBenchmark
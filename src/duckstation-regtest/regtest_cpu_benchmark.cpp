@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "common/log.h"
+#include "common/timer.h"
+#include "core/bus.h"
+#include "core/cpu_code_cache.h"
+#include "core/cpu_core.h"
+#include "core/settings.h"
+#include "core/system.h"
+#include "core/timing_event.h"
+#include "regtest_benchmark.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+Log_SetChannel(RegTestBenchmark);
+
+namespace RegTestBenchmark {
+
+using CPU::Reg;
+
+// Kernels are loaded into KSEG0 RAM, with their data following.
+static constexpr u32 KERNEL_BASE = 0x80010000;
+static constexpr u32 SMC_TARGET_ADDRESS = 0x80020000;
+static constexpr u32 DATA_BASE = 0x80100000;
+static constexpr TickCount FRAME_TICKS = System::MASTER_CLOCK / 60;
+
+/// Minimal MIPS assembler for building the kernels.
+class CodeWriter
+{
+public:
+  explicit CodeWriter(u32 base) : m_base(base) {}
+
+  u32 GetCurrentAddress() const { return m_base + static_cast<u32>(m_code.size() * sizeof(u32)); }
+  const std::vector<u32>& GetCode() const { return m_code; }
+
+  void Emit(u32 bits) { m_code.push_back(bits); }
+
+  void RType(u32 funct, Reg rd, Reg rs, Reg rt, u32 sa = 0)
+  {
+    Emit((R(rs) << 21) | (R(rt) << 16) | (R(rd) << 11) | ((sa & 0x1F) << 6) | funct);
+  }
+  void IType(u32 op, Reg rt, Reg rs, u32 imm) { Emit((op << 26) | (R(rs) << 21) | (R(rt) << 16) | (imm & 0xFFFF)); }
+
+  void nop() { Emit(0); }
+  void sll(Reg rd, Reg rt, u32 sa) { RType(0x00, rd, Reg::zero, rt, sa); }
+  void sra(Reg rd, Reg rt, u32 sa) { RType(0x03, rd, Reg::zero, rt, sa); }
+  void jr(Reg rs) { RType(0x08, Reg::zero, rs, Reg::zero); }
+  void addu(Reg rd, Reg rs, Reg rt) { RType(0x21, rd, rs, rt); }
+  void subu(Reg rd, Reg rs, Reg rt) { RType(0x23, rd, rs, rt); }
+  void and_(Reg rd, Reg rs, Reg rt) { RType(0x24, rd, rs, rt); }
+  void or_(Reg rd, Reg rs, Reg rt) { RType(0x25, rd, rs, rt); }
+  void xor_(Reg rd, Reg rs, Reg rt) { RType(0x26, rd, rs, rt); }
+  void nor(Reg rd, Reg rs, Reg rt) { RType(0x27, rd, rs, rt); }
+  void slt(Reg rd, Reg rs, Reg rt) { RType(0x2A, rd, rs, rt); }
+  void sltu(Reg rd, Reg rs, Reg rt) { RType(0x2B, rd, rs, rt); }
+
+  void addiu(Reg rt, Reg rs, s16 imm) { IType(0x09, rt, rs, static_cast<u16>(imm)); }
+  void andi(Reg rt, Reg rs, u16 imm) { IType(0x0C, rt, rs, imm); }
+  void ori(Reg rt, Reg rs, u16 imm) { IType(0x0D, rt, rs, imm); }
+  void lui(Reg rt, u16 imm) { IType(0x0F, rt, Reg::zero, imm); }
+  void lw(Reg rt, s16 offset, Reg base) { IType(0x23, rt, base, static_cast<u16>(offset)); }
+  void sw(Reg rt, s16 offset, Reg base) { IType(0x2B, rt, base, static_cast<u16>(offset)); }
+
+  void li(Reg rt, u32 value)
+  {
+    lui(rt, static_cast<u16>(value >> 16));
+    ori(rt, rt, static_cast<u16>(value));
+  }
+
+  void b(u32 target) { IType(0x04, Reg::zero, Reg::zero, BranchOffset(target)); }
+  void jal(u32 target) { Emit((0x03u << 26) | ((target >> 2) & 0x3FFFFFF)); }
+
+  void mtc0(Reg rt, u32 rd) { Emit(0x40800000u | (R(rt) << 16) | (rd << 11)); }
+  void mfc2(Reg rt, u32 rd) { Emit(0x48000000u | (R(rt) << 16) | (rd << 11)); }
+  void mtc2(Reg rt, u32 rd) { Emit(0x48800000u | (R(rt) << 16) | (rd << 11)); }
+  void ctc2(Reg rt, u32 rd) { Emit(0x48C00000u | (R(rt) << 16) | (rd << 11)); }
+  void cop2(u32 command) { Emit(0x4A000000u | command); }
+
+private:
+  static u32 R(Reg reg) { return static_cast<u32>(reg); }
+  u32 BranchOffset(u32 target) const { return ((target - (GetCurrentAddress() + 4)) >> 2) & 0xFFFF; }
+
+  u32 m_base;
+  std::vector<u32> m_code;
+};
+
+struct Kernel
+{
+  const char* name;
+
+  /// Builds the kernel at KERNEL_BASE. Each iteration increments s0, and returns the instructions per iteration.
+  u32 (*build)(CodeWriter& cw);
+};
+
+// Dependent integer arithmetic, with no memory accesses.
+static u32 BuildALUKernel(CodeWriter& cw)
+{
+  cw.li(Reg::t0, 0x12345678);
+  cw.li(Reg::t1, 0x9ABCDEF0);
+
+  const u32 loop = cw.GetCurrentAddress();
+  cw.addu(Reg::t2, Reg::t0, Reg::t1);
+  cw.xor_(Reg::t3, Reg::t2, Reg::t0);
+  cw.sll(Reg::t4, Reg::t3, 3);
+  cw.subu(Reg::t5, Reg::t4, Reg::t1);
+  cw.or_(Reg::t6, Reg::t5, Reg::t2);
+  cw.sra(Reg::t7, Reg::t6, 2);
+  cw.slt(Reg::t8, Reg::t7, Reg::t6);
+  cw.sltu(Reg::t9, Reg::t6, Reg::t7);
+  cw.and_(Reg::a0, Reg::t7, Reg::t3);
+  cw.nor(Reg::a1, Reg::a0, Reg::t8);
+  cw.addiu(Reg::t0, Reg::a1, 0x1357);
+  cw.addu(Reg::t1, Reg::t1, Reg::t9);
+  cw.addiu(Reg::s0, Reg::s0, 1);
+  cw.b(loop);
+  cw.nop();
+  return 15;
+}
+
+// Streams through a 16KB buffer, loading pairs of words and storing their sum.
+static u32 BuildLoadStoreKernel(CodeWriter& cw)
+{
+  cw.li(Reg::a2, DATA_BASE);
+  cw.addu(Reg::a0, Reg::a2, Reg::zero);
+  cw.addu(Reg::a1, Reg::zero, Reg::zero);
+
+  const u32 loop = cw.GetCurrentAddress();
+  cw.lw(Reg::t0, 0, Reg::a0);
+  cw.lw(Reg::t1, 4, Reg::a0);
+  cw.addiu(Reg::s0, Reg::s0, 1);
+  cw.addu(Reg::t2, Reg::t0, Reg::t1);
+  cw.sw(Reg::t2, 0, Reg::a0);
+  cw.addiu(Reg::a1, Reg::a1, 8);
+  cw.andi(Reg::a1, Reg::a1, 0x3FF8);
+  cw.addu(Reg::a0, Reg::a2, Reg::a1);
+  cw.b(loop);
+  cw.xor_(Reg::t3, Reg::t3, Reg::t2);
+  return 10;
+}
+
+// Perspective transforms of a triangle, with backface and average Z calculation.
+static u32 BuildGTEKernel(CodeWriter& cw)
+{
+  static constexpr u32 control_regs[][2] = {
+    {0, 0x00001000},  // R11R12
+    {1, 0x00000000},  // R13R21
+    {2, 0x00001000},  // R22R23
+    {3, 0x00000000},  // R31R32
+    {4, 0x00001000},  // R33
+    {5, 0x00000000},  // TRX
+    {6, 0x00000000},  // TRY
+    {7, 0x00001000},  // TRZ
+    {24, 160 << 16},  // OFX
+    {25, 120 << 16},  // OFY
+    {26, 200},        // H
+    {27, 0xFFFFEF9E}, // DQA
+    {28, 0x01400000}, // DQB
+    {29, 0x155},      // ZSF3
+    {30, 0x100},      // ZSF4
+  };
+  for (const auto& [reg, value] : control_regs)
+  {
+    cw.li(Reg::at, value);
+    cw.ctc2(Reg::at, reg);
+  }
+
+  cw.li(Reg::t0, 0x00400020); // VXY0
+  cw.li(Reg::t1, 0x00000100); // VZ
+  cw.li(Reg::t2, 0xFFC00040); // VXY1
+  cw.li(Reg::t3, 0x0010FFA0); // VXY2
+
+  const u32 loop = cw.GetCurrentAddress();
+  cw.mtc2(Reg::t0, 0);
+  cw.mtc2(Reg::t1, 1);
+  cw.mtc2(Reg::t2, 2);
+  cw.mtc2(Reg::t1, 3);
+  cw.mtc2(Reg::t3, 4);
+  cw.mtc2(Reg::t1, 5);
+  cw.addiu(Reg::t0, Reg::t0, 0x11);
+  cw.addiu(Reg::t2, Reg::t2, 0x13);
+  cw.cop2(0x0280030); // RTPT
+  cw.cop2(0x1400006); // NCLIP
+  cw.cop2(0x158002D); // AVSZ3
+  cw.mfc2(Reg::t4, 24);
+  cw.mfc2(Reg::t5, 7);
+  cw.addiu(Reg::s0, Reg::s0, 1);
+  cw.addu(Reg::t6, Reg::t6, Reg::t4);
+  cw.addu(Reg::t6, Reg::t6, Reg::t5);
+  cw.b(loop);
+  cw.nop();
+  return 18;
+}
+
+// Patches the immediate of an instruction in a subroutine before every call, forcing invalidation.
+static u32 BuildSMCKernel(CodeWriter& cw)
+{
+  cw.li(Reg::a3, SMC_TARGET_ADDRESS);
+  cw.lui(Reg::t2, 0x2442); // addiu v0, v0, 0
+
+  const u32 loop = cw.GetCurrentAddress();
+  cw.andi(Reg::t1, Reg::s0, 0xFF);
+  cw.or_(Reg::t0, Reg::t2, Reg::t1);
+  cw.sw(Reg::t0, 0, Reg::a3);
+  cw.jal(SMC_TARGET_ADDRESS);
+  cw.addiu(Reg::s0, Reg::s0, 1);
+  cw.b(loop);
+  cw.nop();
+
+  // 7 in the loop, 3 in the subroutine
+  return 10;
+}
+
+static constexpr Kernel s_kernels[] = {
+  {"ALU", BuildALUKernel},
+  {"LoadStore", BuildLoadStoreKernel},
+  {"GTE", BuildGTEKernel},
+  {"SMC", BuildSMCKernel},
+};
+
+static void WriteRAM(u32 address, const std::vector<u32>& words)
+{
+  std::memcpy(&Bus::g_ram[address & Bus::g_ram_mask], words.data(), words.size() * sizeof(u32));
+}
+
+static void LoadKernel(const Kernel& kernel, u32* instructions_per_iteration)
+{
+  // Enable the GTE and jump to the kernel from the reset vector.
+  CodeWriter stub(0xBFC00000);
+  stub.lui(Reg::t0, 0x4000);
+  stub.mtc0(Reg::t0, 12);
+  stub.li(Reg::t0, KERNEL_BASE);
+  stub.jr(Reg::t0);
+  stub.nop();
+  std::memcpy(Bus::g_bios, stub.GetCode().data(), stub.GetCode().size() * sizeof(u32));
+
+  CodeWriter cw(KERNEL_BASE);
+  *instructions_per_iteration = kernel.build(cw);
+  WriteRAM(KERNEL_BASE, cw.GetCode());
+
+  CodeWriter target(SMC_TARGET_ADDRESS);
+  target.addiu(Reg::v0, Reg::v0, 0);
+  target.jr(Reg::ra);
+  target.nop();
+  WriteRAM(SMC_TARGET_ADDRESS, target.GetCode());
+}
+
+static void FrameEventCallback(void*, TickCount, TickCount)
+{
+  System::FrameDone();
+}
+
+static bool RunKernel(const Kernel& kernel, CPUExecutionMode mode, u32 frames)
+{
+  g_settings.cpu_execution_mode = mode;
+
+  TimingEvents::Initialize();
+  CPU::Initialize();
+  if (!Bus::Initialize())
+  {
+    CPU::Shutdown();
+    TimingEvents::Shutdown();
+    return false;
+  }
+
+  CPU::CodeCache::Initialize();
+
+  u32 instructions_per_iteration;
+  LoadKernel(kernel, &instructions_per_iteration);
+  CPU::Reset();
+  CPU::CodeCache::ResetCompileStatistics();
+
+  std::unique_ptr<TimingEvent> frame_event =
+    TimingEvents::CreateTimingEvent("Benchmark Frame", FRAME_TICKS, FRAME_TICKS, FrameEventCallback, nullptr, true);
+
+  Common::Timer timer;
+  for (u32 frame = 0; frame < frames; frame++)
+  {
+    switch (mode)
+    {
+#ifdef WITH_RECOMPILER
+      case CPUExecutionMode::Recompiler:
+        CPU::CodeCache::ExecuteRecompiler();
+        break;
+#endif
+
+      case CPUExecutionMode::CachedInterpreter:
+        CPU::CodeCache::Execute();
+        break;
+
+      default:
+        CPU::Execute();
+        break;
+    }
+  }
+  const double seconds = timer.GetTimeSeconds();
+
+  const u64 instructions = static_cast<u64>(CPU::g_state.regs.s0) * instructions_per_iteration;
+  const CPU::CodeCache::CompileStatistics& stats = CPU::CodeCache::GetCompileStatistics();
+  const u32 blocks = std::max<u32>(stats.blocks_compiled, 1);
+  Log_InfoPrintf("%-10s %-18s %9.2f MIPS  %6u blocks  %8.2f us/block  %8.1f host bytes/block", kernel.name,
+                 Settings::GetCPUExecutionModeName(mode),
+                 static_cast<double>(instructions) / seconds / 1000000.0, stats.blocks_compiled,
+                 Common::Timer::ConvertValueToNanoseconds(stats.compile_time) / 1000.0 / blocks,
+                 static_cast<double>(stats.host_code_bytes) / blocks);
+
+  frame_event.reset();
+  CPU::CodeCache::Shutdown();
+  CPU::Shutdown();
+  Bus::Shutdown();
+  TimingEvents::Shutdown();
+  return true;
+}
+
+bool RunCPUBenchmark(u32 frames)
+{
+  static constexpr CPUExecutionMode modes[] = {
+    CPUExecutionMode::Interpreter,
+    CPUExecutionMode::CachedInterpreter,
+#ifdef WITH_RECOMPILER
+    CPUExecutionMode::Recompiler,
+#endif
+  };
+
+  Log_InfoPrintf("Running CPU benchmark for %u frames per kernel...", frames);
+
+  const Settings old_settings(g_settings);
+  bool result = true;
+  for (const Kernel& kernel : s_kernels)
+  {
+    for (const CPUExecutionMode mode : modes)
+    {
+      if (!RunKernel(kernel, mode, frames))
+      {
+        Log_ErrorPrintf("Failed to run %s kernel with %s.", kernel.name, Settings::GetCPUExecutionModeName(mode));
+        result = false;
+        break;
+      }
+    }
+  }
+
+  g_settings = old_settings;
+  return result;
+}
+
+} // namespace RegTestBenchmark
@@ -15,7 +15,9 @@
 #include "frontend-common/common_host.h"
 #include "frontend-common/game_list.h"
 #include "frontend-common/input_manager.h"
+#include "regtest_benchmark.h"
 #include "regtest_host_display.h"
+#include "regtest_state_check.h"
 #include "scmversion/scmversion.h"
 #include <csignal>
 #include <cstdio>
@@ -40,6 +42,12 @@ static std::string GetFrameDumpFilename(u32 frame);
 static std::unique_ptr<MemorySettingsInterface> s_base_settings_interface;
 
 static u32 s_frames_to_run = 60 * 60;
+static bool s_frames_to_run_specified = false;
+static std::string s_benchmark_to_run;
+static bool s_check_states = false;
+
+// Memory state saves/loads are quick, so plenty are needed for a stable average.
+static constexpr u32 STATE_BENCHMARK_ITERATIONS = 300;
 static u32 s_frame_dump_interval = 0;
 static std::string s_dump_base_directory;
 static std::string s_dump_game_directory;
@@ -229,6 +237,11 @@ void Host::OnPerformanceCountersUpdated()
   //
 }
 
+void Host::OnNetplayMessage(std::string& message)
+{
+  Log_InfoPrintf("Netplay: %s", message.c_str());
+}
+
 void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name)
 {
   Log_InfoPrintf("Disc Path: %s", disc_path.c_str());
@@ -419,6 +432,10 @@ void RegTestHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -frames: Sets the number of frames to execute.\n");
   std::fprintf(stderr, "  -log <level>: Sets the log level. Defaults to verbose.\n");
   std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Default to software.\n");
+  std::fprintf(stderr, "  -benchmark <name>: Runs a benchmark instead of booting. Available: cpu, mdec, xa.\n");
+  std::fprintf(stderr, "    The state benchmark runs after booting and executing the requested frames.\n");
+  std::fprintf(stderr, "  -checkstates: Checks memory states round trip after every frame, and that frames\n"
+                       "    replayed from them match. Stops at the first mismatch.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
                        "    spaces or starts with a dash.\n");
@@ -484,6 +501,24 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
           return false;
         }
 
+        s_frames_to_run_specified = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-benchmark"))
+      {
+        s_benchmark_to_run = argv[++i];
+        if (s_benchmark_to_run != "cpu" && s_benchmark_to_run != "mdec" && s_benchmark_to_run != "xa" &&
+            s_benchmark_to_run != "state")
+        {
+          Log_ErrorPrintf("Invalid benchmark specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG("-checkstates"))
+      {
+        s_check_states = true;
         continue;
       }
       else if (CHECK_ARG_PARAM("-log"))
@@ -549,6 +584,20 @@ int main(int argc, char* argv[])
   if (!RegTestHost::ParseCommandLineParameters(argc, argv, autoboot))
     return EXIT_FAILURE;
 
+  if (!s_benchmark_to_run.empty() && s_benchmark_to_run != "state")
+  {
+    // synthetic workloads are short, so don't run for the default regression test length
+    const u32 frames = s_frames_to_run_specified ? s_frames_to_run : 300;
+    bool benchmark_result;
+    if (s_benchmark_to_run == "mdec")
+      benchmark_result = RegTestBenchmark::RunMDECBenchmark(frames);
+    else if (s_benchmark_to_run == "xa")
+      benchmark_result = RegTestBenchmark::RunXABenchmark(frames);
+    else
+      benchmark_result = RegTestBenchmark::RunCPUBenchmark(frames);
+    return benchmark_result ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   if (!autoboot || autoboot->filename.empty())
   {
     Log_ErrorPrintf("No boot path specified.");
@@ -576,13 +625,30 @@ int main(int argc, char* argv[])
     Log_InfoPrintf("Dumping every %dth frame to '%s'.", s_frame_dump_interval, s_dump_base_directory.c_str());
   }
 
-  Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
+  if (s_check_states)
+  {
+    if (!RegTestStateCheck::Run(s_frames_to_run))
+    {
+      System::ShutdownSystem(false);
+      goto cleanup;
+    }
+  }
+  else
+  {
+    Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
+
+    for (u32 frame = 0; frame < s_frames_to_run; frame++)
+    {
+      System::RunFrame();
+      Host::RenderDisplay(false);
+      System::UpdatePerformanceCounters();
+    }
+  }
 
-  for (u32 frame = 0; frame < s_frames_to_run; frame++)
+  if (s_benchmark_to_run == "state" && !RegTestBenchmark::RunStateBenchmark(STATE_BENCHMARK_ITERATIONS))
   {
-    System::RunFrame();
-    Host::RenderDisplay(false);
-    System::UpdatePerformanceCounters();
+    System::ShutdownSystem(false);
+    goto cleanup;
   }
 
   Log_InfoPrintf("All done, shutting down system.");
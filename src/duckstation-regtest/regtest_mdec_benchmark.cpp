@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "common/log.h"
+#include "common/timer.h"
+#include "core/cpu_core.h"
+#include "core/mdec.h"
+#include "core/settings.h"
+#include "core/timing_event.h"
+#include "regtest_benchmark.h"
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+Log_SetChannel(RegTestBenchmark);
+
+namespace RegTestBenchmark {
+
+// A 320x240 movie frame is 20x15 macroblocks.
+static constexpr u32 MACROBLOCKS_PER_FRAME = (320 / 16) * (240 / 16);
+
+// Enough distinct macroblocks that the decoder isn't just seeing the same data.
+static constexpr u32 NUM_SYNTHETIC_MACROBLOCKS = 64;
+
+// Long enough for the six block copy-out delay.
+static constexpr TickCount MACROBLOCK_TICKS = 448 * 6;
+
+static constexpr u32 MDEC_DATA_REGISTER = 0;
+static constexpr u32 MDEC_STATUS_REGISTER = 4;
+static constexpr u32 MDEC_STATUS_DATA_OUT_FIFO_EMPTY = (1u << 31);
+
+enum : u32
+{
+  MDEC_COMMAND_DECODE_MACROBLOCK = 1u << 29,
+  MDEC_COMMAND_SET_IQ_TABLE = 2u << 29,
+  MDEC_COMMAND_SET_SCALE_TABLE = 3u << 29,
+  MDEC_DEPTH_24BIT = 2u << 27,
+  MDEC_DEPTH_15BIT = 3u << 27,
+};
+
+static void WriteHalfwords(const std::vector<u16>& halfwords)
+{
+  for (size_t i = 0; i < halfwords.size(); i += 2)
+    MDEC::WriteRegister(MDEC_DATA_REGISTER, ZeroExtend32(halfwords[i]) | (ZeroExtend32(halfwords[i + 1]) << 16));
+}
+
+static void UploadTables()
+{
+  // Quantization tables for both luma and chroma.
+  std::vector<u16> iq;
+  for (u32 i = 0; i < 64; i += 2)
+    iq.push_back(static_cast<u16>((2 + i / 4) | ((2 + (i + 1) / 4) << 8)));
+  MDEC::WriteRegister(MDEC_DATA_REGISTER, MDEC_COMMAND_SET_IQ_TABLE | 1u);
+  WriteHalfwords(iq);
+  WriteHalfwords(iq);
+
+  // Standard DCT basis, as used by the BIOS.
+  std::vector<u16> scale;
+  for (u32 u = 0; u < 8; u++)
+  {
+    const double cu = (u == 0) ? (1.0 / std::sqrt(2.0)) : 1.0;
+    for (u32 x = 0; x < 8; x++)
+    {
+      const double value = 32768.0 * cu * std::cos((2.0 * x + 1.0) * u * 3.14159265358979323846 / 16.0);
+      scale.push_back(static_cast<u16>(static_cast<s16>(std::clamp(std::lround(value), -32768l, 32767l))));
+    }
+  }
+  MDEC::WriteRegister(MDEC_DATA_REGISTER, MDEC_COMMAND_SET_SCALE_TABLE);
+  WriteHalfwords(scale);
+}
+
+static std::vector<u16> BuildMacroblock(std::mt19937& rng)
+{
+  // Six blocks of run-length coded coefficients: a DC term with the quantization scale, a handful of AC terms with
+  // short runs, then the end-of-block marker.
+  std::vector<u16> data;
+  for (u32 block = 0; block < 6; block++)
+  {
+    const u32 q_scale = 1 + (rng() % 8);
+    data.push_back(static_cast<u16>((q_scale << 10) | (rng() & 0x3FF)));
+
+    u32 coefficient = 0;
+    const u32 num_ac = 4 + (rng() % 12);
+    for (u32 i = 0; i < num_ac; i++)
+    {
+      const u32 run = rng() % 4;
+      if ((coefficient + run + 1) >= 63)
+        break;
+
+      coefficient += run + 1;
+      const s32 level = static_cast<s32>(rng() % 64) - 32;
+      data.push_back(static_cast<u16>((run << 10) | (static_cast<u32>(level) & 0x3FF)));
+    }
+
+    data.push_back(0xFE00);
+  }
+
+  // Parameters are transferred in words.
+  if (data.size() % 2)
+    data.push_back(0xFE00);
+
+  return data;
+}
+
+static u32 DecodeMacroblock(const std::vector<u16>& data, u32 depth)
+{
+  MDEC::WriteRegister(MDEC_DATA_REGISTER, MDEC_COMMAND_DECODE_MACROBLOCK | depth |
+                                            static_cast<u32>(data.size() / 2));
+  WriteHalfwords(data);
+
+  // Let the copy-out event fire, then drain the output.
+  CPU::AddPendingTicks(MACROBLOCK_TICKS);
+  TimingEvents::RunEvents();
+
+  u32 words = 0;
+  while (!(MDEC::ReadRegister(MDEC_STATUS_REGISTER) & MDEC_STATUS_DATA_OUT_FIFO_EMPTY))
+  {
+    MDEC::ReadRegister(MDEC_DATA_REGISTER);
+    words++;
+  }
+
+  return words;
+}
+
+static bool RunDecode(const std::vector<std::vector<u16>>& macroblocks, bool old_routines, u32 depth, u32 frames)
+{
+  g_settings.use_old_mdec_routines = old_routines;
+
+  TimingEvents::Initialize();
+  CPU::Initialize();
+  MDEC::Initialize();
+  UploadTables();
+
+  // The event queue can't run empty, so keep something scheduled beyond the copy-out.
+  std::unique_ptr<TimingEvent> idle_event = TimingEvents::CreateTimingEvent(
+    "Benchmark Idle", MACROBLOCK_TICKS * 1000, MACROBLOCK_TICKS * 1000, [](void*, TickCount, TickCount) {}, nullptr,
+    true);
+
+  const u32 total_macroblocks = frames * MACROBLOCKS_PER_FRAME;
+  const u32 expected_words = (depth == MDEC_DEPTH_24BIT) ? (256 * 3 / 4) : (256 / 2);
+  bool result = true;
+
+  Common::Timer timer;
+  for (u32 i = 0; i < total_macroblocks; i++)
+  {
+    if (DecodeMacroblock(macroblocks[i % macroblocks.size()], depth) != expected_words)
+    {
+      Log_ErrorPrintf("Macroblock %u did not produce %u words of output.", i, expected_words);
+      result = false;
+      break;
+    }
+  }
+  const double seconds = timer.GetTimeSeconds();
+
+  if (result)
+  {
+    Log_InfoPrintf("%-8s %-6s %9.3f us/macroblock  %8.1f frames/sec", old_routines ? "Old" : "New",
+                   (depth == MDEC_DEPTH_24BIT) ? "24-bit" : "15-bit", seconds * 1000000.0 / total_macroblocks,
+                   frames / seconds);
+  }
+
+  idle_event.reset();
+  MDEC::Shutdown();
+  CPU::Shutdown();
+  TimingEvents::Shutdown();
+  return result;
+}
+
+bool RunMDECBenchmark(u32 frames)
+{
+  Log_InfoPrintf("Running MDEC benchmark for %u frames of %u macroblocks...", frames, MACROBLOCKS_PER_FRAME);
+
+  std::mt19937 rng(0x4D444543);
+  std::vector<std::vector<u16>> macroblocks;
+  macroblocks.reserve(NUM_SYNTHETIC_MACROBLOCKS);
+  for (u32 i = 0; i < NUM_SYNTHETIC_MACROBLOCKS; i++)
+    macroblocks.push_back(BuildMacroblock(rng));
+
+  const Settings old_settings(g_settings);
+  bool result = true;
+  for (const bool old_routines : {false, true})
+  {
+    for (const u32 depth : {MDEC_DEPTH_15BIT, MDEC_DEPTH_24BIT})
+      result = result && RunDecode(macroblocks, old_routines, depth, frames);
+  }
+
+  g_settings = old_settings;
+  return result;
+}
+
+} // namespace RegTestBenchmark
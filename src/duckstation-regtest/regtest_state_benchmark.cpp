@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "common/byte_stream.h"
+#include "common/gpu_texture.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "core/save_state_version.h"
+#include "core/system.h"
+#include "regtest_benchmark.h"
+#include "util/state_wrapper.h"
+#include <algorithm>
+#include <vector>
+Log_SetChannel(RegTestBenchmark);
+
+namespace RegTestBenchmark {
+
+static double GetPercentile(std::vector<double> values, double percentile)
+{
+  if (values.empty())
+    return 0.0;
+
+  std::sort(values.begin(), values.end());
+  const size_t index = static_cast<size_t>(percentile * static_cast<double>(values.size() - 1) + 0.5);
+  return values[std::min(index, values.size() - 1)];
+}
+
+static void LogTimings(const char* name, u32 size, const std::vector<double>& save_times,
+                       const std::vector<double>& load_times)
+{
+  Log_InfoPrintf("%s: %u bytes, save p50 %.4f ms p99 %.4f ms, load p50 %.4f ms p99 %.4f ms", name, size,
+                 GetPercentile(save_times, 0.5), GetPercentile(save_times, 0.99), GetPercentile(load_times, 0.5),
+                 GetPercentile(load_times, 0.99));
+}
+
+static void LogMarkerBreakdown(const std::vector<StateMarkerPosition>& save_markers, u64 save_end_time, u32 size,
+                               const std::vector<StateMarkerPosition>& load_markers, u64 load_end_time)
+{
+  // Load should pass the same markers in the same order, if not only the save side can be shown.
+  const bool has_load = (load_markers.size() == save_markers.size());
+  for (size_t i = 0; i < save_markers.size(); i++)
+  {
+    const bool last = (i + 1 == save_markers.size());
+    const u64 bytes = (last ? size : save_markers[i + 1].position) - save_markers[i].position;
+    const u64 save_ticks = (last ? save_end_time : save_markers[i + 1].time) - save_markers[i].time;
+    const u64 load_ticks = has_load ? ((last ? load_end_time : load_markers[i + 1].time) - load_markers[i].time) : 0;
+    const double save_ms = Common::Timer::ConvertValueToMilliseconds(save_ticks);
+    const double load_ms = Common::Timer::ConvertValueToMilliseconds(load_ticks);
+
+    Log_InfoPrintf("  %-20s %9u bytes, save %.4f ms, load %.4f ms", save_markers[i].name, static_cast<u32>(bytes),
+                   save_ms, load_ms);
+  }
+}
+
+static bool RunMemoryStateBenchmark(u32 iterations)
+{
+  MemorySaveState mss;
+  std::vector<double> save_times, load_times;
+  save_times.reserve(iterations);
+  load_times.reserve(iterations);
+
+  for (u32 i = 0; i < iterations; i++)
+  {
+    // advance between iterations, so the state isn't identical every time
+    System::RunFrame();
+
+    Common::Timer timer;
+    if (!System::SaveMemoryState(&mss))
+    {
+      Log_ErrorPrintf("Failed to save memory state on iteration %u.", i);
+      return false;
+    }
+    save_times.push_back(timer.GetTimeMilliseconds());
+
+    timer.Reset();
+    if (!System::LoadMemoryState(mss))
+    {
+      Log_ErrorPrintf("Failed to load memory state on iteration %u.", i);
+      return false;
+    }
+    load_times.push_back(timer.GetTimeMilliseconds());
+  }
+
+  const u32 size = static_cast<u32>(mss.state_stream->GetSize());
+  LogTimings("Memory state", size, save_times, load_times);
+
+  // one more round with the markers recorded, for the per-subsystem breakdown
+  std::vector<StateMarkerPosition> save_markers, load_markers;
+  if (!System::SaveMemoryState(&mss, &save_markers))
+    return false;
+  const u64 save_end_time = Common::Timer::GetCurrentValue();
+  if (!System::LoadMemoryState(mss, &load_markers))
+    return false;
+  const u64 load_end_time = Common::Timer::GetCurrentValue();
+
+  LogMarkerBreakdown(save_markers, save_end_time, static_cast<u32>(mss.state_stream->GetSize()), load_markers,
+                     load_end_time);
+  return true;
+}
+
+static bool RunFileStateBenchmark(u32 iterations, u32 compression_method, const char* name)
+{
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream::CreateGrowableMemoryStream();
+  std::vector<double> save_times, load_times;
+  save_times.reserve(iterations);
+  load_times.reserve(iterations);
+
+  for (u32 i = 0; i < iterations; i++)
+  {
+    System::RunFrame();
+
+    stream->SeekAbsolute(0);
+    stream->Resize(0);
+
+    Common::Timer timer;
+    if (!System::SaveStateToStream(stream.get(), compression_method))
+    {
+      Log_ErrorPrintf("Failed to save %s on iteration %u.", name, i);
+      return false;
+    }
+    save_times.push_back(timer.GetTimeMilliseconds());
+
+    stream->SeekAbsolute(0);
+    timer.Reset();
+    if (!System::LoadStateFromStream(stream.get()))
+    {
+      Log_ErrorPrintf("Failed to load %s on iteration %u.", name, i);
+      return false;
+    }
+    load_times.push_back(timer.GetTimeMilliseconds());
+  }
+
+  LogTimings(name, static_cast<u32>(stream->GetSize()), save_times, load_times);
+  return true;
+}
+
+bool RunStateBenchmark(u32 iterations)
+{
+  if (!System::IsValid())
+  {
+    Log_ErrorPrint("The state benchmark needs a running system.");
+    return false;
+  }
+
+  Log_InfoPrintf("Running state benchmark for %u save/load iterations...", iterations);
+
+  return (RunMemoryStateBenchmark(iterations) &&
+          RunFileStateBenchmark(iterations, SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE, "File state (none)") &&
+          RunFileStateBenchmark(iterations, SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD, "File state (zstd)") &&
+          RunFileStateBenchmark(iterations, SAVE_STATE_HEADER::COMPRESSION_TYPE_SECTIONED_ZSTD,
+                                "File state (sectioned zstd)"));
+}
+
+} // namespace RegTestBenchmark
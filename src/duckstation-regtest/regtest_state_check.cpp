@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "regtest_state_check.h"
+#include "common/byte_stream.h"
+#include "common/log.h"
+#include "core/gpu.h"
+#include "core/host_display.h"
+#include "core/system.h"
+#include "util/state_wrapper.h"
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+Log_SetChannel(RegTestStateCheck);
+
+namespace RegTestStateCheck {
+
+struct SavedFrame
+{
+  MemorySaveState state;
+  std::vector<StateMarkerPosition> markers;
+  u32 frame_number = 0;
+};
+
+static bool SaveState(MemorySaveState* mss, std::vector<StateMarkerPosition>* markers)
+{
+  if (markers)
+    markers->clear();
+
+  if (!System::SaveMemoryState(mss, markers))
+  {
+    Log_ErrorPrintf("Failed to save memory state at frame %u.", System::GetFrameNumber());
+    return false;
+  }
+
+  // the software renderer copies VRAM in on its own thread
+  g_gpu->WaitForVRAMCopies(mss->vram_copy_fence);
+  return true;
+}
+
+static bool CompareStates(const char* what, const SavedFrame& expected, const MemorySaveState& actual)
+{
+  const u32 expected_size = static_cast<u32>(expected.state.state_stream->GetSize());
+  const u32 actual_size = static_cast<u32>(actual.state_stream->GetSize());
+  const u8* expected_data = expected.state.state_stream->GetMemoryPointer();
+  const u8* actual_data = actual.state_stream->GetMemoryPointer();
+  const u32 common_size = std::min(expected_size, actual_size);
+  const u32 offset =
+    static_cast<u32>(std::mismatch(expected_data, expected_data + common_size, actual_data).first - expected_data);
+  if (offset == common_size && expected_size == actual_size)
+    return true;
+
+  // Markers are recorded in order, so the last one before the difference is the section it's in.
+  const StateMarkerPosition* section = nullptr;
+  for (const StateMarkerPosition& marker : expected.markers)
+  {
+    if (marker.position > offset)
+      break;
+
+    section = &marker;
+  }
+
+  Log_ErrorPrintf("Frame %u: %s differs in section '%s' at offset %u (+%u), sizes are %u and %u bytes.",
+                  expected.frame_number, what, section ? section->name : "(none)", offset,
+                  section ? (offset - static_cast<u32>(section->position)) : offset, expected_size, actual_size);
+  return false;
+}
+
+bool Run(u32 frames)
+{
+  Log_InfoPrintf("Running for %u frames, checking states after every frame and replays every %u frames...", frames,
+                 REPLAY_FRAMES);
+
+  // The first entry is the state the window starts from, the rest are the states after each frame in it.
+  std::array<SavedFrame, REPLAY_FRAMES + 1> window;
+  MemorySaveState check_state;
+  if (!SaveState(&window[0].state, &window[0].markers))
+    return false;
+
+  window[0].frame_number = System::GetFrameNumber();
+  u32 window_size = 1;
+
+  for (u32 i = 0; i < frames; i++)
+  {
+    System::RunFrame();
+    Host::RenderDisplay(false);
+    System::UpdatePerformanceCounters();
+
+    // Anything left out of the state shows up as a difference once it's been loaded.
+    SavedFrame& saved = window[window_size++];
+    saved.frame_number = System::GetFrameNumber();
+    if (!SaveState(&saved.state, &saved.markers) || !System::LoadMemoryState(saved.state) ||
+        !SaveState(&check_state, nullptr) || !CompareStates("state after loading", saved, check_state))
+    {
+      return false;
+    }
+
+    if (window_size < window.size())
+      continue;
+
+    // Go back to the start of the window, and run the same frames again, as rollback and rewind would.
+    if (!System::LoadMemoryState(window[0].state))
+      return false;
+
+    for (u32 j = 1; j < window_size; j++)
+    {
+      System::RunFrame();
+      if (!SaveState(&check_state, nullptr))
+        return false;
+
+      if (!CompareStates("replayed state", window[j], check_state))
+      {
+        Log_ErrorPrintf("Replay started from frame %u.", window[0].frame_number);
+        return false;
+      }
+    }
+
+    // the last frame starts the next window
+    std::swap(window[0], window[window_size - 1]);
+    window_size = 1;
+  }
+
+  Log_InfoPrint("No state mismatches found.");
+  return true;
+}
+
+} // namespace RegTestStateCheck
@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "common/types.h"
+
+namespace RegTestStateCheck {
+
+static constexpr u32 REPLAY_FRAMES = 8;
+
+/// Runs the booted system for the specified number of frames, checking that memory states are complete.
+///
+/// After every frame, saves a state, loads it and saves again, and checks the two saves are identical. Every
+/// REPLAY_FRAMES frames, goes back to the state from the start of the window and runs the frames again, checking the
+/// replayed state of each frame matches the first run. Either way, the first mismatch is logged with the state section
+/// and offset it falls in, and stops the run.
+///
+/// RAM and VRAM are compared as part of the state, so VRAM is only covered with the software renderer.
+bool Run(u32 frames);
+
+} // namespace RegTestStateCheck
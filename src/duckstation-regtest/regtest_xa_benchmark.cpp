@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "common/log.h"
+#include "common/timer.h"
+#include "regtest_benchmark.h"
+#include "util/cd_image.h"
+#include "util/cd_xa.h"
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+Log_SetChannel(RegTestBenchmark);
+
+namespace RegTestBenchmark {
+
+// One second of a double speed read, with every sector carrying audio.
+static constexpr u32 SECTORS_PER_FRAME = 150;
+
+// Enough distinct sectors that the decoder isn't just seeing the same data.
+static constexpr u32 NUM_SYNTHETIC_SECTORS = 32;
+
+static constexpr u32 XA_CHUNKS_PER_SECTOR = 18;
+static constexpr u32 XA_CHUNK_SIZE = 128;
+
+using SectorBuffer = std::array<u8, CDImage::RAW_SECTOR_SIZE>;
+
+static SectorBuffer BuildSector(std::mt19937& rng, bool stereo, bool eight_bit)
+{
+  SectorBuffer sector = {};
+  u8* subheader_ptr = &sector[CDImage::SECTOR_SYNC_SIZE + sizeof(CDImage::SectorHeader)];
+
+  CDXA::XASubHeader subheader = {};
+  subheader.submode.audio = true;
+  subheader.submode.form2 = true;
+  subheader.submode.realtime = true;
+  subheader.codinginfo.mono_stereo = stereo ? 1 : 0;
+  subheader.codinginfo.bits_per_sample = eight_bit ? 1 : 0;
+  std::memcpy(subheader_ptr, &subheader, sizeof(subheader));
+  std::memcpy(subheader_ptr + sizeof(subheader), &subheader, sizeof(subheader));
+
+  // Each chunk is 16 bytes of block headers, followed by the interleaved sample words. Headers are stored twice, and
+  // the decoder reads the second copy.
+  u8* chunk_ptr = subheader_ptr + sizeof(subheader) * 2;
+  for (u32 chunk = 0; chunk < XA_CHUNKS_PER_SECTOR; chunk++, chunk_ptr += XA_CHUNK_SIZE)
+  {
+    for (u32 i = 0; i < 8; i++)
+    {
+      const u8 header = static_cast<u8>((rng() % 13) | ((rng() % 4) << 4));
+      chunk_ptr[i] = header;
+      chunk_ptr[4 + i] = header;
+    }
+
+    for (u32 i = 16; i < XA_CHUNK_SIZE; i++)
+      chunk_ptr[i] = static_cast<u8>(rng());
+  }
+
+  return sector;
+}
+
+template<bool STEREO>
+static u32 Resample(const s16* frames_in, u32 num_frames_in, std::array<std::array<s16, 32>, 2>& ringbuf, u8& p,
+                    u8& sixstep)
+{
+  // Mirrors CDROM::ResampleXAADPCM() at the full sample rate, minus the audio FIFO.
+  u32 checksum = 0;
+  for (u32 i = 0; i < num_frames_in; i++)
+  {
+    ringbuf[0][p] = *(frames_in++);
+    if constexpr (STEREO)
+      ringbuf[1][p] = *(frames_in++);
+    p = (p + 1) % CDXA::XA_RESAMPLE_RING_BUFFER_SIZE;
+
+    if (--sixstep == 0)
+    {
+      sixstep = 6;
+
+      std::array<s16, CDXA::XA_RESAMPLE_NUM_ZIGZAG_TABLES> interp;
+      for (u32 channel = 0; channel < (STEREO ? 2 : 1); channel++)
+      {
+        CDXA::ZigZagInterpolate(ringbuf[channel].data(), p, interp.data());
+        for (const s16 sample : interp)
+          checksum = (checksum * 31) + static_cast<u16>(sample);
+      }
+    }
+  }
+
+  return checksum;
+}
+
+static void RunDecode(const std::vector<SectorBuffer>& sectors, bool stereo, bool eight_bit, u32 frames)
+{
+  const u32 total_sectors = frames * SECTORS_PER_FRAME;
+  const u32 samples_per_sector =
+    eight_bit ? CDXA::XA_ADPCM_SAMPLES_PER_SECTOR_8BIT : CDXA::XA_ADPCM_SAMPLES_PER_SECTOR_4BIT;
+  const u32 frames_per_sector = stereo ? (samples_per_sector / 2) : samples_per_sector;
+
+  std::array<s16, CDXA::XA_ADPCM_SAMPLES_PER_SECTOR_4BIT> samples;
+  std::array<s32, 4> last_samples = {};
+  std::array<std::array<s16, 32>, 2> ringbuf = {};
+  u8 p = 0;
+  u8 sixstep = 6;
+  u32 checksum = 0;
+
+  Common::Timer timer;
+  for (u32 i = 0; i < total_sectors; i++)
+    CDXA::DecodeADPCMSector(sectors[i % sectors.size()].data(), samples.data(), last_samples.data());
+  const double decode_seconds = timer.GetTimeSeconds();
+
+  timer.Reset();
+  for (u32 i = 0; i < total_sectors; i++)
+  {
+    CDXA::DecodeADPCMSector(sectors[i % sectors.size()].data(), samples.data(), last_samples.data());
+    checksum += stereo ? Resample<true>(samples.data(), frames_per_sector, ringbuf, p, sixstep) :
+                         Resample<false>(samples.data(), frames_per_sector, ringbuf, p, sixstep);
+  }
+  const double resample_seconds = timer.GetTimeSeconds() - decode_seconds;
+
+  Log_InfoPrintf("%-6s %-5s  decode %7.3f us/sector  resample %7.3f us/sector  %7.1fx realtime  checksum %08X",
+                 stereo ? "Stereo" : "Mono", eight_bit ? "8-bit" : "4-bit", decode_seconds * 1000000.0 / total_sectors,
+                 resample_seconds * 1000000.0 / total_sectors,
+                 frames / (decode_seconds + resample_seconds), checksum);
+}
+
+bool RunXABenchmark(u32 frames)
+{
+  Log_InfoPrintf("Running XA-ADPCM benchmark for %u frames of %u sectors...", frames, SECTORS_PER_FRAME);
+
+  std::mt19937 rng(0x58414450);
+  for (const bool eight_bit : {false, true})
+  {
+    for (const bool stereo : {false, true})
+    {
+      std::vector<SectorBuffer> sectors;
+      sectors.reserve(NUM_SYNTHETIC_SECTORS);
+      for (u32 i = 0; i < NUM_SYNTHETIC_SECTORS; i++)
+        sectors.push_back(BuildSector(rng, stereo, eight_bit));
+
+      RunDecode(sectors, stereo, eight_bit, frames);
+    }
+  }
+
+  return true;
+}
+
+} // namespace RegTestBenchmark
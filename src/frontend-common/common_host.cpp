@@ -114,6 +114,8 @@ void CommonHost::Initialize()
 
 void CommonHost::Shutdown()
 {
+  System::FlushSaveStates();
+
 #ifdef WITH_DISCORD_PRESENCE
   CommonHost::ShutdownDiscordPresence();
 #endif
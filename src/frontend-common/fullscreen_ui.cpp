@@ -2841,6 +2841,11 @@ void FullscreenUI::DrawConsoleSettingsPage()
     bsi, "Readahead Sectors",
     "Reduces hitches in emulation by reading/decompressing CD data asynchronously on a worker thread.", "CDROM",
     "ReadaheadSectors", Settings::DEFAULT_CDROM_READAHEAD_SECTORS, 0, 32, "%d sectors");
+  DrawIntRangeSetting(
+    bsi, "CHD Hunk Cache",
+    "Decompresses CHD images ahead of the read position on worker threads, keeping up to this much data cached.",
+    "CDROM", "CHDHunkCacheSize", Settings::DEFAULT_CDROM_CHD_HUNK_CACHE_MB, 0,
+    Settings::MAX_CDROM_CHD_HUNK_CACHE_MB, "%d MB");
 
   DrawToggleSetting(bsi, "Enable Region Check", "Simulates the region check present in original, unmodified consoles.",
                     "CDROM", "RegionCheck", false);
@@ -2905,6 +2910,9 @@ void FullscreenUI::DrawEmulationSettingsPage()
   DrawIntRangeSetting(bsi, "Rewind Save Slots",
                       "How many saves will be kept for rewinding. Higher values have greater memory requirements.",
                       "Main", "RewindSaveSlots", 10, 1, 10000, "%d Frames");
+  DrawIntRangeSetting(bsi, "Rewind Memory Budget",
+                      "How much RAM the compressed saves can use. The oldest saves are dropped when it runs out.",
+                      "Main", "RewindMemoryBudget", 256, 16, 16384, "%d MB");
 
   const s32 runahead_frames = GetEffectiveIntSetting(bsi, "Main", "RunaheadFrameCount", 0);
   const bool runahead_enabled = (runahead_frames > 0);
@@ -2918,6 +2926,15 @@ void FullscreenUI::DrawEmulationSettingsPage()
     bsi, "Runahead",
     "Simulates the system ahead of time and rolls back/replays to reduce input lag. Very high system requirements.",
     "Main", "RunaheadFrameCount", 0, runahead_options.data(), runahead_options.size());
+  DrawToggleSetting(bsi, "Preemptive Runahead",
+                    "Only rolls back when the controller input actually differs from the last replay, skipping "
+                    "presses which are released before the next frame.",
+                    "Main", "RunaheadPreemptive", false, runahead_enabled);
+  DrawToggleSetting(bsi, "Adapt To Frame Time Budget",
+                    "Lowers runahead frames, then rewind frequency, when they don't fit in the frame time, and raises "
+                    "them again once there's room.",
+                    "Main", "AdaptiveFrameBudget", Settings::DEFAULT_ADAPTIVE_FRAME_BUDGET,
+                    runahead_enabled || rewind_enabled);
 
   TinyString rewind_summary;
   if (runahead_enabled)
@@ -2933,8 +2950,10 @@ void FullscreenUI::DrawEmulationSettingsPage()
       ((rewind_frequency <= std::numeric_limits<float>::epsilon()) ? (1.0f / 60.0f) : rewind_frequency) *
       static_cast<float>(rewind_save_slots);
 
+    const s32 rewind_memory_budget = GetEffectiveIntSetting(bsi, "Main", "RewindMemoryBudget", 256);
+
     u64 ram_usage, vram_usage;
-    System::CalculateRewindMemoryUsage(rewind_save_slots, &ram_usage, &vram_usage);
+    System::CalculateRewindMemoryUsage(rewind_save_slots, rewind_memory_budget, &ram_usage, &vram_usage);
     rewind_summary.Format("Rewind for %u frames, lasting %.2f seconds will require up to %" PRIu64
                           "MB of RAM and %" PRIu64 "MB of VRAM.",
                           rewind_save_slots, duration, ram_usage / 1048576, vram_usage / 1048576);
@@ -4543,6 +4562,9 @@ void FullscreenUI::DrawAdvancedSettingsPage()
   DrawToggleSetting(bsi, "Enable Recompiler Block Linking",
                     "Performance enhancement - jumps directly between blocks instead of returning to the dispatcher.",
                     "CPU", "RecompilerBlockLinking", true);
+  DrawToggleSetting(bsi, "Enable Recompiler Background Compilation",
+                    "Compiles new blocks on a worker thread, interpreting them until the next frame.", "CPU",
+                    "RecompilerAsyncCompilation", false);
   DrawEnumSetting(bsi, "Recompiler Fast Memory Access",
                   "Avoids calls to C++ code, significantly speeding up the recompiler.", "CPU", "FastmemMode",
                   Settings::DEFAULT_CPU_FASTMEM_MODE, &Settings::ParseCPUFastmemMode, &Settings::GetCPUFastmemModeName,
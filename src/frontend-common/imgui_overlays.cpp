@@ -303,6 +303,21 @@ void ImGuiManager::DrawPerformanceOverlay()
         DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
       }
 
+      if (g_settings.IsRunaheadEnabled() || g_settings.rewind_enable)
+      {
+        text.Clear();
+        text.AppendFmtString("Frame: {:.2f}ms | Save: {:.2f}ms", System::GetAverageRunFrameTime(),
+                             System::GetAverageMemorySaveStateTime());
+        if (g_settings.IsRunaheadEnabled())
+          text.AppendFmtString(" | RA: {}/{}", System::GetRunaheadFrames(), g_settings.runahead_frames);
+        if (g_settings.rewind_enable)
+          text.AppendFmtString(" | RW: {}f", System::GetRewindSaveFrequency() + 1);
+
+        // Highlighted while lowered to fit the frame time budget.
+        DRAW_LINE(fixed_font, text,
+                  System::IsFrameBudgetLimited() ? IM_COL32(255, 255, 0, 255) : IM_COL32(255, 255, 255, 255));
+      }
+
 #if 0
       {
         AudioStream* stream = g_spu.GetOutputStream();
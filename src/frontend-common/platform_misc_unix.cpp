@@ -6,13 +6,13 @@
 #include "platform_misc.h"
 #include "input_manager.h"
 #include <cinttypes>
+#include <spawn.h>
+#include <unistd.h>
 Log_SetChannel(FrontendCommon);
 
 #ifdef USE_X11
 #include <cstdio>
-#include <spawn.h>
 #include <sys/wait.h>
-#include <unistd.h>
 
 static bool SetScreensaverInhibitX11(bool inhibit, const WindowInfo& wi)
 {
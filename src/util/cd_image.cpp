@@ -363,6 +363,8 @@ bool CDImage::IsPrecached() const
   return false;
 }
 
+void CDImage::SetDecompressionCacheSize(u32 size) {}
+
 void CDImage::ClearTOC()
 {
   m_lba_count = 0;
@@ -350,6 +350,10 @@ public:
   virtual PrecacheResult Precache(ProgressCallback* progress = ProgressCallback::NullProgressCallback);
   virtual bool IsPrecached() const;
 
+  // Sets the memory budget for decompressing sectors ahead of the read position on worker threads. Zero disables it.
+  // Only used by compressed formats. May be called while another thread is reading.
+  virtual void SetDecompressionCacheSize(u32 size);
+
 protected:
   void ClearTOC();
   void CopyTOC(const CDImage* image);
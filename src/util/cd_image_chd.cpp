@@ -17,11 +17,15 @@
 #include "libchdr/chd.h"
 #include <algorithm>
 #include <cerrno>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <optional>
+#include <thread>
 Log_SetChannel(CDImageCHD);
 
 static std::optional<CDImage::TrackMode> ParseTrackModeString(const char* str)
@@ -58,6 +62,7 @@ public:
   bool HasNonStandardSubchannel() const override;
   PrecacheResult Precache(ProgressCallback* progress) override;
   bool IsPrecached() const override;
+  void SetDecompressionCacheSize(u32 size) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
@@ -66,20 +71,53 @@ private:
   enum : u32
   {
     CHD_CD_SECTOR_DATA_SIZE = 2352 + 96,
-    CHD_CD_TRACK_ALIGNMENT = 4
+    CHD_CD_TRACK_ALIGNMENT = 4,
+    MAX_DECOMPRESSION_THREADS = 2,
+    READAHEAD_HUNKS = 4,
+    INVALID_HUNK = static_cast<u32>(-1),
+  };
+
+  struct CachedHunk
+  {
+    u32 hunk_index;
+    u32 last_used;
+    bool ready; // false while a worker is decompressing into it
+    std::vector<u8> data;
   };
 
   bool ReadHunk(u32 hunk_index);
+  bool ReadHunkFromCache(u32 hunk_index);
+
+  // These require m_cache_mutex to be held.
+  u32 FindCachedHunk(u32 hunk_index) const;
+  u32 AllocateCachedHunk(u32 hunk_index);
+  void QueueReadahead(u32 hunk_index);
+
+  void StartDecompressionThreads();
+  void StopDecompressionThreads();
+  void DecompressionThreadEntryPoint();
 
   std::FILE* m_fp = nullptr;
   chd_file* m_chd = nullptr;
   u32 m_hunk_size = 0;
+  u32 m_hunk_count = 0;
   u32 m_sectors_per_hunk = 0;
 
   std::vector<u8> m_hunk_buffer;
   u32 m_current_hunk_index = static_cast<u32>(-1);
   bool m_precached = false;
 
+  // Decompressed hunks, shared with the worker threads which decompress ahead of the read position.
+  std::mutex m_cache_mutex;
+  std::condition_variable m_cache_cv;
+  std::condition_variable m_worker_cv;
+  std::vector<CachedHunk> m_hunk_cache;
+  std::deque<u32> m_readahead_queue;
+  std::vector<std::thread> m_decompression_threads;
+  u32 m_max_cached_hunks = 0;
+  u32 m_cache_clock = 0;
+  bool m_decompression_threads_shutdown = false;
+
   CDSubChannelReplacement m_sbi;
 };
 
@@ -87,6 +125,8 @@ CDImageCHD::CDImageCHD() = default;
 
 CDImageCHD::~CDImageCHD()
 {
+  StopDecompressionThreads();
+
   if (m_chd)
     chd_close(m_chd);
   if (m_fp)
@@ -118,6 +158,7 @@ bool CDImageCHD::Open(const char* filename, Common::Error* error)
 
   const chd_header* header = chd_get_header(m_chd);
   m_hunk_size = header->hunkbytes;
+  m_hunk_count = header->totalhunks;
   if ((m_hunk_size % CHD_CD_SECTOR_DATA_SIZE) != 0)
   {
     Log_ErrorPrintf("Hunk size (%u) is not a multiple of %u", m_hunk_size, CHD_CD_SECTOR_DATA_SIZE);
@@ -393,6 +434,9 @@ bool CDImageCHD::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
 
 bool CDImageCHD::ReadHunk(u32 hunk_index)
 {
+  if (ReadHunkFromCache(hunk_index))
+    return true;
+
   const chd_error err = chd_read(m_chd, hunk_index, m_hunk_buffer.data());
   if (err != CHDERR_NONE)
   {
@@ -404,9 +448,209 @@ bool CDImageCHD::ReadHunk(u32 hunk_index)
   }
 
   m_current_hunk_index = hunk_index;
+
+  // Keep it around in case we seek back, which is common when streaming.
+  std::unique_lock lock(m_cache_mutex);
+  const u32 slot = (m_max_cached_hunks > 0 && FindCachedHunk(hunk_index) == INVALID_HUNK) ?
+                     AllocateCachedHunk(hunk_index) :
+                     INVALID_HUNK;
+  if (slot != INVALID_HUNK)
+  {
+    CachedHunk& hunk = m_hunk_cache[slot];
+    std::memcpy(hunk.data.data(), m_hunk_buffer.data(), m_hunk_size);
+    hunk.ready = true;
+  }
+
   return true;
 }
 
+bool CDImageCHD::ReadHunkFromCache(u32 hunk_index)
+{
+  std::unique_lock lock(m_cache_mutex);
+  if (m_max_cached_hunks == 0)
+    return false;
+
+  QueueReadahead(hunk_index);
+
+  for (;;)
+  {
+    const u32 slot = FindCachedHunk(hunk_index);
+    if (slot == INVALID_HUNK)
+      return false;
+
+    CachedHunk& hunk = m_hunk_cache[slot];
+    if (!hunk.ready)
+    {
+      // A worker is already decompressing it, which will be quicker than starting over.
+      m_cache_cv.wait(lock);
+      continue;
+    }
+
+    std::memcpy(m_hunk_buffer.data(), hunk.data.data(), m_hunk_size);
+    hunk.last_used = ++m_cache_clock;
+    m_current_hunk_index = hunk_index;
+    return true;
+  }
+}
+
+u32 CDImageCHD::FindCachedHunk(u32 hunk_index) const
+{
+  for (u32 i = 0; i < static_cast<u32>(m_hunk_cache.size()); i++)
+  {
+    if (m_hunk_cache[i].hunk_index == hunk_index)
+      return i;
+  }
+
+  return INVALID_HUNK;
+}
+
+u32 CDImageCHD::AllocateCachedHunk(u32 hunk_index)
+{
+  u32 slot = INVALID_HUNK;
+  if (m_hunk_cache.size() < m_max_cached_hunks)
+  {
+    slot = static_cast<u32>(m_hunk_cache.size());
+    m_hunk_cache.push_back(CachedHunk{INVALID_HUNK, 0, true, std::vector<u8>(m_hunk_size)});
+  }
+  else
+  {
+    // Evict the least recently used hunk, skipping any which are still being decompressed.
+    for (u32 i = 0; i < static_cast<u32>(m_hunk_cache.size()); i++)
+    {
+      const CachedHunk& hunk = m_hunk_cache[i];
+      if (hunk.ready && (slot == INVALID_HUNK || hunk.last_used < m_hunk_cache[slot].last_used))
+        slot = i;
+    }
+    if (slot == INVALID_HUNK)
+      return INVALID_HUNK;
+  }
+
+  CachedHunk& hunk = m_hunk_cache[slot];
+  hunk.hunk_index = hunk_index;
+  hunk.last_used = ++m_cache_clock;
+  hunk.ready = false;
+  return slot;
+}
+
+void CDImageCHD::QueueReadahead(u32 hunk_index)
+{
+  // Reads are almost always sequential, so predict the hunks following the current position. Anything left over from
+  // before a seek is no longer useful.
+  m_readahead_queue.clear();
+  for (u32 i = 1; i <= READAHEAD_HUNKS && (hunk_index + i) < m_hunk_count; i++)
+  {
+    if (FindCachedHunk(hunk_index + i) == INVALID_HUNK)
+      m_readahead_queue.push_back(hunk_index + i);
+  }
+
+  if (!m_readahead_queue.empty())
+    m_worker_cv.notify_all();
+}
+
+void CDImageCHD::SetDecompressionCacheSize(u32 size)
+{
+  const u32 max_cached_hunks = size / m_hunk_size;
+  if (max_cached_hunks == m_max_cached_hunks)
+    return;
+
+  // Workers hold pointers into the cache, so they have to be stopped before it's resized.
+  StopDecompressionThreads();
+
+  {
+    std::unique_lock lock(m_cache_mutex);
+    m_hunk_cache = {};
+    m_readahead_queue.clear();
+    m_max_cached_hunks = max_cached_hunks;
+    m_hunk_cache.reserve(max_cached_hunks);
+  }
+
+  if (max_cached_hunks > 0)
+    StartDecompressionThreads();
+}
+
+void CDImageCHD::StartDecompressionThreads()
+{
+  const u32 num_threads =
+    std::clamp<u32>(std::thread::hardware_concurrency() / 2, 1, static_cast<u32>(MAX_DECOMPRESSION_THREADS));
+
+  m_decompression_threads_shutdown = false;
+  for (u32 i = 0; i < num_threads; i++)
+    m_decompression_threads.emplace_back(&CDImageCHD::DecompressionThreadEntryPoint, this);
+
+  Log_DevPrintf("Started %u decompression threads with a cache of %u hunks", num_threads, m_max_cached_hunks);
+}
+
+void CDImageCHD::StopDecompressionThreads()
+{
+  if (m_decompression_threads.empty())
+    return;
+
+  {
+    std::unique_lock lock(m_cache_mutex);
+    m_decompression_threads_shutdown = true;
+    m_worker_cv.notify_all();
+  }
+
+  for (std::thread& thread : m_decompression_threads)
+    thread.join();
+  m_decompression_threads.clear();
+}
+
+void CDImageCHD::DecompressionThreadEntryPoint()
+{
+  // Decompressor state isn't shareable, so each worker needs its own handle.
+  std::FILE* fp = FileSystem::OpenCFile(m_filename.c_str(), "rb");
+  chd_file* chd = nullptr;
+  const chd_error open_err = fp ? chd_open_file(fp, CHD_OPEN_READ, nullptr, &chd) : CHDERR_FILE_NOT_FOUND;
+  if (open_err != CHDERR_NONE)
+  {
+    Log_ErrorPrintf("Failed to open CHD '%s' for decompression thread: %s", m_filename.c_str(),
+                    chd_error_string(open_err));
+    if (fp)
+      std::fclose(fp);
+
+    return;
+  }
+
+  std::unique_lock lock(m_cache_mutex);
+  for (;;)
+  {
+    m_worker_cv.wait(lock, [this]() { return (m_decompression_threads_shutdown || !m_readahead_queue.empty()); });
+    if (m_decompression_threads_shutdown)
+      break;
+
+    const u32 hunk_index = m_readahead_queue.front();
+    m_readahead_queue.pop_front();
+    if (FindCachedHunk(hunk_index) != INVALID_HUNK)
+      continue;
+
+    const u32 slot = AllocateCachedHunk(hunk_index);
+    if (slot == INVALID_HUNK)
+      continue;
+
+    // The buffer can't move while the hunk isn't ready.
+    u8* data = m_hunk_cache[slot].data.data();
+    lock.unlock();
+
+    const chd_error err = chd_read(chd, hunk_index, data);
+
+    lock.lock();
+    CachedHunk& hunk = m_hunk_cache[slot];
+    hunk.ready = true;
+    if (err != CHDERR_NONE)
+    {
+      Log_ErrorPrintf("chd_read(%u) failed: %s", hunk_index, chd_error_string(err));
+      hunk.hunk_index = INVALID_HUNK;
+    }
+
+    m_cache_cv.notify_all();
+  }
+  lock.unlock();
+
+  chd_close(chd);
+  std::fclose(fp);
+}
+
 std::unique_ptr<CDImage> CDImage::OpenCHDImage(const char* filename, Common::Error* error)
 {
   std::unique_ptr<CDImageCHD> image = std::make_unique<CDImageCHD>();
@@ -9,10 +9,12 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "cue_parser.h"
+#include "mapped_file.h"
 #include <algorithm>
 #include <cerrno>
 #include <cinttypes>
 #include <map>
+#include <memory>
 Log_SetChannel(CDImageCueSheet);
 
 class CDImageCueSheet : public CDImage
@@ -35,6 +37,7 @@ private:
     std::string filename;
     std::FILE* file;
     u64 file_position;
+    std::unique_ptr<Common::MappedFile> mapping; // null if the file couldn't be mapped
   };
 
   std::vector<TrackFile> m_files;
@@ -121,7 +124,11 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Common::Error* error)
         return false;
       }
 
-      m_files.push_back(TrackFile{std::move(track_filename), track_fp, 0});
+      std::unique_ptr<Common::MappedFile> mapping = std::make_unique<Common::MappedFile>();
+      if (!mapping->Map(track_fp))
+        mapping.reset();
+
+      m_files.push_back(TrackFile{std::move(track_filename), track_fp, 0, std::move(mapping)});
     }
 
     // data type determines the sector size
@@ -315,6 +322,9 @@ bool CDImageCueSheet::ReadSectorFromIndex(void* buffer, const Index& index, LBA
 
   TrackFile& tf = m_files[index.file_index];
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (tf.mapping)
+    return tf.mapping->Read(buffer, file_position, index.file_sector_size);
+
   if (tf.file_position != file_position)
   {
     if (std::fseek(tf.file, static_cast<long>(file_position), SEEK_SET) != 0)
@@ -5,75 +5,301 @@
 #include "cd_image.h"
 #include "common/md5_digest.h"
 #include "common/string_util.h"
+#include "xxhash.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 namespace CDImageHasher {
 
-static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, ProgressCallback* progress_callback)
+// Sectors are handed to the hashing threads in batches, and only so many can be in flight before the reader waits.
+static constexpr u32 SECTORS_PER_BATCH = 64;
+static constexpr u32 MAX_BATCHES_IN_FLIGHT = 16;
+static constexpr u32 MAX_HASH_THREADS = 4;
+
+class Digest
 {
-  const CDImage::LBA index_start = image->GetTrackIndexPosition(track, index);
-  const u32 index_length = image->GetTrackIndexLength(track, index);
-  const u32 update_interval = std::max<u32>(index_length / 100u, 1u);
+public:
+  Digest() = default;
+  ~Digest()
+  {
+    if (m_xxh_state)
+      XXH3_freeState(m_xxh_state);
+  }
 
-  progress_callback->SetFormattedStatusText("Computing hash for track %u/index %u...", track, index);
-  progress_callback->SetProgressRange(index_length);
+  Digest(const Digest&) = delete;
+  Digest& operator=(const Digest&) = delete;
 
-  if (!image->Seek(index_start))
+  void Init(HashType type)
   {
-    progress_callback->DisplayFormattedModalError("Failed to seek to sector %u for track %u index %u", index_start,
-                                                  track, index);
-    return false;
+    m_type = type;
+    if (type == HashType::XXH128)
+    {
+      m_xxh_state = XXH3_createState();
+      XXH3_128bits_reset(m_xxh_state);
+    }
   }
 
-  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
-  for (u32 lba = 0; lba < index_length; lba++)
+  void Update(const void* data, u32 size)
   {
-    if ((lba % update_interval) == 0)
-      progress_callback->SetProgressValue(lba);
+    if (m_type == HashType::XXH128)
+      XXH3_128bits_update(m_xxh_state, data, size);
+    else
+      m_md5.Update(data, size);
+  }
 
-    if (!image->ReadRawSector(sector.data(), nullptr))
+  void Final(Hash* out_hash)
+  {
+    if (m_type == HashType::XXH128)
     {
-      progress_callback->DisplayFormattedModalError("Failed to read sector %u from image", image->GetPositionOnDisc());
-      return false;
+      static_assert(sizeof(XXH128_canonical_t) == sizeof(Hash));
+      XXH128_canonical_t canonical;
+      XXH128_canonicalFromHash(&canonical, XXH3_128bits_digest(m_xxh_state));
+      std::memcpy(out_hash->data(), canonical.digest, sizeof(canonical.digest));
     }
+    else
+    {
+      m_md5.Final(out_hash->data());
+    }
+  }
+
+private:
+  HashType m_type = HashType::MD5;
+  MD5Digest m_md5;
+  XXH3_state_t* m_xxh_state = nullptr;
+};
+
+/// Hashes several independent streams of sectors on worker threads. Batches within a stream are always hashed in the
+/// order they were submitted, but different streams can be hashed concurrently.
+class HashPipeline
+{
+public:
+  HashPipeline(HashType type, u32 num_streams);
+  ~HashPipeline();
+
+  /// Returns a buffer for SECTORS_PER_BATCH sectors, waiting for one to be freed if necessary.
+  u8* AllocateBatch();
+
+  /// Queues the sectors in a buffer from AllocateBatch() to be hashed.
+  void SubmitBatch(u32 stream, u8* buffer, u32 num_sectors);
+
+  /// Waits for all submitted batches to be hashed, and finalizes each stream's hash.
+  void Finish(std::vector<Hash>* out_hashes);
+
+private:
+  struct Batch
+  {
+    u8* buffer;
+    u32 num_sectors;
+  };
+
+  struct Stream
+  {
+    Digest digest;
+    std::deque<Batch> pending;
+    bool busy = false;
+  };
+
+  void WorkerThreadEntryPoint();
+
+  std::vector<Stream> m_streams;
+  std::unique_ptr<u8[]> m_buffer_storage;
+  std::vector<u8*> m_free_buffers;
+  std::vector<std::thread> m_threads;
 
-    digest->Update(sector.data(), static_cast<u32>(sector.size()));
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  u32 m_batches_in_flight = 0;
+  bool m_shutdown = false;
+};
+
+HashPipeline::HashPipeline(HashType type, u32 num_streams) : m_streams(num_streams)
+{
+  for (Stream& stream : m_streams)
+    stream.digest.Init(type);
+
+  m_buffer_storage = std::make_unique<u8[]>(MAX_BATCHES_IN_FLIGHT * SECTORS_PER_BATCH * CDImage::RAW_SECTOR_SIZE);
+  for (u32 i = 0; i < MAX_BATCHES_IN_FLIGHT; i++)
+    m_free_buffers.push_back(&m_buffer_storage[i * SECTORS_PER_BATCH * CDImage::RAW_SECTOR_SIZE]);
+
+  // Leave a core for the reader, but there's no point having more threads than streams.
+  const u32 num_cores = std::max(std::thread::hardware_concurrency(), 2u);
+  const u32 num_threads = std::clamp(num_cores - 1, 1u, std::clamp(num_streams, 1u, MAX_HASH_THREADS));
+  m_threads.reserve(num_threads);
+  for (u32 i = 0; i < num_threads; i++)
+    m_threads.emplace_back(&HashPipeline::WorkerThreadEntryPoint, this);
+}
+
+HashPipeline::~HashPipeline()
+{
+  {
+    std::unique_lock lock(m_mutex);
+    m_shutdown = true;
+    m_work_cv.notify_all();
   }
 
-  progress_callback->SetProgressValue(index_length);
-  return true;
+  for (std::thread& thread : m_threads)
+    thread.join();
 }
 
-static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback)
+u8* HashPipeline::AllocateBatch()
 {
-  static constexpr u8 INDICES_TO_READ = 2;
+  std::unique_lock lock(m_mutex);
+  m_done_cv.wait(lock, [this]() { return !m_free_buffers.empty(); });
 
-  progress_callback->PushState();
+  u8* buffer = m_free_buffers.back();
+  m_free_buffers.pop_back();
+  return buffer;
+}
 
-  const bool dataTrack = track == 1;
-  progress_callback->SetProgressRange(dataTrack ? 1 : 2);
+void HashPipeline::SubmitBatch(u32 stream, u8* buffer, u32 num_sectors)
+{
+  std::unique_lock lock(m_mutex);
+  m_streams[stream].pending.push_back(Batch{buffer, num_sectors});
+  m_batches_in_flight++;
+  m_work_cv.notify_one();
+}
 
-  u8 progress = 0;
-  for (u8 index = 0; index < INDICES_TO_READ; index++)
+void HashPipeline::Finish(std::vector<Hash>* out_hashes)
+{
   {
-    progress_callback->SetProgressValue(progress);
+    std::unique_lock lock(m_mutex);
+    m_done_cv.wait(lock, [this]() { return m_batches_in_flight == 0; });
+  }
+
+  out_hashes->resize(m_streams.size());
+  for (size_t i = 0; i < m_streams.size(); i++)
+    m_streams[i].digest.Final(&(*out_hashes)[i]);
+}
+
+void HashPipeline::WorkerThreadEntryPoint()
+{
+  std::unique_lock lock(m_mutex);
+  for (;;)
+  {
+    // Only one thread can be working on a stream at a time, otherwise the batches could be hashed out of order.
+    Stream* stream = nullptr;
+    m_work_cv.wait(lock, [this, &stream]() {
+      for (Stream& it : m_streams)
+      {
+        if (!it.busy && !it.pending.empty())
+        {
+          stream = &it;
+          return true;
+        }
+      }
+
+      return m_shutdown;
+    });
+    if (!stream)
+      break;
 
+    const Batch batch = stream->pending.front();
+    stream->pending.pop_front();
+    stream->busy = true;
+    lock.unlock();
+
+    stream->digest.Update(batch.buffer, batch.num_sectors * CDImage::RAW_SECTOR_SIZE);
+
+    lock.lock();
+    stream->busy = false;
+    m_free_buffers.push_back(batch.buffer);
+    m_batches_in_flight--;
+    m_done_cv.notify_all();
+
+    // Another batch for this stream may have been skipped over while it was busy.
+    if (!stream->pending.empty())
+      m_work_cv.notify_one();
+  }
+}
+
+struct IndexRange
+{
+  u32 stream;
+  u8 track;
+  u8 index;
+  CDImage::LBA start;
+  u32 length;
+};
+
+static void GetTrackRanges(CDImage* image, u8 track, u32 stream, std::vector<IndexRange>* ranges)
+{
+  static constexpr u8 INDICES_TO_READ = 2;
+
+  for (u8 index = 0; index < INDICES_TO_READ; index++)
+  {
     // skip index 0 if data track
-    if (dataTrack && index == 0)
+    if (track == 1 && index == 0)
       continue;
 
-    progress++;
-    progress_callback->PushState();
-    if (!ReadIndex(image, track, index, digest, progress_callback))
+    ranges->push_back(IndexRange{stream, track, index, image->GetTrackIndexPosition(track, index),
+                                 image->GetTrackIndexLength(track, index)});
+  }
+}
+
+static bool HashRanges(CDImage* image, const std::vector<IndexRange>& ranges, u32 num_streams, HashType type,
+                       std::vector<Hash>* out_hashes, ProgressCallback* progress_callback)
+{
+  u32 total_sectors = 0;
+  for (const IndexRange& range : ranges)
+    total_sectors += range.length;
+
+  const u32 update_interval = std::max<u32>(total_sectors / 100u, 1u);
+  u32 sectors_read = 0;
+
+  progress_callback->PushState();
+  progress_callback->SetProgressRange(total_sectors);
+  progress_callback->SetProgressValue(0);
+
+  HashPipeline pipeline(type, num_streams);
+  for (const IndexRange& range : ranges)
+  {
+    progress_callback->SetFormattedStatusText("Computing hash for track %u/index %u...", range.track, range.index);
+
+    if (!image->Seek(range.start))
     {
-      progress_callback->PopState();
+      progress_callback->DisplayFormattedModalError("Failed to seek to sector %u for track %u index %u", range.start,
+                                                    range.track, range.index);
       progress_callback->PopState();
       return false;
     }
 
-    progress_callback->PopState();
+    for (u32 lba = 0; lba < range.length;)
+    {
+      if (progress_callback->IsCancelled())
+      {
+        progress_callback->PopState();
+        return false;
+      }
+
+      const u32 num_sectors = std::min(range.length - lba, SECTORS_PER_BATCH);
+      u8* buffer = pipeline.AllocateBatch();
+      for (u32 i = 0; i < num_sectors; i++)
+      {
+        if (!image->ReadRawSector(&buffer[i * CDImage::RAW_SECTOR_SIZE], nullptr))
+        {
+          progress_callback->DisplayFormattedModalError("Failed to read sector %u from image",
+                                                        image->GetPositionOnDisc());
+          progress_callback->PopState();
+          return false;
+        }
+
+        if ((sectors_read++ % update_interval) == 0)
+          progress_callback->SetProgressValue(sectors_read);
+      }
+
+      pipeline.SubmitBatch(range.stream, buffer, num_sectors);
+      lba += num_sectors;
+    }
   }
 
-  progress_callback->SetProgressValue(progress);
+  pipeline.Finish(out_hashes);
+  progress_callback->SetProgressValue(total_sectors);
   progress_callback->PopState();
   return true;
 }
@@ -97,38 +323,47 @@ std::optional<Hash> HashFromString(const std::string_view& str) {
 }
 
 bool GetImageHash(CDImage* image, Hash* out_hash,
-                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/,
+                  HashType type /*= HashType::MD5*/)
 {
-  MD5Digest digest;
-
-  progress_callback->SetProgressRange(image->GetTrackCount());
-  progress_callback->SetProgressValue(0);
-  progress_callback->PushState();
-
+  // All tracks feed into the one hash.
+  std::vector<IndexRange> ranges;
   for (u32 i = 1; i <= image->GetTrackCount(); i++)
-  {
-    progress_callback->SetProgressValue(i - 1);
-    if (!ReadTrack(image, static_cast<u8>(i), &digest, progress_callback))
-    {
-      progress_callback->PopState();
-      return false;
-    }
-  }
+    GetTrackRanges(image, static_cast<u8>(i), 0, &ranges);
+
+  std::vector<Hash> hashes;
+  if (!HashRanges(image, ranges, 1, type, &hashes, progress_callback))
+    return false;
 
-  progress_callback->SetProgressValue(image->GetTrackCount());
-  digest.Final(out_hash->data());
+  *out_hash = hashes.front();
   return true;
 }
 
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
-                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+                  ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/,
+                  HashType type /*= HashType::MD5*/)
 {
-  MD5Digest digest;
-  if (!ReadTrack(image, track, &digest, progress_callback))
+  std::vector<IndexRange> ranges;
+  GetTrackRanges(image, track, 0, &ranges);
+
+  std::vector<Hash> hashes;
+  if (!HashRanges(image, ranges, 1, type, &hashes, progress_callback))
     return false;
 
-  digest.Final(out_hash->data());
+  *out_hash = hashes.front();
   return true;
 }
 
-} // namespace CDImageHasher
\ No newline at end of file
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/,
+                    HashType type /*= HashType::MD5*/)
+{
+  const u32 track_count = image->GetTrackCount();
+  std::vector<IndexRange> ranges;
+  for (u32 i = 1; i <= track_count; i++)
+    GetTrackRanges(image, static_cast<u8>(i), i - 1, &ranges);
+
+  return HashRanges(image, ranges, track_count, type, out_hashes, progress_callback);
+}
+
+} // namespace CDImageHasher
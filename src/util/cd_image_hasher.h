@@ -7,18 +7,34 @@
 #include <array>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 class CDImage;
 
 namespace CDImageHasher {
 
+enum class HashType : u8
+{
+  MD5,    // Matches the redump track hashes in the game database.
+  XXH128, // Much cheaper, for detecting changes to an image.
+};
+
 using Hash = std::array<u8, 16>;
 std::string HashToString(const Hash& hash);
 std::optional<Hash> HashFromString(const std::string_view& str);
 
 bool GetImageHash(CDImage* image, Hash* out_hash,
-                  ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
+                  ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback,
+                  HashType type = HashType::MD5);
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
-                  ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
+                  ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback,
+                  HashType type = HashType::MD5);
+
+// Hashes every track of the image in a single pass. Sectors are read sequentially on the calling thread, while
+// worker threads hash the tracks, so a track can still be hashing while the next is being read.
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback,
+                    HashType type = HashType::MD5);
 
 } // namespace CDImageHasher
\ No newline at end of file
@@ -30,6 +30,7 @@ public:
   u32 GetCurrentSubImage() const override;
   std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
   bool SwitchSubImage(u32 index, Common::Error* error) override;
+  void SetDecompressionCacheSize(u32 size) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
@@ -45,6 +46,7 @@ private:
   std::vector<Entry> m_entries;
   std::unique_ptr<CDImage> m_current_image;
   u32 m_current_image_index = UINT32_C(0xFFFFFFFF);
+  u32 m_decompression_cache_size = 0;
   bool m_apply_patches = false;
 };
 
@@ -144,6 +146,7 @@ bool CDImageM3u::SwitchSubImage(u32 index, Common::Error* error)
   }
 
   CopyTOC(new_image.get());
+  new_image->SetDecompressionCacheSize(m_decompression_cache_size);
   m_current_image = std::move(new_image);
   m_current_image_index = index;
   if (!Seek(1, Position{0, 0, 0}))
@@ -152,6 +155,13 @@ bool CDImageM3u::SwitchSubImage(u32 index, Common::Error* error)
   return true;
 }
 
+void CDImageM3u::SetDecompressionCacheSize(u32 size)
+{
+  m_decompression_cache_size = size;
+  if (m_current_image)
+    m_current_image->SetDecompressionCacheSize(size);
+}
+
 std::string CDImageM3u::GetSubImageMetadata(u32 index, const std::string_view& type) const
 {
   if (index > m_entries.size())
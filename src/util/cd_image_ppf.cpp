@@ -33,6 +33,7 @@ public:
   std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
 
   PrecacheResult Precache(ProgressCallback* progress = ProgressCallback::NullProgressCallback) override;
+  void SetDecompressionCacheSize(u32 size) override;
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
@@ -425,6 +426,11 @@ CDImage::PrecacheResult CDImagePPF::Precache(ProgressCallback* progress /*= Prog
   return m_parent_image->Precache(progress);
 }
 
+void CDImagePPF::SetDecompressionCacheSize(u32 size)
+{
+  m_parent_image->SetDecompressionCacheSize(size);
+}
+
 bool CDImagePPF::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   DebugAssert(index.file_index == 0);
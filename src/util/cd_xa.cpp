@@ -5,26 +5,110 @@
 #include "cd_image.h"
 #include <algorithm>
 #include <array>
+#include <cstring>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
 
 namespace CDXA {
 static constexpr std::array<s32, 4> s_xa_adpcm_filter_table_pos = {{0, 60, 115, 98}};
 static constexpr std::array<s32, 4> s_xa_adpcm_filter_table_neg = {{0, 0, -52, -55}};
 
+template<bool IS_8BIT>
+ALWAYS_INLINE static void ExtractBlockSamples(const u8* words_ptr, const u8* headers_ptr, s16* samples)
+{
+  // Each sample is the nibble sign-extended from the top of a halfword, then shifted right by the block's shift.
+  // Moving the nibble to the top of the word and shifting right by an extra 16 does both at once.
+  constexpr u32 NUM_BLOCKS = IS_8BIT ? 4 : 8;
+  constexpr u32 BITS_PER_BLOCK = IS_8BIT ? 8 : 4;
+  constexpr u32 WORDS_PER_BLOCK = 28;
+
+#if defined(CPU_X64)
+  __m128i words[WORDS_PER_BLOCK / 4];
+  for (u32 i = 0; i < WORDS_PER_BLOCK / 4; i++)
+    words[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&words_ptr[i * 16]));
+
+  for (u32 block = 0; block < NUM_BLOCKS; block++)
+  {
+    const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
+    const __m128i left_shift = _mm_cvtsi32_si128(static_cast<int>(28 - (block * BITS_PER_BLOCK)));
+    const __m128i right_shift = _mm_cvtsi32_si128(static_cast<int>(16 + block_header.GetShift()));
+
+    s16* out_ptr = &samples[block * WORDS_PER_BLOCK];
+    for (u32 i = 0; i < WORDS_PER_BLOCK / 4; i += 2)
+    {
+      const __m128i lo = _mm_sra_epi32(_mm_sll_epi32(words[i], left_shift), right_shift);
+      if ((i + 1) == (WORDS_PER_BLOCK / 4))
+      {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out_ptr[i * 4]), _mm_packs_epi32(lo, lo));
+        break;
+      }
+
+      const __m128i hi = _mm_sra_epi32(_mm_sll_epi32(words[i + 1], left_shift), right_shift);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&out_ptr[i * 4]), _mm_packs_epi32(lo, hi));
+    }
+  }
+#elif defined(CPU_AARCH64)
+  uint32x4_t words[WORDS_PER_BLOCK / 4];
+  for (u32 i = 0; i < WORDS_PER_BLOCK / 4; i++)
+    words[i] = vld1q_u32(reinterpret_cast<const u32*>(&words_ptr[i * 16]));
+
+  for (u32 block = 0; block < NUM_BLOCKS; block++)
+  {
+    const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
+    const int32x4_t left_shift = vdupq_n_s32(static_cast<s32>(28 - (block * BITS_PER_BLOCK)));
+    const int32x4_t right_shift = vdupq_n_s32(-static_cast<s32>(16 + block_header.GetShift()));
+
+    s16* out_ptr = &samples[block * WORDS_PER_BLOCK];
+    for (u32 i = 0; i < WORDS_PER_BLOCK / 4; i++)
+    {
+      const int32x4_t value = vreinterpretq_s32_u32(vshlq_u32(words[i], left_shift));
+      vst1_s16(&out_ptr[i * 4], vmovn_s32(vshlq_s32(value, right_shift)));
+    }
+  }
+#else
+  for (u32 block = 0; block < NUM_BLOCKS; block++)
+  {
+    const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
+    const u8 shift = block_header.GetShift();
+    for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+    {
+      // NOTE: assumes LE
+      u32 word_data;
+      std::memcpy(&word_data, &words_ptr[word * sizeof(u32)], sizeof(word_data));
+
+      // extract nibble from block
+      const u32 nibble = (word_data >> (block * BITS_PER_BLOCK)) & (IS_8BIT ? 0xFF : 0x0F);
+      samples[block * WORDS_PER_BLOCK + word] = static_cast<s16>(Truncate16(nibble << 12)) >> shift;
+    }
+  }
+#endif
+}
+
 template<bool IS_STEREO, bool IS_8BIT>
 static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_samples)
 {
-  // The data layout is annoying here. Each word of data is interleaved with the other blocks, requiring multiple
-  // passes to decode the whole chunk.
+  // The data layout is annoying here. Each word of data is interleaved with the other blocks, so all of the blocks'
+  // samples are extracted in one pass, before each is run through its filter in turn.
   constexpr u32 NUM_BLOCKS = IS_8BIT ? 4 : 8;
   constexpr u32 WORDS_PER_BLOCK = 28;
 
   const u8* headers_ptr = chunk_ptr + 4;
   const u8* words_ptr = chunk_ptr + 16;
 
+  std::array<s16, NUM_BLOCKS * WORDS_PER_BLOCK> block_samples;
+  ExtractBlockSamples<IS_8BIT>(words_ptr, headers_ptr, block_samples.data());
+
   for (u32 block = 0; block < NUM_BLOCKS; block++)
   {
     const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
-    const u8 shift = block_header.GetShift();
     const u8 filter = block_header.GetFilter();
     const s32 filter_pos = s_xa_adpcm_filter_table_pos[filter];
     const s32 filter_neg = s_xa_adpcm_filter_table_neg[filter];
@@ -33,27 +117,25 @@ static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_sam
       IS_STEREO ? &samples[(block / 2) * (WORDS_PER_BLOCK * 2) + (block % 2)] : &samples[block * WORDS_PER_BLOCK];
     constexpr u32 out_samples_increment = IS_STEREO ? 2 : 1;
 
-    for (u32 word = 0; word < 28; word++)
-    {
-      // NOTE: assumes LE
-      u32 word_data;
-      std::memcpy(&word_data, &words_ptr[word * sizeof(u32)], sizeof(word_data));
+    // mix in previous values
+    s32* prev = IS_STEREO ? &last_samples[(block & 1) * 2] : last_samples;
+    s32 prev0 = prev[0];
+    s32 prev1 = prev[1];
 
-      // extract nibble from block
-      const u32 nibble = IS_8BIT ? ((word_data >> (block * 8)) & 0xFF) : ((word_data >> (block * 4)) & 0x0F);
-      const s16 sample = static_cast<s16>(Truncate16(nibble << 12)) >> shift;
-
-      // mix in previous values
-      s32* prev = IS_STEREO ? &last_samples[(block & 1) * 2] : last_samples;
-      const s32 interp_sample = s32(sample) + ((prev[0] * filter_pos) + (prev[1] * filter_neg) + 32) / 64;
-
-      // update previous values
-      prev[1] = prev[0];
-      prev[0] = interp_sample;
+    const s16* in_samples_ptr = &block_samples[block * WORDS_PER_BLOCK];
+    for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+    {
+      const s32 interp_sample = s32(in_samples_ptr[word]) + ((prev0 * filter_pos) + (prev1 * filter_neg) + 32) / 64;
+      prev1 = prev0;
+      prev0 = interp_sample;
 
       *out_samples_ptr = static_cast<s16>(std::clamp<s32>(interp_sample, -0x8000, 0x7FFF));
       out_samples_ptr += out_samples_increment;
     }
+
+    // update previous values
+    prev[0] = prev0;
+    prev[1] = prev1;
   }
 }
 
@@ -98,4 +180,117 @@ void DecodeADPCMSector(const void* data, s16* samples, s32* last_samples)
   }
 }
 
+static constexpr std::array<std::array<s16, XA_RESAMPLE_ZIGZAG_TABLE_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES>
+  s_zigzag_table = {
+  {{0,      0x0,     0x0,     0x0,    0x0,     -0x0002, 0x000A,  -0x0022, 0x0041, -0x0054,
+    0x0034, 0x0009,  -0x010A, 0x0400, -0x0A78, 0x234C,  0x6794,  -0x1780, 0x0BCD, -0x0623,
+    0x0350, -0x016D, 0x006B,  0x000A, -0x0010, 0x0011,  -0x0008, 0x0003,  -0x0001},
+   {0,       0x0,    0x0,     -0x0002, 0x0,    0x0003,  -0x0013, 0x003C,  -0x004B, 0x00A2,
+    -0x00E3, 0x0132, -0x0043, -0x0267, 0x0C9D, 0x74BB,  -0x11B4, 0x09B8,  -0x05BF, 0x0372,
+    -0x01A8, 0x00A6, -0x001B, 0x0005,  0x0006, -0x0008, 0x0003,  -0x0001, 0x0},
+   {0,      0x0,     -0x0001, 0x0003,  -0x0002, -0x0005, 0x001F,  -0x004A, 0x00B3, -0x0192,
+    0x02B1, -0x039E, 0x04F8,  -0x05A6, 0x7939,  -0x05A6, 0x04F8,  -0x039E, 0x02B1, -0x0192,
+    0x00B3, -0x004A, 0x001F,  -0x0005, -0x0002, 0x0003,  -0x0001, 0x0,     0x0},
+   {0,       -0x0001, 0x0003,  -0x0008, 0x0006, 0x0005,  -0x001B, 0x00A6, -0x01A8, 0x0372,
+    -0x05BF, 0x09B8,  -0x11B4, 0x74BB,  0x0C9D, -0x0267, -0x0043, 0x0132, -0x00E3, 0x00A2,
+    -0x004B, 0x003C,  -0x0013, 0x0003,  0x0,    -0x0002, 0x0,     0x0,    0x0},
+   {-0x0001, 0x0003,  -0x0008, 0x0011,  -0x0010, 0x000A, 0x006B,  -0x016D, 0x0350, -0x0623,
+    0x0BCD,  -0x1780, 0x6794,  0x234C,  -0x0A78, 0x0400, -0x010A, 0x0009,  0x0034, -0x0054,
+    0x0041,  -0x0022, 0x000A,  -0x0001, 0x0,     0x0001, 0x0,     0x0,     0x0},
+   {0x0002,  -0x0008, 0x0010,  -0x0023, 0x002B, 0x001A,  -0x00EB, 0x027B,  -0x0548, 0x0AFA,
+    -0x16FA, 0x53E0,  0x3C07,  -0x1249, 0x080E, -0x0347, 0x015B,  -0x0044, -0x0017, 0x0046,
+    -0x0023, 0x0011,  -0x0005, 0x0,     0x0,    0x0,     0x0,     0x0,     0x0},
+   {-0x0005, 0x0011,  -0x0023, 0x0046, -0x0017, -0x0044, 0x015B,  -0x0347, 0x080E, -0x1249,
+    0x3C07,  0x53E0,  -0x16FA, 0x0AFA, -0x0548, 0x027B,  -0x00EB, 0x001A,  0x002B, -0x0023,
+    0x0010,  -0x0008, 0x0002,  0x0,    0x0,     0x0,     0x0,     0x0,     0x0}}};
+
+// The zigzag tables reversed and padded to a multiple of eight taps, so they line up with a window of the ring buffer
+// that's contiguous in memory.
+static constexpr u32 XA_RESAMPLE_PADDED_TABLE_SIZE = 32;
+static constexpr std::array<std::array<s16, XA_RESAMPLE_PADDED_TABLE_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES>
+MakeReversedZigZagTables()
+{
+  std::array<std::array<s16, XA_RESAMPLE_PADDED_TABLE_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES> ret = {};
+  for (u32 j = 0; j < XA_RESAMPLE_NUM_ZIGZAG_TABLES; j++)
+  {
+    for (u32 i = 0; i < XA_RESAMPLE_ZIGZAG_TABLE_SIZE; i++)
+      ret[j][XA_RESAMPLE_ZIGZAG_TABLE_SIZE - 1 - i] = s_zigzag_table[j][i];
+  }
+  return ret;
+}
+alignas(16) static constexpr std::array<std::array<s16, XA_RESAMPLE_PADDED_TABLE_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES>
+  s_reversed_zigzag_table = MakeReversedZigZagTables();
+
+void ZigZagInterpolate(const s16* ringbuf, u32 p, s16* samples)
+{
+  static_assert(XA_RESAMPLE_RING_BUFFER_SIZE == 32);
+
+  // Each tap is ringbuf[(p - i) & 0x1F], which runs backwards through the ring from p. With the ring doubled up,
+  // that's a forward run starting 28 entries behind p, lined up with the reversed tables.
+  std::array<s16, XA_RESAMPLE_RING_BUFFER_SIZE * 2> window;
+  std::memcpy(&window[0], ringbuf, sizeof(s16) * XA_RESAMPLE_RING_BUFFER_SIZE);
+  std::memcpy(&window[XA_RESAMPLE_RING_BUFFER_SIZE], ringbuf, sizeof(s16) * XA_RESAMPLE_RING_BUFFER_SIZE);
+  const s16* window_ptr = &window[(p - (XA_RESAMPLE_ZIGZAG_TABLE_SIZE - 1)) & 0x1F];
+
+#if defined(CPU_X64)
+  // Each product is divided separately, truncating towards zero, so it has to be widened before accumulating.
+  __m128i taps[XA_RESAMPLE_PADDED_TABLE_SIZE / 8];
+  for (u32 i = 0; i < XA_RESAMPLE_PADDED_TABLE_SIZE / 8; i++)
+    taps[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&window_ptr[i * 8]));
+
+  for (u32 j = 0; j < XA_RESAMPLE_NUM_ZIGZAG_TABLES; j++)
+  {
+    __m128i sum = _mm_setzero_si128();
+    for (u32 i = 0; i < XA_RESAMPLE_PADDED_TABLE_SIZE / 8; i++)
+    {
+      const __m128i coeffs = _mm_load_si128(reinterpret_cast<const __m128i*>(&s_reversed_zigzag_table[j][i * 8]));
+      const __m128i lo = _mm_mullo_epi16(taps[i], coeffs);
+      const __m128i hi = _mm_mulhi_epi16(taps[i], coeffs);
+      const __m128i products[2] = {_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi)};
+      for (const __m128i product : products)
+      {
+        const __m128i bias = _mm_srli_epi32(_mm_srai_epi32(product, 31), 17);
+        sum = _mm_add_epi32(sum, _mm_srai_epi32(_mm_add_epi32(product, bias), 15));
+      }
+    }
+
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    samples[j] = static_cast<s16>(std::clamp<s32>(_mm_cvtsi128_si32(sum), -0x8000, 0x7FFF));
+  }
+#elif defined(CPU_AARCH64)
+  int16x8_t taps[XA_RESAMPLE_PADDED_TABLE_SIZE / 8];
+  for (u32 i = 0; i < XA_RESAMPLE_PADDED_TABLE_SIZE / 8; i++)
+    taps[i] = vld1q_s16(&window_ptr[i * 8]);
+
+  for (u32 j = 0; j < XA_RESAMPLE_NUM_ZIGZAG_TABLES; j++)
+  {
+    int32x4_t sum = vdupq_n_s32(0);
+    for (u32 i = 0; i < XA_RESAMPLE_PADDED_TABLE_SIZE / 8; i++)
+    {
+      const int16x8_t coeffs = vld1q_s16(&s_reversed_zigzag_table[j][i * 8]);
+      const int32x4_t products[2] = {vmull_s16(vget_low_s16(taps[i]), vget_low_s16(coeffs)),
+                                     vmull_s16(vget_high_s16(taps[i]), vget_high_s16(coeffs))};
+      for (const int32x4_t product : products)
+      {
+        const int32x4_t bias =
+          vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(product, 31)), 17));
+        sum = vaddq_s32(sum, vshrq_n_s32(vaddq_s32(product, bias), 15));
+      }
+    }
+
+    samples[j] = static_cast<s16>(std::clamp<s32>(vaddvq_s32(sum), -0x8000, 0x7FFF));
+  }
+#else
+  for (u32 j = 0; j < XA_RESAMPLE_NUM_ZIGZAG_TABLES; j++)
+  {
+    s32 sum = 0;
+    for (u32 i = 0; i < XA_RESAMPLE_ZIGZAG_TABLE_SIZE; i++)
+      sum += (s32(window_ptr[i]) * s32(s_reversed_zigzag_table[j][i])) / 0x8000;
+
+    samples[j] = static_cast<s16>(std::clamp<s32>(sum, -0x8000, 0x7FFF));
+  }
+#endif
+}
+
 } // namespace CDXA
@@ -10,7 +10,10 @@ enum
 {
   XA_SUBHEADER_SIZE = 4,
   XA_ADPCM_SAMPLES_PER_SECTOR_4BIT = 4032, // 28 words * 8 nibbles per word * 18 chunks
-  XA_ADPCM_SAMPLES_PER_SECTOR_8BIT = 2016  // 28 words * 4 bytes per word * 18 chunks
+  XA_ADPCM_SAMPLES_PER_SECTOR_8BIT = 2016, // 28 words * 4 bytes per word * 18 chunks
+  XA_RESAMPLE_RING_BUFFER_SIZE = 32,
+  XA_RESAMPLE_ZIGZAG_TABLE_SIZE = 29,
+  XA_RESAMPLE_NUM_ZIGZAG_TABLES = 7,
 };
 
 struct XASubHeader
@@ -70,4 +73,8 @@ static_assert(sizeof(XA_ADPCMBlockHeader) == 1, "XA-ADPCM block header is one by
 // Decodes XA-ADPCM samples in an audio sector. Stereo samples are interleaved with left first.
 void DecodeADPCMSector(const void* data, s16* samples, s32* last_samples);
 
+// Runs the 6-step zigzag interpolator over a resampling ring buffer, producing one output sample per table. p is the
+// position the next input sample will be written to.
+void ZigZagInterpolate(const s16* ringbuf, u32 p, s16* samples);
+
 } // namespace CDXA
\ No newline at end of file
@@ -73,11 +73,13 @@ bool JitCodeBuffer::Allocate(u32 size /* = 64 * 1024 * 1024 */, u32 far_code_siz
   m_free_code_ptr = m_code_ptr;
   m_code_size = size;
   m_code_used = 0;
+  m_code_limit = size;
 
   m_far_code_ptr = static_cast<u8*>(m_code_ptr) + size;
   m_free_far_code_ptr = m_far_code_ptr;
   m_far_code_size = far_code_size;
   m_far_code_used = 0;
+  m_far_code_limit = far_code_size;
 
   m_old_protection = 0;
   m_owns_buffer = true;
@@ -144,11 +146,13 @@ bool JitCodeBuffer::Initialize(void* buffer, u32 size, u32 far_code_size /* = 0
   m_free_code_ptr = m_code_ptr + guard_size;
   m_code_size = size - far_code_size - (guard_size * 2);
   m_code_used = 0;
+  m_code_limit = m_code_size;
 
   m_far_code_ptr = static_cast<u8*>(m_code_ptr) + m_code_size;
   m_free_far_code_ptr = m_far_code_ptr;
   m_far_code_size = far_code_size - guard_size;
   m_far_code_used = 0;
+  m_far_code_limit = m_far_code_size;
 
   m_guard_size = guard_size;
   m_owns_buffer = false;
@@ -184,10 +188,12 @@ void JitCodeBuffer::Destroy()
   m_code_size = 0;
   m_code_reserve_size = 0;
   m_code_used = 0;
+  m_code_limit = 0;
   m_far_code_ptr = nullptr;
   m_free_far_code_ptr = nullptr;
   m_far_code_size = 0;
   m_far_code_used = 0;
+  m_far_code_limit = 0;
   m_total_size = 0;
   m_guard_size = 0;
   m_old_protection = 0;
@@ -202,6 +208,7 @@ void JitCodeBuffer::ReserveCode(u32 size)
   m_code_reserve_size += size;
   m_free_code_ptr += size;
   m_code_size -= size;
+  m_code_limit = m_code_size;
 }
 
 void JitCodeBuffer::CommitCode(u32 length)
@@ -214,7 +221,7 @@ void JitCodeBuffer::CommitCode(u32 length)
   FlushInstructionCache(m_free_code_ptr, length);
 #endif
 
-  Assert(length <= (m_code_size - m_code_used));
+  Assert(length <= (m_code_limit - m_code_used));
   m_free_code_ptr += length;
   m_code_used += length;
 }
@@ -229,7 +236,7 @@ void JitCodeBuffer::CommitFarCode(u32 length)
   FlushInstructionCache(m_free_far_code_ptr, length);
 #endif
 
-  Assert(length <= (m_far_code_size - m_far_code_used));
+  Assert(length <= (m_far_code_limit - m_far_code_used));
   m_free_far_code_ptr += length;
   m_far_code_used += length;
 }
@@ -240,6 +247,7 @@ void JitCodeBuffer::Reset()
 
   m_free_code_ptr = m_code_ptr + m_guard_size + m_code_reserve_size;
   m_code_used = 0;
+  m_code_limit = m_code_size;
   std::memset(m_free_code_ptr, 0, m_code_size);
   FlushInstructionCache(m_free_code_ptr, m_code_size);
 
@@ -247,6 +255,7 @@ void JitCodeBuffer::Reset()
   {
     m_free_far_code_ptr = m_far_code_ptr;
     m_far_code_used = 0;
+    m_far_code_limit = m_far_code_size;
     std::memset(m_free_far_code_ptr, 0, m_far_code_size);
     FlushInstructionCache(m_free_far_code_ptr, m_far_code_size);
   }
@@ -254,6 +263,20 @@ void JitCodeBuffer::Reset()
   WriteProtect(true);
 }
 
+void JitCodeBuffer::SetAllocationRange(u32 code_offset, u32 code_limit, u32 far_code_offset, u32 far_code_limit)
+{
+  Assert(code_offset <= code_limit && code_limit <= m_code_size);
+  Assert(far_code_offset <= far_code_limit && far_code_limit <= m_far_code_size);
+
+  m_free_code_ptr = m_code_ptr + m_guard_size + m_code_reserve_size + code_offset;
+  m_code_used = code_offset;
+  m_code_limit = code_limit;
+
+  m_free_far_code_ptr = m_far_code_ptr + far_code_offset;
+  m_far_code_used = far_code_offset;
+  m_far_code_limit = far_code_limit;
+}
+
 void JitCodeBuffer::Align(u32 alignment, u8 padding_value)
 {
   DebugAssert(Common::IsPow2(alignment));
@@ -23,14 +23,23 @@ public:
   ALWAYS_INLINE u32 GetTotalSize() const { return m_total_size; }
 
   ALWAYS_INLINE u8* GetFreeCodePointer() const { return m_free_code_ptr; }
-  ALWAYS_INLINE u32 GetFreeCodeSpace() const { return static_cast<u32>(m_code_size - m_code_used); }
+  ALWAYS_INLINE u32 GetFreeCodeSpace() const { return static_cast<u32>(m_code_limit - m_code_used); }
+  ALWAYS_INLINE u32 GetUsedCodeSpace() const { return m_code_used; }
+  ALWAYS_INLINE u32 GetCodeSize() const { return m_code_size; }
   void ReserveCode(u32 size);
   void CommitCode(u32 length);
 
   ALWAYS_INLINE u8* GetFreeFarCodePointer() const { return m_free_far_code_ptr; }
-  ALWAYS_INLINE u32 GetFreeFarCodeSpace() const { return static_cast<u32>(m_far_code_size - m_far_code_used); }
+  ALWAYS_INLINE u32 GetFreeFarCodeSpace() const { return static_cast<u32>(m_far_code_limit - m_far_code_used); }
+  ALWAYS_INLINE u32 GetUsedFarCodeSpace() const { return m_far_code_used; }
+  ALWAYS_INLINE u32 GetFarCodeSize() const { return m_far_code_size; }
   void CommitFarCode(u32 length);
 
+  /// Moves the free pointers back to the specified offsets, and limits allocations to the specified end offsets.
+  /// Offsets are relative to the start of the near/far code areas, after any reserved code. This allows a region
+  /// of the buffer to be recycled without resetting the whole buffer.
+  void SetAllocationRange(u32 code_offset, u32 code_limit, u32 far_code_offset, u32 far_code_limit);
+
   /// Adjusts the free code pointer to the specified alignment, padding with bytes.
   /// Assumes alignment is a power-of-two.
   void Align(u32 alignment, u8 padding_value);
@@ -51,11 +60,13 @@ private:
   u32 m_code_size = 0;
   u32 m_code_reserve_size = 0;
   u32 m_code_used = 0;
+  u32 m_code_limit = 0;
 
   u8* m_far_code_ptr = nullptr;
   u8* m_free_far_code_ptr = nullptr;
   u32 m_far_code_size = 0;
   u32 m_far_code_used = 0;
+  u32 m_far_code_limit = 0;
 
   u32 m_total_size = 0;
   u32 m_guard_size = 0;
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "mapped_file.h"
+#include "common/align.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <limits>
+
+#if defined(_WIN32)
+#include "common/windows_headers.h"
+#include <io.h>
+#else
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+Log_SetChannel(MappedFile);
+
+namespace Common {
+
+// How far ahead of the read position to ask the OS to read. A little over 100 sectors, or just under a second of
+// reading at double speed.
+static constexpr u64 PREFETCH_SIZE = 256 * 1024;
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile()
+{
+  Unmap();
+}
+
+bool MappedFile::Map(std::FILE* fp)
+{
+  Unmap();
+
+  const s64 size = FileSystem::FSize64(fp);
+  if (size <= 0 || static_cast<u64>(size) > std::numeric_limits<size_t>::max())
+    return false;
+
+#if defined(_WIN32)
+  const HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+  if (file_handle == INVALID_HANDLE_VALUE)
+    return false;
+
+  m_mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m_mapping_handle)
+  {
+    Log_ErrorPrintf("CreateFileMapping failed: %u", GetLastError());
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, static_cast<size_t>(size)));
+  if (!m_data)
+  {
+    Log_ErrorPrintf("MapViewOfFile failed: %u", GetLastError());
+    CloseHandle(m_mapping_handle);
+    m_mapping_handle = nullptr;
+    return false;
+  }
+#else
+  void* ptr = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fileno(fp), 0);
+  if (ptr == MAP_FAILED)
+  {
+    Log_ErrorPrintf("mmap(%" PRId64 ") failed: %d", size, errno);
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(ptr);
+#endif
+
+  m_size = static_cast<u64>(size);
+  m_prefetch_start = 0;
+  m_prefetch_end = 0;
+  return true;
+}
+
+void MappedFile::Unmap()
+{
+  if (!m_data)
+    return;
+
+#if defined(_WIN32)
+  UnmapViewOfFile(m_data);
+  CloseHandle(m_mapping_handle);
+  m_mapping_handle = nullptr;
+#else
+  munmap(const_cast<u8*>(m_data), static_cast<size_t>(m_size));
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+bool MappedFile::Read(void* buffer, u64 offset, u32 size)
+{
+  if (offset > m_size || size > (m_size - offset))
+    return false;
+
+  // Sequential reads keep the window moving ahead once they're halfway through it, seeks start a new one.
+  const u64 end = offset + size;
+  if (offset < m_prefetch_start || end > m_prefetch_end ||
+      ((end + (PREFETCH_SIZE / 2)) > m_prefetch_end && m_prefetch_end < m_size))
+  {
+    Prefetch(offset, PREFETCH_SIZE);
+  }
+
+  std::memcpy(buffer, m_data + offset, size);
+  return true;
+}
+
+void MappedFile::Prefetch(u64 offset, u64 size)
+{
+  size = std::min(size, m_size - offset);
+  m_prefetch_start = offset;
+  m_prefetch_end = offset + size;
+
+#if !defined(_WIN32)
+  // madvise() needs a page-aligned start.
+  const u64 aligned_offset = Common::AlignDown(offset, static_cast<unsigned int>(sysconf(_SC_PAGESIZE)));
+  if (madvise(const_cast<u8*>(m_data) + aligned_offset, static_cast<size_t>(m_prefetch_end - aligned_offset),
+              MADV_WILLNEED) != 0)
+  {
+    Log_DevPrintf("madvise(MADV_WILLNEED) failed: %d", errno);
+  }
+#endif
+}
+
+} // namespace Common
@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2019-2022 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "common/types.h"
+#include <cstdio>
+
+namespace Common {
+
+/// Read-only mapping of a whole file. Pages come from the OS file cache, so they're shared with any other process
+/// which has the same file open, instead of being copied into a private buffer.
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ALWAYS_INLINE bool IsValid() const { return (m_data != nullptr); }
+  ALWAYS_INLINE const u8* GetData() const { return m_data; }
+  ALWAYS_INLINE u64 GetSize() const { return m_size; }
+
+  /// Maps the file behind an open stream. The stream can be closed afterwards.
+  bool Map(std::FILE* fp);
+  void Unmap();
+
+  /// Copies from the mapping, returning false if the range is outside the file. Asks the OS to start reading ahead
+  /// whenever the read position moves outside of the range it was last asked for.
+  bool Read(void* buffer, u64 offset, u32 size);
+
+private:
+  void Prefetch(u64 offset, u64 size);
+
+  const u8* m_data = nullptr;
+  u64 m_size = 0;
+  u64 m_prefetch_start = 0;
+  u64 m_prefetch_end = 0;
+
+#ifdef _WIN32
+  void* m_mapping_handle = nullptr;
+#endif
+};
+
+} // namespace Common
@@ -14,6 +14,14 @@
 
 class String;
 
+/// Where a marker was passed when reading or writing a state, see StateWrapper::SetMarkerPositions().
+struct StateMarkerPosition
+{
+  const char* name;
+  u64 position;
+  u64 time; // Common::Timer value
+};
+
 class StateWrapper
 {
 public:
@@ -24,9 +32,15 @@ public:
   };
 
   StateWrapper(ByteStream* stream, Mode mode, u32 version);
+
+  /// Reads or writes directly to a block of memory instead of a stream, for memory save states. The layout is the same
+  /// as a stream would see. Running out of space is treated the same as a stream error.
+  StateWrapper(void* buffer, u32 buffer_size, Mode mode, u32 version);
+
   StateWrapper(const StateWrapper&) = delete;
   ~StateWrapper();
 
+  /// Returns null when wrapping a memory buffer.
   ByteStream* GetStream() const { return m_stream; }
   bool HasError() const { return m_error; }
   bool IsReading() const { return (m_mode == Mode::Read); }
@@ -35,19 +49,25 @@ public:
   void SetMode(Mode mode) { m_mode = mode; }
   u32 GetVersion() const { return m_version; }
 
+  /// Returns the offset of the next byte to be read or written.
+  u64 GetPosition() const { return m_buffer ? m_buffer_position : m_stream->GetPosition(); }
+
+  /// Records the name, offset and time of each marker as it is passed. Names must be string literals.
+  void SetMarkerPositions(std::vector<StateMarkerPosition>* positions) { m_marker_positions = positions; }
+
   /// Overload for integral or floating-point types. Writes bytes as-is.
   template<typename T, std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, int> = 0>
   void Do(T* value_ptr)
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (m_error || (m_error |= !ReadData(value_ptr, sizeof(T))) == true)
         *value_ptr = static_cast<T>(0);
     }
     else
     {
       if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+        m_error |= !WriteData(value_ptr, sizeof(T));
     }
   }
 
@@ -59,7 +79,7 @@ public:
     if (m_mode == Mode::Read)
     {
       TType temp;
-      if (m_error || (m_error |= !m_stream->Read2(&temp, sizeof(TType))) == true)
+      if (m_error || (m_error |= !ReadData(&temp, sizeof(TType))) == true)
         temp = static_cast<TType>(0);
 
       *value_ptr = static_cast<T>(temp);
@@ -69,7 +89,7 @@ public:
       TType temp;
       std::memcpy(&temp, value_ptr, sizeof(TType));
       if (!m_error)
-        m_error |= !m_stream->Write2(&temp, sizeof(TType));
+        m_error |= !WriteData(&temp, sizeof(TType));
     }
   }
 
@@ -79,28 +99,36 @@ public:
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (m_error || (m_error |= !ReadData(value_ptr, sizeof(T))) == true)
         std::memset(value_ptr, 0, sizeof(*value_ptr));
     }
     else
     {
       if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+        m_error |= !WriteData(value_ptr, sizeof(T));
     }
   }
 
   template<typename T>
   void DoArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      Do(&values[i]);
+    // Arithmetic and enum types are stored as-is, so the whole array can go in one copy. Bools are normalized.
+    if constexpr (IsStoredAsIs<T>())
+    {
+      DoBytes(values, sizeof(T) * count);
+    }
+    else
+    {
+      for (size_t i = 0; i < count; i++)
+        Do(&values[i]);
+    }
   }
 
   template<typename T>
   void DoPODArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      DoPOD(&values[i]);
+    static_assert(std::is_pod_v<T>);
+    DoBytes(values, sizeof(T) * count);
   }
 
   void DoBytes(void* data, size_t length);
@@ -138,20 +166,10 @@ public:
     u32 length = static_cast<u32>(data->size());
     Do(&length);
     if (m_mode == Mode::Read)
-    {
-      data->clear();
-      for (u32 i = 0; i < length; i++)
-      {
-        T value;
-        Do(&value);
-        data->push_back(value);
-      }
-    }
-    else
-    {
-      for (u32 i = 0; i < length; i++)
-        Do(&data[i]);
-    }
+      data->resize(length);
+
+    for (T& value : *data)
+      Do(&value);
   }
 
   template<typename T, u32 CAPACITY>
@@ -162,19 +180,23 @@ public:
 
     if (m_mode == Mode::Read)
     {
-      T* temp = new T[size];
-      DoArray(temp, size);
       data->Clear();
-      data->PushRange(temp, size);
-      delete[] temp;
+      if (size > CAPACITY)
+      {
+        m_error = true;
+        return;
+      }
+
+      // The queue is empty, so it can be filled in place.
+      DoArray(data->GetWritePointer(), size);
+      data->AdvanceTail(size);
     }
     else
     {
-      for (u32 i = 0; i < size; i++)
-      {
-        T temp(data->Peek(i));
-        Do(&temp);
-      }
+      // At most two runs, one either side of the wrap point.
+      const u32 contiguous_size = data->GetContiguousSize();
+      DoArray(data->GetReadPointer(), contiguous_size);
+      DoArray(data->GetDataPointer(), size - contiguous_size);
     }
   }
 
@@ -192,6 +214,24 @@ public:
     Do(data);
   }
 
+  /// Reserves space for data which is filled in later, and returns a pointer to it. Only possible when writing to a
+  /// memory buffer, otherwise returns null without moving the position.
+  void* ReserveBytes(size_t count)
+  {
+    if (m_mode != Mode::Write || !m_buffer || m_error)
+      return nullptr;
+
+    if ((m_buffer_size - m_buffer_position) < count)
+    {
+      m_error = true;
+      return nullptr;
+    }
+
+    void* ptr = m_buffer + m_buffer_position;
+    m_buffer_position += static_cast<u32>(count);
+    return ptr;
+  }
+
   void SkipBytes(size_t count)
   {
     if (m_mode != Mode::Read)
@@ -200,12 +240,60 @@ public:
       return;
     }
 
-    if (!m_error)
+    if (m_error)
+      return;
+
+    if (m_buffer)
+    {
+      m_error = (m_buffer_size - m_buffer_position) < count;
+      if (!m_error)
+        m_buffer_position += static_cast<u32>(count);
+    }
+    else
+    {
       m_error = !m_stream->SeekRelative(static_cast<s64>(count));
+    }
   }
 
 private:
-  ByteStream* m_stream;
+  template<typename T>
+  static constexpr bool IsStoredAsIs()
+  {
+    return ((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T> || std::is_enum_v<T>);
+  }
+
+  // Memory buffers are copied inline, so small values don't pay for a virtual call.
+  ALWAYS_INLINE bool ReadData(void* data, u32 size)
+  {
+    if (!m_buffer)
+      return m_stream->Read2(data, size);
+
+    if ((m_buffer_size - m_buffer_position) < size)
+      return false;
+
+    std::memcpy(data, m_buffer + m_buffer_position, size);
+    m_buffer_position += size;
+    return true;
+  }
+
+  ALWAYS_INLINE bool WriteData(const void* data, u32 size)
+  {
+    if (!m_buffer)
+      return m_stream->Write2(data, size);
+
+    if ((m_buffer_size - m_buffer_position) < size)
+      return false;
+
+    std::memcpy(m_buffer + m_buffer_position, data, size);
+    m_buffer_position += size;
+    return true;
+  }
+
+  ByteStream* m_stream = nullptr;
+  std::vector<StateMarkerPosition>* m_marker_positions = nullptr;
+  u8* m_buffer = nullptr;
+  u32 m_buffer_size = 0;
+  u32 m_buffer_position = 0;
   Mode m_mode;
   u32 m_version;
   bool m_error = false;